@@ -0,0 +1,40 @@
+#pragma once
+
+// Minimal benchmark helpers, shared by benchmark executables.
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+
+namespace bench {
+
+// Prevent the compiler from optimizing away a value or memory writes (GCC / Clang).
+template <typename T> inline void do_not_optimize (const T & value) {
+	asm volatile ("" : : "r,m"(value) : "memory");
+}
+inline void clobber_memory () {
+	asm volatile ("" : : : "memory");
+}
+
+// Iteration count override from command line: "bench_x [scale]" multiplies default counts.
+inline std::size_t scaled (std::size_t n, int argc, char ** argv) {
+	if (argc > 1)
+		n = static_cast<std::size_t> (static_cast<double> (n) * std::atof (argv[1]));
+	return n > 0 ? n : 1;
+}
+
+/* Run f() iterations times, and print the time per iteration.
+ * Returns the time per iteration in nanoseconds.
+ */
+template <typename F> double run (const char * name, std::size_t iterations, F && f) {
+	using Clock = std::chrono::steady_clock;
+	auto start = Clock::now ();
+	for (std::size_t i = 0; i < iterations; ++i)
+		f ();
+	auto duration = std::chrono::duration<double, std::nano> (Clock::now () - start).count ();
+	auto per_iteration = duration / static_cast<double> (iterations);
+	std::printf ("%-56s %14.2f ns/iter\n", name, per_iteration);
+	return per_iteration;
+}
+} // namespace bench
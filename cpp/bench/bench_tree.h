@@ -0,0 +1,39 @@
+#pragma once
+
+// Tree benchmark helpers, shared by tree benchmark executables.
+
+#include <algorithm>
+#include <cstdint>
+#include <duck/range/range.h>
+
+namespace bench {
+
+/* Implicit complete tree: children of node i are arity * i + 1 ... arity * i + arity.
+ * Arity 1 is a chain. Only the walk buffers are allocated, so 1e8 nodes fit in memory.
+ */
+struct CompleteTree {
+	std::uint32_t nb_nodes;
+	std::uint32_t arity;
+
+	using node_id = std::uint32_t;
+	using edge_id = std::uint32_t; // Child of the edge
+
+	node_id invalid_node () const { return UINT32_MAX; }
+	edge_id invalid_edge () const { return UINT32_MAX; }
+	node_id root_node () const { return nb_nodes > 0 ? 0 : invalid_node (); }
+	node_id child_node (edge_id id) const { return id; }
+	auto child_edges (node_id id) const {
+		auto first = std::min (std::uint64_t (arity) * id + 1, std::uint64_t (nb_nodes));
+		auto last = std::min (first + arity, std::uint64_t (nb_nodes));
+		return duck::range (std::uint32_t (first), std::uint32_t (last));
+	}
+};
+
+// A few hash rounds: per node work.
+inline std::uint64_t node_hash (std::uint32_t node) {
+	std::uint64_t h = node;
+	for (int i = 0; i < 4; ++i)
+		h = (h ^ (h >> 29)) * 0xbf58476d1ce4e5b9u;
+	return h;
+}
+} // namespace bench
@@ -0,0 +1,65 @@
+// Repeated begin () on a sparse filter: plain filtered_range vs cache_begin ().
+// The only match is at the end of the input, so each begin () of the plain filter scans it all.
+// Usage: bench_cached_begin [scale]
+
+#include <bench.h>
+
+#include <cstdio>
+#include <duck/range/algorithm.h>
+#include <duck/range/combinator.h>
+#include <vector>
+
+int main (int argc, char ** argv) {
+	auto iterations = bench::scaled (100, argc, argv);
+	constexpr std::size_t n = 1 << 16;
+	constexpr int nb_repeats = 100;
+	std::vector<int> v (n, 0);
+	v.back () = 1;
+	auto is_one = [](int i) { return i == 1; };
+
+	auto plain = v | duck::filter (is_one);
+	auto cached = v | duck::filter (is_one) | duck::cache_begin ();
+
+	std::printf ("empty + front, %d times\n", nb_repeats);
+	bench::run ("  filter", iterations, [&] {
+		int sum = 0;
+		for (int k = 0; k < nb_repeats; ++k)
+			if (!duck::empty (plain))
+				sum += duck::front (plain);
+		bench::do_not_optimize (sum);
+	});
+	bench::run ("  filter | cache_begin", iterations, [&] {
+		int sum = 0;
+		for (int k = 0; k < nb_repeats; ++k)
+			if (!duck::empty (cached))
+				sum += duck::front (cached);
+		bench::do_not_optimize (sum);
+	});
+
+	std::printf ("range for, %d times\n", nb_repeats);
+	bench::run ("  filter", iterations, [&] {
+		int sum = 0;
+		for (int k = 0; k < nb_repeats; ++k)
+			for (int i : plain)
+				sum += i;
+		bench::do_not_optimize (sum);
+	});
+	bench::run ("  filter | cache_begin", iterations, [&] {
+		int sum = 0;
+		for (int k = 0; k < nb_repeats; ++k)
+			for (int i : cached)
+				sum += i;
+		bench::do_not_optimize (sum);
+	});
+
+	std::printf ("first use (includes the scan)\n");
+	bench::run ("  filter", iterations, [&] {
+		auto r = v | duck::filter (is_one);
+		bench::do_not_optimize (duck::front (r));
+	});
+	bench::run ("  filter | cache_begin", iterations, [&] {
+		auto r = v | duck::filter (is_one) | duck::cache_begin ();
+		bench::do_not_optimize (duck::front (r));
+	});
+	return 0;
+}
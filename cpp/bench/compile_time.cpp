@@ -0,0 +1,262 @@
+// Compile time of the template heavy headers, on generated translation units:
+// - chain_<N>: range pipelines of N filter / map stages (duck/range/combinator.h) ;
+// - variant_<M>: Variant::Static with M alternatives, all used (duck/variant.h) ;
+// - small_vector_<K>: SmallVector<int, 1..K>, K instantiations (duck/small_vector.h).
+// Each unit is compiled (-fsyntax-only) with the compiler used for the project, best of 3 runs.
+// Reports compiler CPU time (user + system), peak memory, and the number of class template
+// instantiations (GCC: classes in -fdump-lang-class, Clang: InstantiateClass events of
+// -ftime-trace).
+// Usage: bench_compile_time [baseline.tsv]
+//   Prints a TSV table. With a baseline (a previous output), exits with status 1 if a unit is more
+//   than 25% slower or bigger, or has more instantiations: use it in CI to catch regressions.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+#ifndef DUCK_CXX_COMPILER
+#define DUCK_CXX_COMPILER "c++"
+#endif
+#ifndef DUCK_CXX_COMPILER_ID
+#define DUCK_CXX_COMPILER_ID "GNU"
+#endif
+#ifndef DUCK_SOURCE_DIR
+#define DUCK_SOURCE_DIR "."
+#endif
+
+struct Unit {
+	std::string name;
+	std::string source;
+};
+
+// Generated sources
+
+static Unit chain_unit (int n) {
+	std::ostringstream os;
+	os << "#include <duck/range/combinator.h>\n#include <vector>\n"
+	   << "int run (const std::vector<int> & v) {\n\tauto r = v";
+	for (int i = 0; i < n; ++i) {
+		if (i % 2 == 0)
+			os << "\n\t    | duck::filter ([](int i) { return i != " << i << "; })";
+		else
+			os << "\n\t    | duck::map ([](int i) { return i + " << i << "; })";
+	}
+	os << ";\n\tint sum = 0;\n\tfor (int i : r)\n\t\tsum += i;\n"
+	   << "\treturn sum + int (duck::size_hint (r).value);\n}\n";
+	return {"chain_" + std::to_string (n), os.str ()};
+}
+
+static Unit variant_unit (int m) {
+	std::ostringstream os;
+	os << "#include <duck/variant.h>\n"
+	   << "template <int I> struct Alt { int v[I % 4 + 1]; };\n"
+	   << "using V = duck::Variant::Static<";
+	for (int i = 0; i < m; ++i)
+		os << (i > 0 ? ", " : "") << "Alt<" << i << ">";
+	os << ">;\nint run (V & v) {\n\tint n = 0;\n";
+	for (int i = 0; i < m; ++i)
+		os << "\tv.emplace<Alt<" << i << ">> ();\n"
+		   << "\tn += v.is_type<Alt<" << i << ">> () + int (sizeof (V::TypeForIndex<" << i
+		   << ">));\n";
+	os << "\treturn n + v.visit ([](const auto & a) { return int (sizeof (a)); });\n}\n";
+	return {"variant_" + std::to_string (m), os.str ()};
+}
+
+static Unit small_vector_unit (int k) {
+	std::ostringstream os;
+	os << "#include <duck/small_vector.h>\nint run (int x) {\n\tint n = 0;\n";
+	for (int i = 1; i <= k; ++i)
+		os << "\t{\n\t\tduck::SmallVector<int, " << i << "> v;\n"
+		   << "\t\tv.push_back (x);\n\t\tv.resize (" << i + 1 << ");\n"
+		   << "\t\tn += int (v.size ()) + v.front ();\n\t}\n";
+	os << "\treturn n;\n}\n";
+	return {"small_vector_" + std::to_string (k), os.str ()};
+}
+
+// Compilation
+
+struct Measure {
+	double cpu_ms;
+	long max_rss_kb;
+	long nb_class_instantiations; // -1 if not available
+};
+
+static const std::string compiler_id = DUCK_CXX_COMPILER_ID;
+static const bool is_gcc = compiler_id == "GNU";
+static const bool is_clang = compiler_id == "Clang" || compiler_id == "AppleClang";
+
+static void write_file (const std::string & path, const std::string & content) {
+	std::ofstream f (path);
+	f << content;
+	if (!f)
+		throw std::runtime_error ("cannot write " + path);
+}
+static std::string read_file (const std::string & path) {
+	std::ifstream f (path);
+	std::ostringstream os;
+	os << f.rdbuf ();
+	return os.str ();
+}
+
+// Run the command, and return its CPU time and peak memory
+static Measure run_command (const std::vector<std::string> & args) {
+	std::vector<char *> argv;
+	for (auto & a : args)
+		argv.push_back (const_cast<char *> (a.c_str ()));
+	argv.push_back (nullptr);
+
+	pid_t pid = ::fork ();
+	if (pid < 0)
+		throw std::runtime_error ("fork failed");
+	if (pid == 0) {
+		::execvp (argv[0], argv.data ());
+		std::_Exit (127);
+	}
+	int status = 0;
+	struct rusage usage;
+	if (::wait4 (pid, &status, 0, &usage) != pid)
+		throw std::runtime_error ("wait4 failed");
+	auto ms = [](const struct timeval & t) {
+		return 1e3 * double (t.tv_sec) + 1e-3 * double (t.tv_usec);
+	};
+	if (!WIFEXITED (status) || WEXITSTATUS (status) != 0)
+		throw std::runtime_error ("compilation failed: " + args.back ());
+	return {ms (usage.ru_utime) + ms (usage.ru_stime), usage.ru_maxrss, -1};
+}
+
+static long count_occurrences (const std::string & text, const std::string & pattern) {
+	long n = 0;
+	for (auto pos = text.find (pattern); pos != std::string::npos;
+	     pos = text.find (pattern, pos + pattern.size ()))
+		++n;
+	return n;
+}
+
+// Class template instantiations, from the compiler dumps of a separate compilation
+static long count_class_instantiations (const std::string & dir, const std::string & file,
+                                        std::vector<std::string> args) {
+	if (is_gcc) {
+		args.push_back ("-fdump-lang-class=" + dir + "/classes.txt");
+		args.push_back (file);
+		run_command (args);
+		std::istringstream dump (read_file (dir + "/classes.txt"));
+		long n = 0;
+		for (std::string line; std::getline (dump, line);)
+			if (line.compare (0, 6, "Class ") == 0 && line.find ('<') != std::string::npos)
+				++n;
+		return n;
+	} else if (is_clang) {
+		args.insert (args.end (), {"-ftime-trace", "-ftime-trace-granularity=0", "-c", "-o",
+		                           dir + "/unit.o", file});
+		args.erase (std::find (args.begin (), args.end (), "-fsyntax-only"));
+		run_command (args);
+		return count_occurrences (read_file (dir + "/unit.json"), "\"InstantiateClass\"");
+	} else {
+		return -1;
+	}
+}
+
+static Measure compile (const std::string & dir, const Unit & unit) {
+	auto file = dir + "/unit.cpp";
+	write_file (file, unit.source);
+	std::vector<std::string> args{DUCK_CXX_COMPILER,
+	                              "-std=c++14",
+	                              "-fsyntax-only",
+	                              "-I" DUCK_SOURCE_DIR,
+	                              "-I" DUCK_SOURCE_DIR "/external/gsl"};
+	auto compile_args = args;
+	compile_args.push_back (file);
+	Measure best = run_command (compile_args);
+	for (int i = 1; i < 3; ++i) {
+		auto m = run_command (compile_args);
+		best.cpu_ms = std::min (best.cpu_ms, m.cpu_ms);
+		best.max_rss_kb = std::min (best.max_rss_kb, m.max_rss_kb);
+	}
+	best.nb_class_instantiations = count_class_instantiations (dir, file, args);
+	return best;
+}
+
+// Baseline comparison
+
+static std::map<std::string, Measure> read_baseline (const std::string & path) {
+	std::map<std::string, Measure> baseline;
+	std::ifstream f (path);
+	if (!f)
+		throw std::runtime_error ("cannot read baseline " + path);
+	std::string line;
+	std::getline (f, line); // Header
+	while (std::getline (f, line)) {
+		std::istringstream is (line);
+		std::string name;
+		Measure m;
+		if (is >> name >> m.cpu_ms >> m.max_rss_kb >> m.nb_class_instantiations)
+			baseline[name] = m;
+	}
+	return baseline;
+}
+
+static bool is_regression (const Measure & m, const Measure & base) {
+	return m.cpu_ms > 1.25 * base.cpu_ms ||
+	       double (m.max_rss_kb) > 1.25 * double (base.max_rss_kb) ||
+	       m.nb_class_instantiations > base.nb_class_instantiations;
+}
+
+int main (int argc, char ** argv) {
+	std::vector<Unit> units{{"empty", "int run () { return 0; }\n"}};
+	for (int n : {8, 32, 64})
+		units.push_back (chain_unit (n));
+	for (int m : {8, 32, 128})
+		units.push_back (variant_unit (m));
+	for (int k : {8, 32, 128})
+		units.push_back (small_vector_unit (k));
+
+	std::map<std::string, Measure> baseline;
+	try {
+		if (argc > 1)
+			baseline = read_baseline (argv[1]);
+	} catch (const std::exception & e) {
+		std::fprintf (stderr, "error: %s\n", e.what ());
+		return 2;
+	}
+
+	char dir_template[] = "/tmp/duck_compile_time.XXXXXX";
+	if (::mkdtemp (dir_template) == nullptr) {
+		std::perror ("mkdtemp");
+		return 2;
+	}
+	std::string dir = dir_template;
+
+	bool regression = false;
+	std::printf ("unit\tcpu_ms\tmax_rss_kb\tclass_instantiations\n");
+	try {
+		for (auto & unit : units) {
+			auto m = compile (dir, unit);
+			std::printf ("%s\t%.1f\t%ld\t%ld", unit.name.c_str (), m.cpu_ms, m.max_rss_kb,
+			             m.nb_class_instantiations);
+			auto base = baseline.find (unit.name);
+			if (base != baseline.end () && is_regression (m, base->second)) {
+				std::printf ("\tREGRESSION (baseline: %.1f %ld %ld)", base->second.cpu_ms,
+				             base->second.max_rss_kb, base->second.nb_class_instantiations);
+				regression = true;
+			}
+			std::printf ("\n");
+			std::fflush (stdout);
+		}
+	} catch (const std::exception & e) {
+		std::fprintf (stderr, "error: %s\n", e.what ());
+		regression = true;
+	}
+	for (auto name : {"unit.cpp", "unit.o", "unit.json", "classes.txt"})
+		::unlink ((dir + "/" + name).c_str ());
+	::rmdir (dir.c_str ());
+	return regression ? 1 : 0;
+}
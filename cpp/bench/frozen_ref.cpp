@@ -0,0 +1,81 @@
+// FrozenRef vs FrozenPtr: copy and reference counting throughput.
+
+#include <bench.h>
+
+#include <condition_variable>
+#include <duck/frozen_ptr.h>
+#include <duck/frozen_ref.h>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct Payload {
+	std::string name{"payload"};
+	int value{42};
+};
+
+template <typename Ptr> void copy_destroy (const char * name, const Ptr & p, std::size_t n) {
+	bench::run (name, n, [&p] {
+		Ptr copy = p;
+		bench::do_not_optimize (copy);
+	});
+}
+
+template <typename Ptr> void vector_copy (const char * name, const Ptr & p, std::size_t n) {
+	// Copying a container of references: memory footprint matters as well as refcount ops.
+	std::vector<Ptr> v (1000, p);
+	bench::run (name, n, [&v] {
+		auto copy = v;
+		bench::do_not_optimize (copy.data ());
+	});
+}
+
+template <typename Ptr> void make (const char * name, std::size_t n) {
+	bench::run (name, n, [] {
+		auto p = Ptr::make ();
+		bench::do_not_optimize (p);
+	});
+}
+
+int main (int argc, char ** argv) {
+	auto n = bench::scaled (10000000, argc, argv);
+
+	/* libstdc++ skips atomic operations in shared_ptr if the process is single threaded.
+	 * Keep an idle thread alive to measure the realistic multi-threaded case.
+	 */
+	std::mutex mutex;
+	std::condition_variable cv;
+	bool done = false;
+	std::thread idle_thread ([&] {
+		std::unique_lock<std::mutex> lock (mutex);
+		cv.wait (lock, [&] { return done; });
+	});
+
+	std::printf ("sizeof FrozenPtr=%zu FrozenRef=%zu\n", sizeof (duck::FrozenPtr<Payload>),
+	             sizeof (duck::FrozenRef<Payload>));
+
+	auto frozen_ptr = duck::make_frozen<Payload> ();
+	auto frozen_ref = duck::make_frozen_ref<Payload> ();
+	auto local_frozen_ref = duck::LocalFrozenRef<Payload>::make ();
+
+	copy_destroy ("copy+destroy FrozenPtr", frozen_ptr, n);
+	copy_destroy ("copy+destroy FrozenRef", frozen_ref, n);
+	copy_destroy ("copy+destroy LocalFrozenRef", local_frozen_ref, n);
+
+	vector_copy ("copy vector<1000> FrozenPtr", frozen_ptr, n / 1000);
+	vector_copy ("copy vector<1000> FrozenRef", frozen_ref, n / 1000);
+	vector_copy ("copy vector<1000> LocalFrozenRef", local_frozen_ref, n / 1000);
+
+	make<duck::FrozenPtr<Payload>> ("make FrozenPtr", n / 10);
+	make<duck::FrozenRef<Payload>> ("make FrozenRef", n / 10);
+	make<duck::LocalFrozenRef<Payload>> ("make LocalFrozenRef", n / 10);
+
+	{
+		std::lock_guard<std::mutex> lock (mutex);
+		done = true;
+	}
+	cv.notify_one ();
+	idle_thread.join ();
+	return 0;
+}
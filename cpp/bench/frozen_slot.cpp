@@ -0,0 +1,106 @@
+// FrozenSlot reader scaling, compared to std::atomic_load on shared_ptr and a mutex.
+// For each reader count (1 .. hardware threads), a writer publishes continuously.
+
+#include <bench.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <duck/frozen_slot.h>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+struct Config {
+	int values[16] = {};
+};
+using Reader = duck::FrozenSlot<Config>::Reader;
+
+/* Run readers threads doing n loads each, with a writer publishing until they finish.
+ * make_reader() is called in each reader thread and returns the load function.
+ */
+template <typename MakeReader, typename WriteFunction>
+void run_scaling (const char * name, unsigned nb_readers, std::size_t n, MakeReader make_reader,
+                  WriteFunction write) {
+	std::atomic<bool> done{false};
+	std::thread writer ([&] {
+		while (!done.load (std::memory_order_relaxed)) {
+			write ();
+			std::this_thread::yield ();
+		}
+	});
+
+	using Clock = std::chrono::steady_clock;
+	auto start = Clock::now ();
+	std::vector<std::thread> readers;
+	for (unsigned r = 0; r < nb_readers; ++r) {
+		readers.emplace_back ([&] {
+			auto read = make_reader ();
+			for (std::size_t i = 0; i < n; ++i)
+				bench::do_not_optimize (read ());
+		});
+	}
+	for (auto & t : readers)
+		t.join ();
+	auto duration = std::chrono::duration<double, std::nano> (Clock::now () - start).count ();
+	done = true;
+	writer.join ();
+
+	auto total_loads = static_cast<double> (n) * nb_readers;
+	std::printf ("%-24s readers=%3u %10.2f ns/load %10.2f Mloads/s\n", name, nb_readers,
+	             duration / total_loads, total_loads / duration * 1e3);
+}
+
+int main (int argc, char ** argv) {
+	auto n = bench::scaled (1000000, argc, argv);
+	auto max_threads = std::max (std::thread::hardware_concurrency (), 1u);
+
+	for (unsigned nb_readers = 1; nb_readers <= max_threads; nb_readers *= 2) {
+		{
+			duck::FrozenSlot<Config> slot (duck::make_frozen<Config> ());
+			run_scaling ("FrozenSlot::Reader", nb_readers, n,
+			             [&slot] {
+				             auto reader = std::make_shared<Reader> (slot.reader ());
+				             return [reader] { return reader->load ()->values[0]; };
+			             },
+			             [&slot] { slot.store (duck::make_frozen<Config> ()); });
+		}
+		{
+			duck::FrozenSlot<Config> slot (duck::make_frozen<Config> ());
+			run_scaling ("FrozenSlot::load", nb_readers, n,
+			             [&slot] {
+				             return [&slot] { return slot.load ()->values[0]; };
+			             },
+			             [&slot] { slot.store (duck::make_frozen<Config> ()); });
+		}
+		{
+			auto shared = std::make_shared<const Config> ();
+			run_scaling ("std::atomic_load", nb_readers, n,
+			             [&shared] {
+				             return [&shared] { return std::atomic_load (&shared)->values[0]; };
+			             },
+			             [&shared] {
+				             std::atomic_store (&shared, std::make_shared<const Config> ());
+			             });
+		}
+		{
+			std::mutex mutex;
+			auto frozen = duck::make_frozen<Config> ();
+			run_scaling ("std::mutex", nb_readers, n,
+			             [&] {
+				             return [&] {
+					             std::lock_guard<std::mutex> lock (mutex);
+					             auto copy = frozen;
+					             return copy->values[0];
+				             };
+			             },
+			             [&] {
+				             auto p = duck::make_frozen<Config> ();
+				             std::lock_guard<std::mutex> lock (mutex);
+				             frozen = std::move (p);
+			             });
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,148 @@
+// Producers written as duck::generator coroutines vs callbacks vs iterators with an explicit stack.
+// Recursive generators resume one frame per tree level for each node: a single generator with an
+// explicit stack is the fast way to walk deep trees.
+// Usage: bench_generator_cpp20 [scale]
+
+#include <bench.h>
+
+#include <cstdio>
+#include <duck/generator.h>
+#include <duck/range/algorithm.h>
+#include <duck/range/combinator.h>
+#include <vector>
+
+static duck::generator<int> iota (int n) {
+	for (int i = 0; i < n; ++i)
+		co_yield i;
+}
+template <typename F> void iota_callback (int n, F && f) {
+	for (int i = 0; i < n; ++i)
+		f (i);
+}
+
+struct Node {
+	int value;
+	std::vector<Node> children;
+};
+static Node make_tree (int depth, int arity, int & counter) {
+	Node node{counter++, {}};
+	if (depth > 0)
+		for (int i = 0; i < arity; ++i)
+			node.children.push_back (make_tree (depth - 1, arity, counter));
+	return node;
+}
+
+static duck::generator<const Node &> pre_order_recursive (const Node & node) {
+	co_yield node;
+	for (auto & child : node.children)
+		for (auto & n : pre_order_recursive (child))
+			co_yield n;
+}
+static duck::generator<const Node &> pre_order_stack (const Node & root) {
+	std::vector<const Node *> stack{&root};
+	while (!stack.empty ()) {
+		auto node = stack.back ();
+		stack.pop_back ();
+		co_yield *node;
+		for (auto it = node->children.rbegin (); it != node->children.rend (); ++it)
+			stack.push_back (&*it);
+	}
+}
+template <typename F> void pre_order_callback (const Node & node, F & f) {
+	f (node);
+	for (auto & child : node.children)
+		pre_order_callback (child, f);
+}
+
+// Explicit stack iterator, without coroutine
+class PreOrderIterator {
+public:
+	explicit PreOrderIterator (const Node & root) : stack_{&root} {}
+	bool done () const { return stack_.empty (); }
+	const Node & operator* () const { return *stack_.back (); }
+	void next () {
+		auto node = stack_.back ();
+		stack_.pop_back ();
+		for (auto it = node->children.rbegin (); it != node->children.rend (); ++it)
+			stack_.push_back (&*it);
+	}
+
+private:
+	std::vector<const Node *> stack_;
+};
+
+int main (int argc, char ** argv) {
+	auto iterations = bench::scaled (200, argc, argv);
+	constexpr int n = 1 << 16;
+	auto is_even = [](int i) { return i % 2 == 0; };
+
+	std::printf ("sum of even squares, n=%d\n", n);
+	bench::run ("  loop", iterations, [&] {
+		long sum = 0;
+		for (int i = 0; i < n; ++i)
+			if (is_even (i))
+				sum += long (i) * i;
+		bench::do_not_optimize (sum);
+	});
+	bench::run ("  callback", iterations, [&] {
+		long sum = 0;
+		iota_callback (n, [&](int i) {
+			if (is_even (i))
+				sum += long (i) * i;
+		});
+		bench::do_not_optimize (sum);
+	});
+	bench::run ("  generator | filter | map", iterations, [&] {
+		long sum = 0;
+		auto square = [](int i) { return long (i) * i; };
+		for (long v : iota (n) | duck::filter (is_even) | duck::map (square))
+			sum += v;
+		bench::do_not_optimize (sum);
+	});
+
+	for (int arity : {2, 16}) {
+		int counter = 0;
+		auto tree = make_tree (arity == 2 ? 15 : 4, arity, counter);
+		std::printf ("pre-order walk, arity %d, %d nodes\n", arity, counter);
+		bench::run ("  callback (recursive)", iterations, [&] {
+			long sum = 0;
+			auto f = [&sum](const Node & node) { sum += node.value; };
+			pre_order_callback (tree, f);
+			bench::do_not_optimize (sum);
+		});
+		bench::run ("  iterator with explicit stack", iterations, [&] {
+			long sum = 0;
+			for (PreOrderIterator it (tree); !it.done (); it.next ())
+				sum += (*it).value;
+			bench::do_not_optimize (sum);
+		});
+		bench::run ("  generator with explicit stack", iterations, [&] {
+			long sum = 0;
+			for (const Node & node : pre_order_stack (tree))
+				sum += node.value;
+			bench::do_not_optimize (sum);
+		});
+		bench::run ("  recursive generators", iterations, [&] {
+			long sum = 0;
+			for (const Node & node : pre_order_recursive (tree))
+				sum += node.value;
+			bench::do_not_optimize (sum);
+		});
+	}
+
+	std::printf ("short lived generators (recycled frames), %d times\n", n);
+	bench::run ("  callback", iterations, [&] {
+		long sum = 0;
+		for (int k = 0; k < n; ++k)
+			iota_callback (k % 8, [&sum](int i) { sum += i; });
+		bench::do_not_optimize (sum);
+	});
+	bench::run ("  generator", iterations, [&] {
+		long sum = 0;
+		for (int k = 0; k < n; ++k)
+			for (int i : iota (k % 8))
+				sum += i;
+		bench::do_not_optimize (sum);
+	});
+	return 0;
+}
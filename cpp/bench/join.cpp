@@ -0,0 +1,86 @@
+// Flattened iteration on a vector of vectors: nested loops vs join () iterators vs the segmented
+// algorithms of join (), which run a tight loop (SIMD for count / find) on each segment.
+// for_each with a lambda accumulating into a captured reference is not vectorized like the nested
+// loops: segmented for_each helps when the work on each element is independent.
+// Usage: bench_join [scale]
+
+#include <bench.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <duck/range/algorithm.h>
+#include <duck/range/combinator.h>
+#include <vector>
+
+template <typename Segments> void bench_segments (const char * title, std::size_t iterations,
+                                                  const Segments & segments, int missing) {
+	auto joined = segments | duck::join ();
+	auto is_odd = [](int i) { return i % 2 != 0; };
+
+	std::printf ("%s\n", title);
+	std::printf (" count_if\n");
+	bench::run ("  nested loops", iterations, [&] {
+		std::ptrdiff_t n = 0;
+		for (auto & segment : segments)
+			for (int i : segment)
+				n += is_odd (i);
+		bench::do_not_optimize (n);
+	});
+	bench::run ("  std::count_if on join iterators", iterations, [&] {
+		bench::do_not_optimize (std::count_if (joined.begin (), joined.end (), is_odd));
+	});
+	bench::run ("  duck::count_if (segmented)", iterations,
+	            [&] { bench::do_not_optimize (duck::count_if (joined, is_odd)); });
+
+	std::printf (" count\n");
+	bench::run ("  std::count on join iterators", iterations, [&] {
+		bench::do_not_optimize (std::count (joined.begin (), joined.end (), 3));
+	});
+	bench::run ("  duck::count (segmented)", iterations,
+	            [&] { bench::do_not_optimize (duck::count (joined, 3)); });
+
+	std::printf (" find (absent value)\n");
+	bench::run ("  std::find on join iterators", iterations, [&] {
+		bench::do_not_optimize (std::find (joined.begin (), joined.end (), missing) == joined.end ());
+	});
+	bench::run ("  duck::find (segmented)", iterations,
+	            [&] { bench::do_not_optimize (duck::find (joined, missing) == joined.end ()); });
+
+	std::printf (" sum\n");
+	bench::run ("  nested loops", iterations, [&] {
+		long sum = 0;
+		for (auto & segment : segments)
+			for (int i : segment)
+				sum += i;
+		bench::do_not_optimize (sum);
+	});
+	bench::run ("  range for on join", iterations, [&] {
+		long sum = 0;
+		for (int i : joined)
+			sum += i;
+		bench::do_not_optimize (sum);
+	});
+	bench::run ("  duck::for_each (segmented)", iterations, [&] {
+		long sum = 0;
+		duck::for_each (joined, [&sum](int i) { sum += i; });
+		bench::do_not_optimize (sum);
+	});
+}
+
+int main (int argc, char ** argv) {
+	auto iterations = bench::scaled (1000, argc, argv);
+	constexpr int n = 1 << 16;
+
+	for (int segment_size : {4, 64, 1024}) {
+		std::vector<std::vector<int>> segments (n / segment_size);
+		int value = 0;
+		for (auto & segment : segments)
+			for (int i = 0; i < segment_size; ++i)
+				segment.push_back (value++ % 1000);
+		char title[64];
+		std::snprintf (title, sizeof (title), "vector<vector<int>>, n=%d, segment size %d", n,
+		               segment_size);
+		bench_segments (title, iterations, segments, -1);
+	}
+	return 0;
+}
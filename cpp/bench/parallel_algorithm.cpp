@@ -0,0 +1,44 @@
+// Serial vs parallel range algorithms on a large vector, for each pool size up to hardware threads.
+// Usage: bench_parallel_algorithm [scale]
+
+#include <bench.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <duck/range/algorithm.h>
+#include <duck/range/combinator.h>
+#include <duck/range/parallel_algorithm.h>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+int main (int argc, char ** argv) {
+	auto n = bench::scaled (1 << 24, argc, argv);
+	std::vector<int> v (n);
+	std::iota (v.begin (), v.end (), 0);
+	auto last = static_cast<int> (n - 1);
+	auto is_last = [last](int i) { return i == last; };
+	auto is_odd = [](int i) { return i % 2 == 1; };
+	auto reversed = v | duck::reverse ();
+
+	bench::run ("serial count_if", 10, [&] { bench::do_not_optimize (duck::count_if (v, is_odd)); });
+	bench::run ("serial find_if (last)", 10,
+	            [&] { bench::do_not_optimize (duck::find_if (v, is_last)); });
+	bench::run ("serial find_if (reverse, first)", 10,
+	            [&] { bench::do_not_optimize (duck::find_if (reversed, is_odd)); });
+
+	auto max_threads = std::max (std::thread::hardware_concurrency (), 1u);
+	for (unsigned nb_threads = 1; nb_threads <= max_threads; nb_threads *= 2) {
+		duck::ThreadPool pool (nb_threads);
+		auto policy = duck::par (pool);
+		std::printf ("pool threads=%u\n", nb_threads);
+		bench::run ("  par count_if", 10,
+		            [&] { bench::do_not_optimize (duck::count_if (policy, v, is_odd)); });
+		bench::run ("  par find_if (last)", 10,
+		            [&] { bench::do_not_optimize (duck::find_if (policy, v, is_last)); });
+		// Early cancellation: match in the first block
+		bench::run ("  par find_if (reverse, first)", 10,
+		            [&] { bench::do_not_optimize (duck::find_if (policy, reversed, is_odd)); });
+	}
+	return 0;
+}
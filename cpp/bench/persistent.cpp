@@ -0,0 +1,122 @@
+// Persistent structures vs copy-and-freeze: cost of producing a new frozen snapshot per update.
+// Usage: bench_persistent [scale]
+
+#include <bench.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <duck/frozen_ptr.h>
+#include <duck/persistent.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Copy-and-freeze is O(size) per update, so it runs copy_n iterations instead of n.
+static void vector_updates (std::size_t size, std::size_t n, std::size_t copy_n) {
+	std::printf ("vector size=%zu\n", size);
+
+	std::vector<int> initial (size, 0);
+	{
+		auto snapshot = duck::make_frozen<std::vector<int>> (initial);
+		std::size_t i = 0;
+		bench::run ("  copy-and-freeze set", copy_n, [&] {
+			auto copy = duck::make_freezable<std::vector<int>> (*snapshot);
+			(*copy)[i++ % size] += 1;
+			snapshot = std::move (copy).freeze ();
+		});
+		bench::do_not_optimize (snapshot);
+	}
+	{
+		duck::PersistentVector<int> snapshot;
+		{
+			auto t = snapshot.transient ();
+			for (auto v : initial)
+				t.push_back (v);
+			snapshot = std::move (t).persistent ();
+		}
+		std::size_t i = 0;
+		bench::run ("  PersistentVector set", n, [&] {
+			auto index = i++ % size;
+			snapshot = snapshot.set (index, snapshot[index] + 1);
+		});
+		bench::run ("  PersistentVector transient set (batch of 100)", n / 100, [&] {
+			auto t = snapshot.transient ();
+			for (int k = 0; k < 100; ++k) {
+				auto index = i++ % size;
+				t.set (index, t[index] + 1);
+			}
+			snapshot = std::move (t).persistent ();
+		});
+		bench::run ("  PersistentVector sum", 10, [&] {
+			long sum = 0;
+			for (auto v : snapshot)
+				sum += v;
+			bench::do_not_optimize (sum);
+		});
+	}
+	{
+		bench::run ("  std::vector sum", 10, [&] {
+			long sum = 0;
+			for (auto v : initial)
+				sum += v;
+			bench::do_not_optimize (sum);
+		});
+	}
+}
+
+static void map_updates (std::size_t size, std::size_t n, std::size_t copy_n) {
+	std::printf ("map size=%zu\n", size);
+
+	std::unordered_map<std::size_t, int> initial;
+	for (std::size_t k = 0; k < size; ++k)
+		initial.emplace (k, 0);
+	{
+		auto snapshot = duck::make_frozen<std::unordered_map<std::size_t, int>> (initial);
+		std::size_t i = 0;
+		bench::run ("  copy-and-freeze set", copy_n, [&] {
+			auto copy = duck::make_freezable<std::unordered_map<std::size_t, int>> (*snapshot);
+			(*copy)[i++ % size] += 1;
+			snapshot = std::move (copy).freeze ();
+		});
+		bench::do_not_optimize (snapshot);
+	}
+	{
+		duck::PersistentMap<std::size_t, int> snapshot;
+		{
+			auto t = snapshot.transient ();
+			for (const auto & entry : initial)
+				t.set (entry.first, entry.second);
+			snapshot = std::move (t).persistent ();
+		}
+		std::size_t i = 0;
+		bench::run ("  PersistentMap set", n, [&] {
+			auto key = i++ % size;
+			snapshot = snapshot.set (key, *snapshot.find (key) + 1);
+		});
+		bench::run ("  PersistentMap transient set (batch of 100)", n / 100, [&] {
+			auto t = snapshot.transient ();
+			for (int k = 0; k < 100; ++k) {
+				auto key = i++ % size;
+				t.set (key, *t.find (key) + 1);
+			}
+			snapshot = std::move (t).persistent ();
+		});
+		bench::run ("  PersistentMap find", n,
+		            [&] { bench::do_not_optimize (snapshot.find (i++ % size)); });
+	}
+	{
+		std::size_t i = 0;
+		bench::run ("  std::unordered_map find", n,
+		            [&] { bench::do_not_optimize (initial.find (i++ % size)); });
+	}
+}
+
+int main (int argc, char ** argv) {
+	auto n = bench::scaled (1000000, argc, argv);
+	for (std::size_t size : {100, 10000, 1000000}) {
+		auto copy_n = bench::scaled (std::max<std::size_t> (100000000 / size, 20), argc, argv);
+		vector_updates (size, n, copy_n);
+		map_updates (size, n, copy_n);
+	}
+	return 0;
+}
@@ -0,0 +1,73 @@
+// filter | map | filter chains: hand written loops vs pull (iterators) vs push (fused loop).
+// Usage: bench_pipeline [scale]
+
+#include <bench.h>
+
+#include <cstdio>
+#include <duck/range/algorithm.h>
+#include <duck/range/combinator.h>
+#include <duck/range/numeric.h>
+#include <numeric>
+#include <vector>
+
+int main (int argc, char ** argv) {
+	auto n = bench::scaled (1 << 22, argc, argv);
+	std::vector<int> v (n);
+	std::iota (v.begin (), v.end (), 0);
+
+	auto is_even = [](int i) { return i % 2 == 0; };
+	auto times_3 = [](int i) { return i * 3; };
+	auto not_multiple_of_5 = [](int i) { return i % 5 != 0; };
+	auto chain = v | duck::filter (is_even) | duck::map (times_3) | duck::filter (not_multiple_of_5);
+
+	std::printf ("sum\n");
+	bench::run ("  hand written loop", 10, [&] {
+		long sum = 0;
+		for (int i : v)
+			if (is_even (i) && not_multiple_of_5 (times_3 (i)))
+				sum += times_3 (i);
+		bench::do_not_optimize (sum);
+	});
+	bench::run ("  pull: range for over chain", 10, [&] {
+		long sum = 0;
+		for (int i : chain)
+			sum += i;
+		bench::do_not_optimize (sum);
+	});
+	bench::run ("  pull: std::accumulate on iterators", 10, [&] {
+		bench::do_not_optimize (std::accumulate (chain.begin (), chain.end (), 0L));
+	});
+	bench::run ("  push: duck::accumulate", 10,
+	            [&] { bench::do_not_optimize (duck::accumulate (chain, 0L)); });
+	bench::run ("  push: duck::for_each", 10, [&] {
+		long sum = 0;
+		duck::for_each (chain, [&sum](int i) { sum += i; });
+		bench::do_not_optimize (sum);
+	});
+
+	std::printf ("count_if\n");
+	auto is_small = [](int i) { return i < (1 << 20); };
+	bench::run ("  pull: std::count_if on iterators", 10, [&] {
+		bench::do_not_optimize (std::count_if (chain.begin (), chain.end (), is_small));
+	});
+	bench::run ("  push: duck::count_if", 10,
+	            [&] { bench::do_not_optimize (duck::count_if (chain, is_small)); });
+
+	std::printf ("to vector\n");
+	bench::run ("  hand written loop", 10, [&] {
+		std::vector<int> out;
+		for (int i : v)
+			if (is_even (i) && not_multiple_of_5 (times_3 (i)))
+				out.push_back (times_3 (i));
+		bench::do_not_optimize (out.data ());
+	});
+	bench::run ("  pull: vector (begin, end)", 10, [&] {
+		std::vector<int> out (chain.begin (), chain.end ());
+		bench::do_not_optimize (out.data ());
+	});
+	bench::run ("  push: duck::to_container", 10, [&] {
+		auto out = duck::to_container<std::vector<int>> (chain);
+		bench::do_not_optimize (out.data ());
+	});
+	return 0;
+}
@@ -0,0 +1,66 @@
+// Reductions and prefix sums: <numeric> loops vs duck SIMD kernels, then parallel two pass
+// versions for each pool size up to hardware threads.
+// Usage: bench_scan [scale]
+
+#include <bench.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <duck/range/numeric.h>
+#include <duck/range/parallel_numeric.h>
+#include <duck/thread_pool.h>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+template <typename T> void bench_type (const char * type, std::size_t n, std::size_t iterations) {
+	std::vector<T> v (n);
+	for (std::size_t i = 0; i < n; ++i)
+		v[i] = static_cast<T> (i % 13);
+	std::vector<T> out (n);
+	auto name = [type](const char * what) { return std::string ("  ") + type + " " + what; };
+
+	std::printf ("%s, n=%zu\n", type, n);
+	bench::run (name ("std::accumulate").c_str (), iterations,
+	            [&] { bench::do_not_optimize (std::accumulate (v.begin (), v.end (), T (0))); });
+	bench::run (name ("duck::reduce").c_str (), iterations,
+	            [&] { bench::do_not_optimize (duck::reduce (v)); });
+	bench::run (name ("std::partial_sum").c_str (), iterations, [&] {
+		std::partial_sum (v.begin (), v.end (), out.begin ());
+		bench::clobber_memory ();
+	});
+	bench::run (name ("duck::inclusive_scan").c_str (), iterations, [&] {
+		duck::inclusive_scan (v, out.data ());
+		bench::clobber_memory ();
+	});
+	bench::run (name ("duck::exclusive_scan").c_str (), iterations, [&] {
+		duck::exclusive_scan (v, out.data (), T (0));
+		bench::clobber_memory ();
+	});
+
+	auto max_threads = std::max (std::thread::hardware_concurrency (), 1u);
+	for (unsigned nb_threads = 1; nb_threads <= max_threads; nb_threads *= 2) {
+		// nb_threads - 1 pool threads: the caller works too
+		duck::ThreadPool pool (nb_threads - 1);
+		auto policy = duck::par (pool, 1 << 14);
+		std::printf ("  threads=%u\n", nb_threads);
+		bench::run (name ("  par reduce").c_str (), iterations,
+		            [&] { bench::do_not_optimize (duck::reduce (policy, v)); });
+		bench::run (name ("  par inclusive_scan").c_str (), iterations, [&] {
+			duck::inclusive_scan (policy, v, out.data ());
+			bench::clobber_memory ();
+		});
+	}
+}
+
+int main (int argc, char ** argv) {
+	auto n = bench::scaled (1 << 22, argc, argv);
+	auto iterations = std::max<std::size_t> (1, (std::size_t (1) << 26) / n);
+	bench_type<std::int32_t> ("int32", n, iterations);
+	bench_type<std::int64_t> ("int64", n, iterations);
+	bench_type<float> ("float", n, iterations);
+	bench_type<double> ("double", n, iterations);
+	return 0;
+}
@@ -0,0 +1,67 @@
+// SIMD paths of range algorithms on contiguous arithmetic data, against <algorithm> on iterators.
+// Matrix: element types x sizes x algorithms. Searched values are absent (full scans).
+// Usage: bench_simd_algorithm [scale]
+
+#include <bench.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <duck/range/algorithm.h>
+#include <duck/range/numeric.h>
+#include <numeric>
+#include <vector>
+
+template <typename T> static void bench_type (const char * type_name, double scale) {
+	for (std::size_t n : {std::size_t (64), std::size_t (4096), std::size_t (1 << 20)}) {
+		// Same number of processed elements for all sizes
+		auto iterations = static_cast<std::size_t> (scale * 4e8 / static_cast<double> (n)) + 1;
+		std::vector<T> v (n);
+		for (std::size_t i = 0; i < n; ++i)
+			v[i] = static_cast<T> (i % 100);
+		auto copy = v;
+		auto absent = static_cast<T> (101);
+		auto is_small = [](T x) { return x < T (100); };
+		std::printf ("%s n=%zu\n", type_name, n);
+
+		bench::run ("  std::find", iterations,
+		            [&] { bench::do_not_optimize (std::find (v.begin (), v.end (), absent)); });
+		bench::run ("  duck::find", iterations,
+		            [&] { bench::do_not_optimize (duck::find (v, absent)); });
+		bench::run ("  std::count", iterations,
+		            [&] { bench::do_not_optimize (std::count (v.begin (), v.end (), T (7))); });
+		bench::run ("  duck::count", iterations,
+		            [&] { bench::do_not_optimize (duck::count (v, T (7))); });
+		bench::run ("  std::equal", iterations, [&] {
+			bench::do_not_optimize (std::equal (v.begin (), v.end (), copy.begin (), copy.end ()));
+		});
+		bench::run ("  duck::equal", iterations,
+		            [&] { bench::do_not_optimize (duck::equal (v, copy)); });
+		bench::run ("  std::all_of", iterations, [&] {
+			bench::do_not_optimize (std::all_of (v.begin (), v.end (), is_small));
+		});
+		bench::run ("  duck::all_of", iterations,
+		            [&] { bench::do_not_optimize (duck::all_of (v, is_small)); });
+		bench::run ("  duck::all_of (pure_predicate)", iterations, [&] {
+			bench::do_not_optimize (duck::all_of (v, duck::pure_predicate (is_small)));
+		});
+		bench::run ("  std::min_element", iterations,
+		            [&] { bench::do_not_optimize (std::min_element (v.begin (), v.end ())); });
+		bench::run ("  duck::min_element", iterations,
+		            [&] { bench::do_not_optimize (duck::min_element (v)); });
+		bench::run ("  std::accumulate", iterations,
+		            [&] { bench::do_not_optimize (std::accumulate (v.begin (), v.end (), T (0))); });
+		bench::run ("  duck::sum", iterations, [&] { bench::do_not_optimize (duck::sum (v)); });
+	}
+}
+
+int main (int argc, char ** argv) {
+	auto scale = static_cast<double> (bench::scaled (100, argc, argv)) / 100.;
+	bench_type<std::uint8_t> ("uint8_t", scale);
+	bench_type<std::int16_t> ("int16_t", scale);
+	bench_type<std::int32_t> ("int32_t", scale);
+	bench_type<std::int64_t> ("int64_t", scale);
+	bench_type<float> ("float", scale);
+	bench_type<double> ("double", scale);
+	return 0;
+}
@@ -0,0 +1,103 @@
+// Sorting: std::sort vs duck::sort (radix sort on arithmetic keys), key projections, parallel
+// merge sort, and top_k vs partial_sort, on random inputs from 1e3 elements up to 1e7 * scale.
+// Each iteration sorts a fresh copy of the input: the "copy" line is the cost to subtract.
+// Usage: bench_sort [scale]
+
+#include <bench.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <duck/range/algorithm.h>
+#include <duck/range/parallel_algorithm.h>
+#include <duck/thread_pool.h>
+#include <random>
+#include <thread>
+#include <vector>
+
+struct Record {
+	std::uint32_t key;
+	float weight;
+	std::uint64_t payload;
+};
+
+int main (int argc, char ** argv) {
+	auto max_n = bench::scaled (10 * 1000 * 1000, argc, argv);
+	auto nb_threads = std::max (std::thread::hardware_concurrency (), 1u);
+	duck::ThreadPool pool (nb_threads);
+	auto policy = duck::par (pool, 1 << 14);
+	auto by_key = [](const Record & a, const Record & b) { return a.key < b.key; };
+	auto key_of = [](const Record & r) { return r.key; };
+	std::mt19937_64 gen (42);
+
+	for (std::size_t n = 1000; n <= max_n; n *= 10) {
+		auto iterations = std::max<std::size_t> (1, 10 * 1000 * 1000 / n);
+		std::vector<std::uint32_t> ints (n);
+		std::vector<double> doubles (n);
+		std::vector<Record> records (n);
+		for (std::size_t i = 0; i < n; ++i) {
+			ints[i] = static_cast<std::uint32_t> (gen ());
+			doubles[i] = std::normal_distribution<double> () (gen);
+			records[i] = Record{ints[i], 1.f, i};
+		}
+		std::printf ("n=%zu\n", n);
+		std::vector<std::uint32_t> int_work;
+		std::vector<double> double_work;
+		std::vector<Record> record_work;
+
+		bench::run ("  uint32 copy", iterations, [&] {
+			int_work = ints;
+			bench::clobber_memory ();
+		});
+		bench::run ("  uint32 std::sort", iterations, [&] {
+			int_work = ints;
+			std::sort (int_work.begin (), int_work.end ());
+			bench::clobber_memory ();
+		});
+		bench::run ("  uint32 duck::sort (radix)", iterations, [&] {
+			int_work = ints;
+			duck::sort (int_work);
+			bench::clobber_memory ();
+		});
+		bench::run ("  uint32 duck::sort (par)", iterations, [&] {
+			int_work = ints;
+			duck::sort (policy, int_work);
+			bench::clobber_memory ();
+		});
+		bench::run ("  double std::sort", iterations, [&] {
+			double_work = doubles;
+			std::sort (double_work.begin (), double_work.end ());
+			bench::clobber_memory ();
+		});
+		bench::run ("  double duck::sort (radix)", iterations, [&] {
+			double_work = doubles;
+			duck::sort (double_work);
+			bench::clobber_memory ();
+		});
+		bench::run ("  record std::stable_sort (key)", iterations, [&] {
+			record_work = records;
+			std::stable_sort (record_work.begin (), record_work.end (), by_key);
+			bench::clobber_memory ();
+		});
+		bench::run ("  record duck::radix_sort (key)", iterations, [&] {
+			record_work = records;
+			duck::radix_sort (record_work, key_of);
+			bench::clobber_memory ();
+		});
+		bench::run ("  record duck::stable_sort (par, key)", iterations, [&] {
+			record_work = records;
+			duck::stable_sort (policy, record_work, by_key);
+			bench::clobber_memory ();
+		});
+
+		// 100 smallest keys: no copy needed for top_k
+		bench::run ("  uint32 std::partial_sort (100 first)", iterations, [&] {
+			int_work = ints;
+			std::partial_sort (int_work.begin (), int_work.begin () + 100, int_work.end ());
+			bench::clobber_memory ();
+		});
+		bench::run ("  uint32 duck::top_k (100)", iterations,
+		            [&] { bench::do_not_optimize (duck::top_k (ints, 100)); });
+	}
+	return 0;
+}
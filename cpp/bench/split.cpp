@@ -0,0 +1,61 @@
+// Eager duck::split (vector of parts, std::find) vs lazy split_range (memchr) / split_range_any.
+// Each iteration splits the text and sums part lengths.
+// Usage: bench_split [scale]
+
+#include <bench.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <duck/view.h>
+#include <string>
+
+template <typename R> static std::size_t total_length (const R & parts) {
+	std::size_t total = 0;
+	for (auto part : parts)
+		total += static_cast<std::size_t> (part.size ());
+	return total;
+}
+
+// Reference for split_range_any: std::find_first_of loop
+static std::size_t total_length_find_first_of (duck::string_view separators,
+                                               duck::string_view text) {
+	std::size_t total = 0;
+	auto it = text.begin ();
+	while (true) {
+		auto next = std::find_first_of (it, text.end (), separators.begin (), separators.end ());
+		total += static_cast<std::size_t> (next - it);
+		if (next == text.end ())
+			return total;
+		it = next + 1;
+	}
+}
+
+static void run_all (const char * name, const std::string & text, std::size_t iterations) {
+	std::printf ("%s (%zu chars)\n", name, text.size ());
+	bench::run ("  split (eager)", iterations,
+	            [&] { bench::do_not_optimize (total_length (duck::split (',', text))); });
+	bench::run ("  split_range", iterations,
+	            [&] { bench::do_not_optimize (total_length (duck::split_range (',', text))); });
+	bench::run ("  std::find_first_of, 3 separators", iterations,
+	            [&] { bench::do_not_optimize (total_length_find_first_of (",; ", text)); });
+	bench::run ("  split_range_any, 3 separators", iterations, [&] {
+		bench::do_not_optimize (total_length (duck::split_range_any (",; ", text)));
+	});
+}
+
+int main (int argc, char ** argv) {
+	auto iterations = bench::scaled (1000000, argc, argv);
+	run_all ("short config line", "name=duck,level=3,verbose=yes,path=/usr/local/lib", iterations);
+
+	// Long log: 4 fields per line, separated by ','
+	std::string log;
+	while (log.size () < (1 << 20))
+		log += "2024-01-01T00:00:00.000,server-name-01,INFO,request served in 12 ms for client,";
+	run_all ("long text, short parts", log, iterations / 10000 + 1);
+
+	std::string sparse (1 << 20, 'x');
+	for (std::size_t i = 0; i < sparse.size (); i += 4096)
+		sparse[i] = ',';
+	run_all ("long text, long parts", sparse, iterations / 10000 + 1);
+	return 0;
+}
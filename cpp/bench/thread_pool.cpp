@@ -0,0 +1,81 @@
+// Work stealing ThreadPool: fork/join (fib), nested parallel_for, and imbalanced workloads.
+// Each workload runs serially, then on pools of 1 .. hardware threads.
+// Usage: bench_thread_pool [scale]
+
+#include <bench.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <duck/thread_pool.h>
+#include <thread>
+#include <vector>
+
+static long fib_serial (int n) {
+	return n < 2 ? n : fib_serial (n - 1) + fib_serial (n - 2);
+}
+// Fork/join down to cutoff: many tiny tasks, measures spawn / steal overhead.
+static long fib_parallel (duck::ThreadPool & pool, int n, int cutoff) {
+	if (n <= cutoff)
+		return fib_serial (n);
+	long a = 0;
+	duck::TaskGroup group (pool);
+	group.spawn ([&] { a = fib_parallel (pool, n - 1, cutoff); });
+	auto b = fib_parallel (pool, n - 2, cutoff);
+	group.wait ();
+	return a + b;
+}
+
+// Work proportional to i: the last elements cost much more than the first ones.
+static double imbalanced_work (std::size_t i) {
+	double x = 0;
+	for (std::size_t k = 0; k < i; ++k)
+		x += 1.0 / static_cast<double> (k + 1);
+	return x;
+}
+
+int main (int argc, char ** argv) {
+	auto iterations = bench::scaled (10, argc, argv);
+	constexpr int fib_n = 30;
+	constexpr std::size_t outer = 256;
+	constexpr std::size_t inner = 16384;
+	constexpr std::size_t nb_imbalanced = 4096;
+	std::vector<double> values (outer * inner, 1.0);
+	std::vector<double> results (nb_imbalanced);
+
+	std::printf ("serial\n");
+	bench::run ("  fib(30)", iterations, [] { bench::do_not_optimize (fib_serial (fib_n)); });
+	bench::run ("  nested loops 256 x 16384", iterations, [&] {
+		for (std::size_t i = 0; i < outer; ++i)
+			for (std::size_t j = 0; j < inner; ++j)
+				values[i * inner + j] *= 1.000001;
+		bench::clobber_memory ();
+	});
+	bench::run ("  imbalanced loop 4096", iterations, [&] {
+		for (std::size_t i = 0; i < nb_imbalanced; ++i)
+			results[i] = imbalanced_work (i);
+		bench::clobber_memory ();
+	});
+
+	auto max_threads = std::max (std::thread::hardware_concurrency (), 1u);
+	for (unsigned nb_threads = 1; nb_threads <= max_threads; nb_threads *= 2) {
+		duck::ThreadPool pool (nb_threads);
+		std::printf ("pool threads=%u\n", nb_threads);
+		bench::run ("  fib(30) cutoff 12", iterations,
+		            [&] { bench::do_not_optimize (fib_parallel (pool, fib_n, 12)); });
+		bench::run ("  fib(30) cutoff 4 (tiny tasks)", iterations,
+		            [&] { bench::do_not_optimize (fib_parallel (pool, fib_n, 4)); });
+		bench::run ("  nested parallel_for 256 x 16384", iterations, [&] {
+			pool.parallel_for (duck::range (outer), 1, [&](std::size_t i) {
+				pool.parallel_for (duck::range (inner), 1024,
+				                   [&](std::size_t j) { values[i * inner + j] *= 1.000001; });
+			});
+			bench::clobber_memory ();
+		});
+		bench::run ("  imbalanced parallel_for 4096", iterations, [&] {
+			pool.parallel_for (duck::range (nb_imbalanced), 16,
+			                   [&](std::size_t i) { results[i] = imbalanced_work (i); });
+			bench::clobber_memory ();
+		});
+	}
+	return 0;
+}
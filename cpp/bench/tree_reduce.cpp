@@ -0,0 +1,46 @@
+// Bottom-up tree reductions (ordered subtree hashes): serial tree_reduce, and the parallel version
+// for each pool size up to hardware threads, on:
+// - balanced trees: implicit complete binary and 8-ary trees ;
+// - degenerate chains: every node has one child (no parallelism, must not recurse nor split).
+// Usage: bench_tree_reduce [scale]
+
+#include <bench.h>
+#include <bench_tree.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <duck/parallel_tree_view.h>
+#include <duck/tree_view.h>
+#include <thread>
+
+static std::uint64_t ordered_hash (std::uint64_t acc, std::uint64_t child) {
+	return (acc ^ child) * 0x100000001b3u;
+}
+
+int main (int argc, char ** argv) {
+	auto iterations = bench::scaled (5, argc, argv);
+	auto max_threads = std::max (std::thread::hardware_concurrency (), 1u);
+	constexpr std::uint32_t n = 1 << 23;
+
+	for (std::uint32_t arity : {2u, 8u, 1u}) {
+		bench::CompleteTree tree{n, arity};
+		if (arity == 1)
+			std::printf ("chain, %u nodes\n", n);
+		else
+			std::printf ("balanced, arity %u, %u nodes\n", arity, n);
+		bench::run ("  tree_reduce (serial)", iterations, [&] {
+			bench::do_not_optimize (duck::tree_reduce (tree, bench::node_hash, ordered_hash));
+		});
+		for (unsigned nb_threads = 1; nb_threads <= max_threads; nb_threads *= 2) {
+			duck::ThreadPool pool (nb_threads);
+			char name[64];
+			std::snprintf (name, sizeof (name), "  tree_reduce (pool threads=%u)", nb_threads);
+			bench::run (name, iterations, [&] {
+				bench::do_not_optimize (
+				    duck::tree_reduce (duck::par (pool), tree, bench::node_hash, ordered_hash));
+			});
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,70 @@
+// Tree walks on wide trees: serial dfs / bfs / post-order / levels ranges, and the level
+// synchronous parallel traversal for each pool size up to hardware threads.
+// Trees are implicit complete trees (children of node i are arity * i + 1 ... arity * i + arity),
+// so that 1e8 nodes fit in memory: only walk buffers are allocated (bfs levels are the widest
+// structures, about n * (arity - 1) / arity ids for the last level).
+// Each node does a few hash rounds of work.
+// Usage: bench_tree_traversal [scale] [max_nodes]
+//   Trees of 1e6, 1e7... nodes up to max_nodes (default 1e7, use 1e8 with a few GB of memory).
+
+#include <bench.h>
+#include <bench_tree.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <duck/parallel_tree_view.h>
+#include <duck/tree_view.h>
+#include <thread>
+
+int main (int argc, char ** argv) {
+	auto iterations = bench::scaled (3, argc, argv);
+	double max_nodes = argc > 2 ? std::atof (argv[2]) : 1e7;
+	auto max_threads = std::max (std::thread::hardware_concurrency (), 1u);
+
+	for (double n = 1e6; n <= max_nodes; n *= 10) {
+		for (std::uint32_t arity : {16u, 1024u}) {
+			bench::CompleteTree tree{std::uint32_t (n), arity};
+			std::printf ("%u nodes, arity %u\n", tree.nb_nodes, arity);
+			bench::run ("  input_dfs_range", iterations, [&] {
+				std::uint64_t sum = 0;
+				for (auto node : duck::input_dfs_range (tree))
+					sum += bench::node_hash (node);
+				bench::do_not_optimize (sum);
+			});
+			bench::run ("  input_post_order_range", iterations, [&] {
+				std::uint64_t sum = 0;
+				for (auto node : duck::input_post_order_range (tree))
+					sum += bench::node_hash (node);
+				bench::do_not_optimize (sum);
+			});
+			bench::run ("  input_bfs_range", iterations, [&] {
+				std::uint64_t sum = 0;
+				for (auto node : duck::input_bfs_range (tree))
+					sum += bench::node_hash (node);
+				bench::do_not_optimize (sum);
+			});
+			bench::run ("  input_levels_range", iterations, [&] {
+				std::uint64_t sum = 0;
+				for (auto level : duck::input_levels_range (tree))
+					for (auto node : level)
+						sum += bench::node_hash (node);
+				bench::do_not_optimize (sum);
+			});
+			for (unsigned nb_threads = 1; nb_threads <= max_threads; nb_threads *= 2) {
+				duck::ThreadPool pool (nb_threads);
+				char name[64];
+				std::snprintf (name, sizeof (name), "  level_order_for_each (pool threads=%u)", nb_threads);
+				bench::run (name, iterations, [&] {
+					duck::level_order_for_each (duck::par (pool), tree, [](std::uint32_t node) {
+						static thread_local std::uint64_t sum = 0;
+						sum += bench::node_hash (node);
+						bench::do_not_optimize (sum);
+					});
+				});
+			}
+		}
+	}
+	return 0;
+}
@@ -0,0 +1,253 @@
+// Tree walks through the virtual topology interface, a non virtual topology, and a LinearizedTree
+// snapshot. The tree is a random recursive tree of pointer linked nodes (parent of node i is
+// uniform in [0, i)), viewed through:
+// - NodeView: duck::bidirectional_tree_topology, walked through the base class (virtual calls), or
+//   as NodeView (final overrides: inlined, but child_edges still returns a std::vector) ;
+// - NodeTopology: non virtual topology concept, pointers as ids, lazy child_edges range ;
+// - Linked*: same, with O(1) first_child_edge / next_sibling_edge (nodes know their position in
+//   their parent): forward dfs steps neither allocate nor search the father children. Walks stay
+//   memory bound (a few node accesses per step) ; input walks keep using contiguous child_edges
+//   ranges when available, which are faster than following links.
+// Usage: bench_tree_view [scale]
+
+#include <bench.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <duck/tree_view.h>
+#include <memory>
+#include <random>
+#include <vector>
+
+struct Node {
+	std::vector<std::unique_ptr<Node>> children;
+	Node * parent{nullptr};
+	std::size_t index_in_parent{0};
+	int value;
+	explicit Node (int v) : value (v) {}
+};
+
+struct NodeViewBase : duck::bidirectional_tree_topology {
+	const Node * root;
+
+	using node_id = duck::topology_node_id;
+	using edge_id = duck::topology_edge_id;
+
+	explicit NodeViewBase (const Node * r) : root (r) {}
+
+	static const Node * convert (node_id id) { return reinterpret_cast<const Node *> (id.value); }
+	static node_id convert (const Node * node) {
+		return node_id (reinterpret_cast<std::intptr_t> (node));
+	}
+
+	node_id invalid_node () const override { return convert (nullptr); }
+	edge_id invalid_edge () const override { return edge_id (0); }
+	node_id root_node () const override { return convert (root); }
+	node_id father_node (edge_id id) const override {
+		return convert (convert (child_node (id))->parent);
+	}
+	node_id child_node (edge_id id) const override { return node_id (id.value); }
+	edge_id father_edge (node_id id) const override { return edge_id (id.value); }
+	std::vector<edge_id> child_edges (node_id id) const override {
+		std::vector<edge_id> edges;
+		for (auto & child : convert (id)->children)
+			edges.push_back (father_edge (convert (child.get ())));
+		return edges;
+	}
+};
+struct NodeView final : NodeViewBase {
+	using NodeViewBase::NodeViewBase;
+};
+struct LinkedNodeView final : NodeViewBase {
+	using NodeViewBase::NodeViewBase;
+	edge_id first_child_edge (node_id id) const override {
+		auto node = convert (id);
+		return node->children.empty () ? invalid_edge ()
+		                               : father_edge (convert (node->children.front ().get ()));
+	}
+	edge_id next_sibling_edge (edge_id id) const override {
+		auto node = convert (child_node (id));
+		auto & siblings = node->parent->children;
+		auto next = node->index_in_parent + 1;
+		if (next == siblings.size ())
+			return invalid_edge ();
+		return father_edge (convert (siblings[next].get ()));
+	}
+};
+
+struct NodeTopology {
+	const Node * root;
+
+	using node_id = const Node *;
+	using edge_id = const Node *; // Child of the edge
+
+	node_id invalid_node () const { return nullptr; }
+	edge_id invalid_edge () const { return nullptr; }
+	node_id root_node () const { return root; }
+	node_id child_node (edge_id id) const { return id; }
+	node_id father_node (edge_id id) const { return id->parent; }
+	edge_id father_edge (node_id id) const { return id; }
+	auto child_edges (node_id id) const {
+		return id->children |
+		       duck::map ([](const std::unique_ptr<Node> & child) -> edge_id { return child.get (); });
+	}
+};
+struct LinkedNodeTopology : NodeTopology {
+	edge_id first_child_edge (node_id id) const {
+		return id->children.empty () ? nullptr : id->children.front ().get ();
+	}
+	edge_id next_sibling_edge (edge_id id) const {
+		auto & siblings = id->parent->children;
+		auto next = id->index_in_parent + 1;
+		return next < siblings.size () ? siblings[next].get () : nullptr;
+	}
+};
+
+// Random recursive tree
+static std::unique_ptr<Node> make_tree (int n, std::vector<Node *> & nodes) {
+	std::minstd_rand random (42);
+	auto root = std::unique_ptr<Node> (new Node (0));
+	nodes.assign (1, root.get ());
+	for (int i = 1; i < n; ++i) {
+		auto parent = nodes[std::uniform_int_distribution<std::size_t> (0, nodes.size () - 1) (random)];
+		parent->children.emplace_back (new Node (i));
+		parent->children.back ()->parent = parent;
+		parent->children.back ()->index_in_parent = parent->children.size () - 1;
+		nodes.push_back (parent->children.back ().get ());
+	}
+	return root;
+}
+
+int main (int argc, char ** argv) {
+	auto iterations = bench::scaled (10, argc, argv);
+	constexpr int n = 1 << 20;
+	std::vector<Node *> nodes;
+	auto tree = make_tree (n, nodes);
+	NodeView view (tree.get ());
+	const duck::bidirectional_tree_topology & virtual_view = view;
+	NodeTopology topology{tree.get ()};
+	LinkedNodeView linked_view (tree.get ());
+	const duck::bidirectional_tree_topology & linked_virtual_view = linked_view;
+	LinkedNodeTopology linked_topology;
+	linked_topology.root = tree.get ();
+
+	std::printf ("pre-order walk, %d nodes\n", n);
+	bench::run ("  forward_dfs_range (virtual)", iterations, [&] {
+		long sum = 0;
+		for (auto id : duck::forward_dfs_range (virtual_view))
+			sum += NodeView::convert (id)->value;
+		bench::do_not_optimize (sum);
+	});
+	bench::run ("  forward_dfs_range (final NodeView)", iterations, [&] {
+		long sum = 0;
+		for (auto id : duck::forward_dfs_range (view))
+			sum += NodeView::convert (id)->value;
+		bench::do_not_optimize (sum);
+	});
+	bench::run ("  forward_dfs_range (NodeTopology)", iterations, [&] {
+		long sum = 0;
+		for (auto node : duck::forward_dfs_range (topology))
+			sum += node->value;
+		bench::do_not_optimize (sum);
+	});
+	bench::run ("  forward_dfs_range (virtual, linked)", iterations, [&] {
+		long sum = 0;
+		for (auto id : duck::forward_dfs_range (linked_virtual_view))
+			sum += NodeView::convert (id)->value;
+		bench::do_not_optimize (sum);
+	});
+	bench::run ("  forward_dfs_range (final LinkedNodeView)", iterations, [&] {
+		long sum = 0;
+		for (auto id : duck::forward_dfs_range (linked_view))
+			sum += NodeView::convert (id)->value;
+		bench::do_not_optimize (sum);
+	});
+	bench::run ("  forward_dfs_range (LinkedNodeTopology)", iterations, [&] {
+		long sum = 0;
+		for (auto node : duck::forward_dfs_range (linked_topology))
+			sum += node->value;
+		bench::do_not_optimize (sum);
+	});
+	bench::run ("  input_dfs_range (virtual)", iterations, [&] {
+		long sum = 0;
+		for (auto id : duck::input_dfs_range (virtual_view))
+			sum += NodeView::convert (id)->value;
+		bench::do_not_optimize (sum);
+	});
+	bench::run ("  input_dfs_range (final NodeView)", iterations, [&] {
+		long sum = 0;
+		for (auto id : duck::input_dfs_range (view))
+			sum += NodeView::convert (id)->value;
+		bench::do_not_optimize (sum);
+	});
+	bench::run ("  input_dfs_range (NodeTopology)", iterations, [&] {
+		long sum = 0;
+		for (auto node : duck::input_dfs_range (topology))
+			sum += node->value;
+		bench::do_not_optimize (sum);
+	});
+	bench::run ("  input_dfs_range (final LinkedNodeView)", iterations, [&] {
+		long sum = 0;
+		for (auto id : duck::input_dfs_range (linked_view))
+			sum += NodeView::convert (id)->value;
+		bench::do_not_optimize (sum);
+	});
+	bench::run ("  input_dfs_range (LinkedNodeTopology)", iterations, [&] {
+		long sum = 0;
+		for (auto node : duck::input_dfs_range (linked_topology))
+			sum += node->value;
+		bench::do_not_optimize (sum);
+	});
+	bench::run ("  LinearizedTree: build (virtual)", iterations,
+	            [&] { bench::do_not_optimize (duck::LinearizedTree (virtual_view).size ()); });
+	bench::run ("  LinearizedTree: build (NodeTopology)", iterations,
+	            [&] { bench::do_not_optimize (duck::linearize (topology).size ()); });
+	bench::run ("  LinearizedTree: build (LinkedNodeTopology)", iterations,
+	            [&] { bench::do_not_optimize (duck::linearize (linked_topology).size ()); });
+	duck::LinearizedTree linearized (view);
+	bench::run ("  LinearizedTree: nodes () scan", iterations, [&] {
+		long sum = 0;
+		for (auto id : linearized.nodes ())
+			sum += NodeView::convert (id)->value;
+		bench::do_not_optimize (sum);
+	});
+	bench::run ("  LinearizedTree: depths () scan", iterations, [&] {
+		long sum = 0;
+		for (auto depth : linearized.depths ())
+			sum += depth;
+		bench::do_not_optimize (sum);
+	});
+
+	constexpr int nb_queries = 1 << 16;
+	std::minstd_rand random (1);
+	std::uniform_int_distribution<int> any_node (0, n - 1);
+	std::vector<std::pair<int, int>> pairs (nb_queries); // Node values == creation order
+	for (auto & p : pairs)
+		p = {any_node (random) / 64, any_node (random)}; // Ancestors biased towards the root
+	std::vector<duck::LinearizedTree::index_type> index_of_value (n);
+	for (duck::LinearizedTree::index_type i = 0; i < linearized.size (); ++i)
+		index_of_value[std::size_t (NodeView::convert (linearized.node (i))->value)] = i;
+
+	std::printf ("ancestor checks, %d queries\n", nb_queries);
+	bench::run ("  father_edge / father_node walk (virtual)", iterations, [&] {
+		int count = 0;
+		const duck::bidirectional_tree_topology & topology = view;
+		for (auto & p : pairs) {
+			auto ancestor = NodeView::convert (nodes[std::size_t (p.first)]);
+			auto node = NodeView::convert (nodes[std::size_t (p.second)]);
+			while (node != ancestor && node != topology.invalid_node ())
+				node = topology.father_node (topology.father_edge (node));
+			count += node == ancestor;
+		}
+		bench::do_not_optimize (count);
+	});
+	bench::run ("  LinearizedTree::is_ancestor", iterations, [&] {
+		int count = 0;
+		for (auto & p : pairs)
+			count += linearized.is_ancestor (index_of_value[std::size_t (p.first)],
+			                                 index_of_value[std::size_t (p.second)]);
+		bench::do_not_optimize (count);
+	});
+	return 0;
+}
@@ -0,0 +1,71 @@
+// Column-wise data: index loops vs duck::zip over parallel vectors / spans.
+// Random access zip iterators are an index and the base iterators: zip loops compile to index loops
+// on pointers. Writes then need a runtime alias check to vectorize, which GCC only does from -O3
+// (same as a raw pointer loop) ; the vector index loop below vectorizes at -O2.
+// Usage: bench_zip [scale]
+
+#include <bench.h>
+
+#include <cstdio>
+#include <duck/range/combinator.h>
+#include <list>
+#include <tuple>
+#include <vector>
+
+int main (int argc, char ** argv) {
+	auto iterations = bench::scaled (2000, argc, argv);
+	constexpr std::size_t n = 1 << 14;
+	std::vector<float> x (n, 1.f);
+	std::vector<float> y (n, 2.f);
+	std::vector<float> out (n);
+	const float a = 3.f;
+
+	std::printf ("out = a * x + y, n=%zu\n", n);
+	bench::run ("  index loop", iterations, [&] {
+		for (std::size_t i = 0; i < n; ++i)
+			out[i] = a * x[i] + y[i];
+		bench::clobber_memory ();
+	});
+	bench::run ("  zip (vectors)", iterations, [&] {
+		for (auto t : duck::zip (out, x, y))
+			std::get<0> (t) = a * std::get<1> (t) + std::get<2> (t);
+		bench::clobber_memory ();
+	});
+	bench::run ("  zip (spans)", iterations, [&] {
+		for (auto t : duck::zip (duck::span<float> (out), duck::span<const float> (x),
+		                         duck::span<const float> (y)))
+			std::get<0> (t) = a * std::get<1> (t) + std::get<2> (t);
+		bench::clobber_memory ();
+	});
+
+	std::printf ("dot product, n=%zu\n", n);
+	bench::run ("  index loop", iterations, [&] {
+		double sum = 0;
+		for (std::size_t i = 0; i < n; ++i)
+			sum += double (x[i]) * double (y[i]);
+		bench::do_not_optimize (sum);
+	});
+	bench::run ("  zip", iterations, [&] {
+		double sum = 0;
+		for (auto t : duck::zip (x, y))
+			sum += double (std::get<0> (t)) * double (std::get<1> (t));
+		bench::do_not_optimize (sum);
+	});
+
+	std::printf ("forward inputs (list + vector), n=%zu\n", n);
+	std::list<float> l (x.begin (), x.end ());
+	bench::run ("  iterator loop", iterations / 10, [&] {
+		double sum = 0;
+		auto it = y.begin ();
+		for (auto lit = l.begin (); lit != l.end () && it != y.end (); ++lit, ++it)
+			sum += double (*lit) * double (*it);
+		bench::do_not_optimize (sum);
+	});
+	bench::run ("  zip", iterations / 10, [&] {
+		double sum = 0;
+		for (auto t : duck::zip (l, y))
+			sum += double (std::get<0> (t)) * double (std::get<1> (t));
+		bench::do_not_optimize (sum);
+	});
+	return 0;
+}
@@ -0,0 +1,201 @@
+#pragma once
+
+// Execution policies for duck algorithms, and the chunked parallel loop they use.
+// STATUS: prototype
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <duck/thread_pool.h>
+#include <duck/type_traits.h>
+#include <exception>
+#include <memory>
+#include <mutex>
+
+namespace duck {
+
+/* Execution policies, mirroring C++17 <execution> for duck algorithms:
+ * - par ([pool[, grain]]): run on a ThreadPool (ThreadPool::default_pool () if not given).
+ * - par_unseq ([pool[, grain]]): same, and the element function may also be vectorized, so it must
+ *   not synchronize (locks, atomics ordering between elements).
+ * grain is the minimum number of elements per chunk: smaller inputs run serially on the caller.
+ * Ranges without random access iterators are always processed serially.
+ */
+class parallel_policy {
+public:
+	static constexpr std::size_t default_grain = 2048;
+
+	constexpr parallel_policy () = default;
+	constexpr explicit parallel_policy (ThreadPool * pool, std::size_t grain = default_grain)
+	    : pool_ (pool), grain_ (grain > 0 ? grain : 1) {}
+
+	ThreadPool & pool () const { return pool_ != nullptr ? *pool_ : ThreadPool::default_pool (); }
+	constexpr std::size_t grain () const noexcept { return grain_; }
+
+	// Same policy, with another grain.
+	parallel_policy with_grain (std::size_t grain) const noexcept {
+		return parallel_policy{pool_, grain};
+	}
+
+private:
+	ThreadPool * pool_{nullptr};
+	std::size_t grain_{default_grain};
+};
+
+class parallel_unsequenced_policy : public parallel_policy {
+public:
+	constexpr parallel_unsequenced_policy () = default;
+	constexpr explicit parallel_unsequenced_policy (ThreadPool * pool,
+	                                                std::size_t grain = default_grain)
+	    : parallel_policy (pool, grain) {}
+};
+
+inline parallel_policy par () {
+	return parallel_policy{};
+}
+inline parallel_policy par (ThreadPool & pool, std::size_t grain = parallel_policy::default_grain) {
+	return parallel_policy{&pool, grain};
+}
+inline parallel_unsequenced_policy par_unseq () {
+	return parallel_unsequenced_policy{};
+}
+inline parallel_unsequenced_policy par_unseq (ThreadPool & pool,
+                                              std::size_t grain = parallel_policy::default_grain) {
+	return parallel_unsequenced_policy{&pool, grain};
+}
+
+template <typename T> struct is_execution_policy : std::is_base_of<parallel_policy, decay_t<T>> {};
+
+namespace Detail {
+	/* Shared by the caller and pool helpers of one parallel_chunks call.
+	 * Chunks are claimed in increasing order from an atomic counter.
+	 * Helpers that start after all chunks are claimed do nothing, so waiting for chunk completion
+	 * (not helper completion) never deadlocks, even when called from inside a pool task.
+	 */
+	template <typename F> struct ParallelChunksState {
+		ParallelChunksState (std::size_t n_arg, std::size_t chunk_size_arg, F & f_arg)
+		    : n (n_arg),
+		      chunk_size (chunk_size_arg),
+		      nb_chunks ((n_arg + chunk_size_arg - 1) / chunk_size_arg),
+		      f (f_arg) {}
+
+		// Process chunks until none is left.
+		void work () {
+			for (;;) {
+				auto chunk = next_chunk.fetch_add (1, std::memory_order_relaxed);
+				if (chunk >= nb_chunks)
+					return;
+				if (!failed.load (std::memory_order_relaxed)) {
+					auto from = chunk * chunk_size;
+					try {
+						f (from, std::min (from + chunk_size, n));
+					} catch (...) {
+						std::lock_guard<std::mutex> lock (mutex);
+						if (!error)
+							error = std::current_exception ();
+						failed = true;
+					}
+				}
+				if (nb_done.fetch_add (1, std::memory_order_acq_rel) + 1 == nb_chunks) {
+					std::lock_guard<std::mutex> lock (mutex);
+					cv.notify_all ();
+				}
+			}
+		}
+		void wait () {
+			std::unique_lock<std::mutex> lock (mutex);
+			cv.wait (lock, [this] { return nb_done.load (std::memory_order_acquire) == nb_chunks; });
+		}
+
+		const std::size_t n;
+		const std::size_t chunk_size;
+		const std::size_t nb_chunks;
+		F & f;
+		std::atomic<std::size_t> next_chunk{0};
+		std::atomic<std::size_t> nb_done{0};
+		std::atomic<bool> failed{false};
+		std::mutex mutex;
+		std::condition_variable cv;
+		std::exception_ptr error;
+	};
+
+	/* Call f (from, to) on chunks covering [0, n), in parallel on the policy pool.
+	 * The calling thread processes chunks too.
+	 * The first exception thrown by f is rethrown after all chunks are done (others are skipped).
+	 */
+	template <typename F> void parallel_chunks (const parallel_policy & policy, std::size_t n, F f) {
+		if (n == 0)
+			return;
+		auto & pool = policy.pool ();
+		auto nb_threads = pool.size () + 1;
+		if (n <= policy.grain () || nb_threads == 1) {
+			f (std::size_t (0), n);
+			return;
+		}
+		// A few chunks per thread for load balancing, but no less than grain elements each.
+		auto chunk_size = std::max (policy.grain (), (n + 4 * nb_threads - 1) / (4 * nb_threads));
+		auto state = std::make_shared<ParallelChunksState<F>> (n, chunk_size, f);
+		auto nb_helpers = std::min (state->nb_chunks - 1, pool.size ());
+		for (std::size_t i = 0; i < nb_helpers; ++i)
+			pool.spawn ([state] { state->work (); });
+		state->work ();
+		state->wait ();
+		if (state->error)
+			std::rethrow_exception (state->error);
+	}
+
+	/* Fixed partition of [0, n) in blocks, for algorithms combining per block results in order
+	 * (reductions, scans): a few blocks per thread, of at least grain elements.
+	 * parallel_blocks calls f (block, from, to) for each block, in parallel.
+	 */
+	inline std::size_t parallel_block_size (const parallel_policy & policy, std::size_t n) {
+		auto nb_threads = policy.pool ().size () + 1;
+		return std::max (policy.grain (), (n + 4 * nb_threads - 1) / (4 * nb_threads));
+	}
+	inline std::size_t parallel_nb_blocks (std::size_t n, std::size_t block_size) {
+		return (n + block_size - 1) / block_size;
+	}
+	template <typename F>
+	void parallel_blocks (const parallel_policy & policy, std::size_t n, std::size_t block_size,
+	                      F f) {
+		auto nb_blocks = parallel_nb_blocks (n, block_size);
+		parallel_chunks (policy.with_grain (1), nb_blocks,
+		                 [n, block_size, &f](std::size_t first_block, std::size_t last_block) {
+			                 for (auto b = first_block; b < last_block; ++b)
+				                 f (b, b * block_size, std::min (n, (b + 1) * block_size));
+		                 });
+	}
+
+	// Atomically lower target to value if smaller.
+	inline void atomic_min (std::atomic<std::size_t> & target, std::size_t value) noexcept {
+		auto current = target.load (std::memory_order_relaxed);
+		while (value < current &&
+		       !target.compare_exchange_weak (current, value, std::memory_order_relaxed))
+			;
+	}
+
+	/* Smallest index i in [0, n) matching a search, or n.
+	 * find_in (from, to) returns the first match in [from, to), or to.
+	 * Chunks are claimed in order, and searched by blocks: blocks after the best match so far are
+	 * skipped (early cancellation).
+	 */
+	template <typename FindIn>
+	std::size_t parallel_find_index (const parallel_policy & policy, std::size_t n, FindIn find_in) {
+		constexpr std::size_t block_size = 1024;
+		std::atomic<std::size_t> best{n};
+		parallel_chunks (policy, n, [&best, &find_in](std::size_t from, std::size_t to) {
+			while (from < to && from < best.load (std::memory_order_relaxed)) {
+				auto block_end = std::min (from + block_size, to);
+				auto i = find_in (from, block_end);
+				if (i != block_end) {
+					atomic_min (best, i);
+					return;
+				}
+				from = block_end;
+			}
+		});
+		return best.load ();
+	}
+} // namespace Detail
+} // namespace duck
@@ -0,0 +1,291 @@
+#pragma once
+
+// Freeze-time compaction: copy an object graph into a single allocation owned by a FrozenPtr.
+// STATUS: prototype
+
+#include <cstddef>
+#include <cstdint>
+#include <duck/frozen_ptr.h>
+#include <duck/type_traits.h>
+#include <memory>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace duck {
+
+class CompactArena {
+	/* Bump allocator over a fixed buffer, filled once by freeze_compact.
+	 * Allocations that do not fit (underestimated compact_size) spill to the heap.
+	 * Deallocation of arena memory is a no-op ; it is released with the whole buffer.
+	 */
+public:
+	CompactArena () = default;
+	CompactArena (void * buffer, std::size_t capacity) noexcept
+	    : begin_ (static_cast<char *> (buffer)), cursor_ (begin_), end_ (begin_ + capacity) {}
+
+	void * allocate (std::size_t bytes, std::size_t alignment) {
+		auto current = reinterpret_cast<std::uintptr_t> (cursor_);
+		auto aligned = (current + alignment - 1) & ~std::uintptr_t (alignment - 1);
+		if (!sealed_ && aligned + bytes <= reinterpret_cast<std::uintptr_t> (end_)) {
+			cursor_ = reinterpret_cast<char *> (aligned + bytes);
+			return reinterpret_cast<void *> (aligned);
+		}
+		spilled_ += bytes;
+		return ::operator new (bytes);
+	}
+	void deallocate (void * p) noexcept {
+		if (!owns (p))
+			::operator delete (p);
+	}
+	bool owns (const void * p) const noexcept {
+		auto c = static_cast<const char *> (p);
+		return begin_ <= c && c < end_;
+	}
+
+	// After compaction, new allocations (from copies of arena containers) go to the heap.
+	void seal () noexcept { sealed_ = true; }
+
+	std::size_t capacity () const noexcept { return static_cast<std::size_t> (end_ - begin_); }
+	std::size_t used () const noexcept { return static_cast<std::size_t> (cursor_ - begin_); }
+	std::size_t spilled () const noexcept { return spilled_; }
+
+	// Copy an allocator aware container (using CompactAllocator) into the arena.
+	template <typename Container> Container copy (const Container & c);
+
+private:
+	char * begin_{nullptr};
+	char * cursor_{nullptr};
+	char * end_{nullptr};
+	std::size_t spilled_{0};
+	bool sealed_{false};
+};
+
+template <typename T> class CompactAllocator {
+	/* Allocator for containers of compactable types.
+	 * Default constructed, it uses the heap (build phase) ; created from an arena, it allocates from
+	 * it. Inner allocator aware elements are given the same allocator (like
+	 * scoped_allocator_adaptor), and elements with CompactTraits are compacted, so a whole container
+	 * tree lands in the arena.
+	 */
+public:
+	using value_type = T;
+	using propagate_on_container_copy_assignment = std::false_type;
+	using propagate_on_container_move_assignment = std::false_type;
+	using propagate_on_container_swap = std::false_type;
+
+	CompactAllocator () = default;
+	explicit CompactAllocator (CompactArena * arena) noexcept : arena_ (arena) {}
+	template <typename U>
+	CompactAllocator (const CompactAllocator<U> & other) noexcept : arena_ (other.arena ()) {}
+
+	T * allocate (std::size_t n) {
+		if (arena_ != nullptr)
+			return static_cast<T *> (arena_->allocate (n * sizeof (T), alignof (T)));
+		return static_cast<T *> (::operator new (n * sizeof (T)));
+	}
+	void deallocate (T * p, std::size_t) noexcept {
+		if (arena_ != nullptr)
+			arena_->deallocate (p);
+		else
+			::operator delete (p);
+	}
+
+	template <typename U, typename... Args> void construct (U * p, Args &&... args);
+	template <typename U> void destroy (U * p) { p->~U (); }
+
+	// Copies of a compacted container are normal heap containers.
+	CompactAllocator select_on_container_copy_construction () const noexcept { return {}; }
+
+	CompactArena * arena () const noexcept { return arena_; }
+
+private:
+	CompactArena * arena_{nullptr};
+};
+template <typename T, typename U>
+bool operator== (const CompactAllocator<T> & lhs, const CompactAllocator<U> & rhs) noexcept {
+	return lhs.arena () == rhs.arena ();
+}
+template <typename T, typename U>
+bool operator!= (const CompactAllocator<T> & lhs, const CompactAllocator<U> & rhs) noexcept {
+	return !(lhs == rhs);
+}
+
+template <typename T> using CompactVector = std::vector<T, CompactAllocator<T>>;
+using CompactString = std::basic_string<char, std::char_traits<char>, CompactAllocator<char>>;
+
+/* Opt-in compaction trait.
+ * A specialization for T must provide:
+ * - static std::size_t compact_size (const T & t): arena bytes needed for out of line data of t.
+ *   Use compact_size (member) to sum members ; an underestimation spills to the heap.
+ * - static void compact (void * where, const T & t, CompactArena & arena): construct a copy of t at
+ *   where, with out of line data in the arena (see CompactArena::copy).
+ * Destroying the copy must not free arena memory individually: use CompactAllocator containers.
+ *
+ * Specializations are provided for CompactVector and CompactString.
+ */
+template <typename T, typename = void> struct CompactTraits {};
+
+template <typename T, typename = void> struct is_compactable : std::false_type {};
+template <typename T>
+struct is_compactable<
+    T, void_t<decltype (CompactTraits<T>::compact_size (std::declval<const T &> ()))>>
+    : std::true_type {};
+
+namespace Detail {
+	// Arena allocations are counted with worst case alignment padding.
+	inline std::size_t compact_round (std::size_t bytes) noexcept {
+		constexpr auto align = alignof (std::max_align_t);
+		return (bytes + align - 1) / align * align;
+	}
+	template <typename T> std::size_t compact_size (const T & t, std::true_type) {
+		return CompactTraits<T>::compact_size (t);
+	}
+	template <typename T> std::size_t compact_size (const T &, std::false_type) { return 0; }
+} // namespace Detail
+
+// Arena bytes needed by t (0 for types without CompactTraits).
+template <typename T> std::size_t compact_size (const T & t) {
+	return Detail::compact_size (t, is_compactable<T>{});
+}
+
+template <typename T> struct CompactTraits<CompactVector<T>> {
+	static std::size_t compact_size (const CompactVector<T> & v) {
+		auto size = v.empty () ? 0 : Detail::compact_round (v.size () * sizeof (T));
+		if (is_compactable<T>::value) {
+			for (const auto & element : v)
+				size += duck::compact_size (element);
+		}
+		return size;
+	}
+	static void compact (void * where, const CompactVector<T> & v, CompactArena & arena) {
+		::new (where) CompactVector<T> (arena.copy (v));
+	}
+};
+template <> struct CompactTraits<CompactString> {
+	static std::size_t compact_size (const CompactString & s) {
+		// Small strings may not allocate, overestimating is fine.
+		return Detail::compact_round (s.size () + 1);
+	}
+	static void compact (void * where, const CompactString & s, CompactArena & arena) {
+		::new (where) CompactString (arena.copy (s));
+	}
+};
+
+template <typename Container> Container CompactArena::copy (const Container & c) {
+	return Container (c, typename Container::allocator_type (this));
+}
+
+namespace Detail {
+	template <typename U>
+	void compact_copy (U * p, const U & u, CompactArena & arena, std::true_type) {
+		CompactTraits<U>::compact (p, u, arena);
+	}
+	template <typename U> void compact_copy (U * p, const U & u, CompactArena &, std::false_type) {
+		::new (p) U (u);
+	}
+
+	template <typename U, typename Alloc, typename... Args>
+	void compact_construct (U * p, const Alloc & alloc, std::true_type /*uses_allocator*/,
+	                        Args &&... args) {
+		::new (p) U (std::forward<Args> (args)..., alloc);
+	}
+	template <typename U, typename Alloc, typename... Args>
+	void compact_construct (U * p, const Alloc &, std::false_type /*uses_allocator*/,
+	                        Args &&... args) {
+		::new (p) U (std::forward<Args> (args)...);
+	}
+	// Copy of a compactable element into an arena uses its CompactTraits.
+	template <typename U, typename Alloc>
+	void compact_construct (U * p, const Alloc & alloc, std::false_type /*uses_allocator*/,
+	                        const U & u) {
+		if (alloc.arena () != nullptr && is_compactable<U>::value)
+			compact_copy (p, u, *alloc.arena (), is_compactable<U>{});
+		else
+			::new (p) U (u);
+	}
+} // namespace Detail
+
+template <typename T>
+template <typename U, typename... Args>
+void CompactAllocator<T>::construct (U * p, Args &&... args) {
+	Detail::compact_construct (p, *this, std::uses_allocator<U, CompactAllocator>{},
+	                           std::forward<Args> (args)...);
+}
+
+namespace Detail {
+	template <typename T> class CompactBlock {
+		// Stored in the shared_ptr control block allocation, followed by the arena buffer.
+	public:
+		CompactBlock (const T & value, const CompactArena & arena) : arena_ (arena) {
+			CompactTraits<T>::compact (&storage_, value, arena_);
+			arena_.seal ();
+		}
+		~CompactBlock () { get ()->~T (); }
+		CompactBlock (const CompactBlock &) = delete;
+		CompactBlock & operator= (const CompactBlock &) = delete;
+
+		const T * get () const noexcept { return reinterpret_cast<const T *> (&storage_); }
+		const CompactArena & arena () const noexcept { return arena_; }
+
+	private:
+		CompactArena arena_;
+		aligned_storage_t<sizeof (T), alignof (T)> storage_;
+	};
+
+	template <typename T> class CompactBlockAllocator {
+		/* Allocator for allocate_shared: appends arena_size bytes to the control block allocation.
+		 * The arena bounds are reported to *arena, before the CompactBlock is constructed.
+		 */
+	public:
+		using value_type = T;
+
+		CompactBlockAllocator (std::size_t arena_size, CompactArena * arena) noexcept
+		    : arena_size_ (arena_size), arena_ (arena) {}
+		template <typename U>
+		CompactBlockAllocator (const CompactBlockAllocator<U> & other) noexcept
+		    : arena_size_ (other.arena_size_), arena_ (other.arena_) {}
+
+		T * allocate (std::size_t n) {
+			auto header = compact_round (n * sizeof (T));
+			auto block = static_cast<char *> (::operator new (header + arena_size_));
+			*arena_ = CompactArena (block + header, arena_size_);
+			return reinterpret_cast<T *> (block);
+		}
+		void deallocate (T * p, std::size_t) noexcept { ::operator delete (p); }
+
+		template <typename U> bool operator== (const CompactBlockAllocator<U> &) const noexcept {
+			return true;
+		}
+		template <typename U> bool operator!= (const CompactBlockAllocator<U> &) const noexcept {
+			return false;
+		}
+
+	private:
+		template <typename U> friend class CompactBlockAllocator;
+		std::size_t arena_size_;
+		CompactArena * arena_;
+	};
+} // namespace Detail
+
+/* Make a frozen compact copy of value: the object and its out of line data (as described by
+ * CompactTraits<T>) are in one allocation with the reference count. Lookups get good locality, and
+ * destruction is a single deallocation.
+ */
+template <typename T> FrozenPtr<T> make_frozen_compact (const T & value) {
+	static_assert (is_compactable<T>::value, "T must have a CompactTraits specialization");
+	CompactArena arena;
+	auto block = std::allocate_shared<Detail::CompactBlock<T>> (
+	    Detail::CompactBlockAllocator<Detail::CompactBlock<T>> (compact_size (value), &arena), value,
+	    arena);
+	auto value_ptr = block->get ();
+	return FrozenPtr<T>::from_shared (std::shared_ptr<const T> (std::move (block), value_ptr));
+}
+
+// Freeze with compaction: the build phase object is released after the compact copy.
+template <typename T> FrozenPtr<T> freeze_compact (FreezablePtr<T> && ptr) {
+	auto owned = std::move (ptr);
+	return make_frozen_compact (*owned);
+}
+} // namespace duck
@@ -82,7 +82,8 @@ template <typename T> class FrozenPtr {
 public:
 	using ConstT = add_const_t<T>;
 
-	// All move/copy constructor/assignemnt default
+	// Null by default ; all move/copy constructor/assignemnt default
+	FrozenPtr () = default;
 
 	// Move construct from FreezablePtr
 	FrozenPtr (FreezablePtr<T> && ptr) noexcept
@@ -125,14 +126,28 @@ public:
 	// Impl access (considered internal)
 	const std::shared_ptr<ConstT> & get_shared () const & noexcept { return ptr_; }
 	std::shared_ptr<ConstT> && get_shared () && noexcept { return std::move (ptr_); }
+	// The shared_ptr must come from a FrozenPtr (weak_ptr lock, aliasing) to keep the properties !
+	static FrozenPtr from_shared (std::shared_ptr<ConstT> ptr) noexcept {
+		return FrozenPtr{std::move (ptr)};
+	}
 
 private:
-	// Only used by shared_from_this
+	// Only used by shared_from_this and from_shared
 	FrozenPtr (std::shared_ptr<ConstT> && ptr) noexcept : ptr_ (std::move (ptr)) {}
 
 	std::shared_ptr<ConstT> ptr_;
 };
 
+// Comparison is identity of the pointed object
+template <typename T, typename U>
+bool operator== (const FrozenPtr<T> & lhs, const FrozenPtr<U> & rhs) noexcept {
+	return lhs.get () == rhs.get ();
+}
+template <typename T, typename U>
+bool operator!= (const FrozenPtr<T> & lhs, const FrozenPtr<U> & rhs) noexcept {
+	return lhs.get () != rhs.get ();
+}
+
 // Similar to std::make_shared
 template <typename T, typename... Args> FrozenPtr<T> make_frozen (Args &&... args) {
 	return FrozenPtr<T>::make (std::forward<Args> (args)...);
@@ -0,0 +1,180 @@
+#pragma once
+
+// Single writer, then multiple readers pointer type, with an intrusive reference count.
+// STATUS: prototype
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <duck/type_traits.h>
+#include <utility>
+
+namespace duck {
+
+/* Reference counting policies.
+ * ThreadSafeRefCount uses atomic operations, and can be shared between threads.
+ * ThreadUnsafeRefCount is a plain integer, for single threaded pipelines.
+ *
+ * A new count starts at 1 (the creating reference).
+ * decrement() returns true if the last reference was released.
+ */
+class ThreadSafeRefCount {
+public:
+	void increment () noexcept { count_.fetch_add (1, std::memory_order_relaxed); }
+	bool decrement () noexcept { return count_.fetch_sub (1, std::memory_order_acq_rel) == 1; }
+	std::size_t count () const noexcept { return count_.load (std::memory_order_relaxed); }
+
+private:
+	std::atomic<std::size_t> count_{1};
+};
+class ThreadUnsafeRefCount {
+public:
+	void increment () noexcept { ++count_; }
+	bool decrement () noexcept { return --count_ == 0; }
+	std::size_t count () const noexcept { return count_; }
+
+private:
+	std::size_t count_{1};
+};
+
+// Forward declaration
+template <typename T, typename RefCount = ThreadSafeRefCount> class FreezableRef;
+template <typename T, typename RefCount = ThreadSafeRefCount> class FrozenRef;
+
+namespace Detail {
+	// Single allocation: reference count next to the object.
+	template <typename T, typename RefCount> struct FrozenRefBlock {
+		RefCount ref_count;
+		T value;
+
+		template <typename... Args>
+		FrozenRefBlock (in_place_t, Args &&... args) : value (std::forward<Args> (args)...) {}
+	};
+} // namespace Detail
+
+template <typename T, typename RefCount> class FreezableRef {
+	/* A unique pointer to a mutable ressource, allocated with its reference count.
+	 * Same contract as FreezablePtr: built and modified by one owner, then frozen to be shared.
+	 * Copy is disabled, a moved-from FreezableRef is null.
+	 */
+public:
+	FreezableRef () = default;
+	FreezableRef (const FreezableRef &) = delete;
+	FreezableRef & operator= (const FreezableRef &) = delete;
+	FreezableRef (FreezableRef && other) noexcept : block_ (other.block_) { other.block_ = nullptr; }
+	FreezableRef & operator= (FreezableRef && other) noexcept {
+		if (this != &other) {
+			delete block_;
+			block_ = other.block_;
+			other.block_ = nullptr;
+		}
+		return *this;
+	}
+	~FreezableRef () { delete block_; }
+
+	template <typename... Args> static FreezableRef make (Args &&... args) {
+		return FreezableRef{new Block (in_place, std::forward<Args> (args)...)};
+	}
+
+	// Access
+	constexpr explicit operator bool () const noexcept { return block_ != nullptr; }
+	T * get () const noexcept { return block_ != nullptr ? &block_->value : nullptr; }
+	T & operator* () const noexcept { return block_->value; }
+	T * operator-> () const noexcept { return get (); }
+
+	// Transform to a FrozenRef
+	FrozenRef<T, RefCount> freeze () &&;
+
+private:
+	using Block = Detail::FrozenRefBlock<T, RefCount>;
+	friend class FrozenRef<T, RefCount>;
+
+	explicit FreezableRef (Block * block) noexcept : block_ (block) {}
+
+	Block * block_{nullptr};
+};
+
+template <typename T, typename... Args> FreezableRef<T> make_freezable_ref (Args &&... args) {
+	return FreezableRef<T>::make (std::forward<Args> (args)...);
+}
+
+template <typename T, typename RefCount> class FrozenRef {
+	/* A shared pointer to an immutable ressource.
+	 *
+	 * Alternative to FrozenPtr:
+	 * - the size of one pointer (to the allocated block), instead of two for shared_ptr.
+	 * - the reference count is stored in the same allocation as the object.
+	 * - no weak references, no custom deleter.
+	 * - the reference count policy is chosen statically: use ThreadUnsafeRefCount to avoid atomic
+	 *   operations if all references stay in one thread.
+	 *
+	 * No upcast conversion: the block pointer must keep the exact allocated type.
+	 */
+public:
+	using ConstT = add_const_t<T>;
+
+	FrozenRef () = default;
+	FrozenRef (const FrozenRef & other) noexcept : block_ (other.block_) {
+		if (block_ != nullptr)
+			block_->ref_count.increment ();
+	}
+	FrozenRef (FrozenRef && other) noexcept : block_ (other.block_) { other.block_ = nullptr; }
+	FrozenRef & operator= (const FrozenRef & other) noexcept {
+		FrozenRef{other}.swap (*this);
+		return *this;
+	}
+	FrozenRef & operator= (FrozenRef && other) noexcept {
+		FrozenRef{std::move (other)}.swap (*this);
+		return *this;
+	}
+	~FrozenRef () { reset (); }
+
+	// Move construct from FreezableRef
+	FrozenRef (FreezableRef<T, RefCount> && ptr) noexcept : block_ (ptr.block_) {
+		ptr.block_ = nullptr;
+	}
+
+	// Build in place (skip FreezableRef)
+	template <typename... Args> static FrozenRef make (Args &&... args) {
+		return FreezableRef<T, RefCount>::make (std::forward<Args> (args)...).freeze ();
+	}
+
+	// Access
+	constexpr explicit operator bool () const noexcept { return block_ != nullptr; }
+	ConstT * get () const noexcept { return block_ != nullptr ? &block_->value : nullptr; }
+	ConstT & operator* () const noexcept { return block_->value; }
+	ConstT * operator-> () const noexcept { return get (); }
+
+	// Number of FrozenRef sharing the object (0 if null)
+	std::size_t use_count () const noexcept {
+		return block_ != nullptr ? block_->ref_count.count () : 0;
+	}
+
+	void reset () noexcept {
+		if (block_ != nullptr && block_->ref_count.decrement ())
+			delete block_;
+		block_ = nullptr;
+	}
+	void swap (FrozenRef & other) noexcept { std::swap (block_, other.block_); }
+
+private:
+	using Block = Detail::FrozenRefBlock<T, RefCount>;
+
+	Block * block_{nullptr};
+};
+
+// Similar to make_frozen
+template <typename T, typename... Args> FrozenRef<T> make_frozen_ref (Args &&... args) {
+	return FrozenRef<T>::make (std::forward<Args> (args)...);
+}
+
+// Single threaded variants
+template <typename T> using LocalFreezableRef = FreezableRef<T, ThreadUnsafeRefCount>;
+template <typename T> using LocalFrozenRef = FrozenRef<T, ThreadUnsafeRefCount>;
+
+// Deferred freeze() impl
+template <typename T, typename RefCount>
+FrozenRef<T, RefCount> FreezableRef<T, RefCount>::freeze () && {
+	return FrozenRef<T, RefCount>{std::move (*this)};
+}
+} // namespace duck
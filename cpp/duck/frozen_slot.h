@@ -0,0 +1,210 @@
+#pragma once
+
+// Publication slot for FrozenPtr: one writer publishes snapshots, many readers load them.
+// STATUS: prototype
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <duck/frozen_ptr.h>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace duck {
+
+template <typename T> class FrozenSlot {
+	/* Holds the current FrozenPtr<T> snapshot, replaced by store().
+	 *
+	 * Readers take snapshots through a Reader handle, which owns a reader record in the slot.
+	 * Reader::load() is wait-free: announce the current epoch, load the published node, copy its
+	 * FrozenPtr (one reference count increment), clear the announcement.
+	 * No lock is taken, unlike std::atomic_load on a shared_ptr.
+	 *
+	 * Published snapshots are stored in heap nodes.
+	 * store() swaps the node, retires the old one, and reclaims retired nodes using epochs:
+	 * a node retired at epoch E is deleted once no reader announces an epoch <= E.
+	 * Only readers that started before the swap can still see the old node, and they all announced
+	 * an epoch <= E. Reclamation is done by writers, readers never free anything.
+	 *
+	 * Writers are serialized by a mutex, which is never touched by readers.
+	 * All Reader handles must be destroyed before the slot.
+	 */
+private:
+	struct Node {
+		FrozenPtr<T> value;
+		Node (FrozenPtr<T> && v) noexcept : value (std::move (v)) {}
+	};
+	struct RetiredNode {
+		Node * node;
+		std::uint64_t epoch;
+	};
+	static constexpr std::uint64_t not_reading = 0;
+	// One cache line per reader, to avoid false sharing between readers.
+	struct alignas (64) ReaderRecord {
+		std::atomic<std::uint64_t> epoch{not_reading};
+		std::atomic<bool> claimed{false};
+	};
+	class ReaderRecords {
+		// Array of ReaderRecord aligned by hand: new T[n] ignores over-alignment before C++17.
+	public:
+		explicit ReaderRecords (std::size_t n)
+		    : storage_ (new char[n * sizeof (ReaderRecord) + alignof (ReaderRecord)]), size_ (n) {
+			void * p = storage_.get ();
+			auto space = n * sizeof (ReaderRecord) + alignof (ReaderRecord);
+			records_ = static_cast<ReaderRecord *> (
+			    std::align (alignof (ReaderRecord), n * sizeof (ReaderRecord), p, space));
+			for (std::size_t i = 0; i < n; ++i)
+				new (&records_[i]) ReaderRecord;
+		}
+		~ReaderRecords () {
+			for (std::size_t i = 0; i < size_; ++i)
+				records_[i].~ReaderRecord ();
+		}
+		ReaderRecords (const ReaderRecords &) = delete;
+		ReaderRecords & operator= (const ReaderRecords &) = delete;
+
+		ReaderRecord & operator[] (std::size_t i) const noexcept { return records_[i]; }
+
+	private:
+		std::unique_ptr<char[]> storage_;
+		std::size_t size_;
+		ReaderRecord * records_;
+	};
+
+public:
+	class Reader {
+	public:
+		Reader (const Reader &) = delete;
+		Reader & operator= (const Reader &) = delete;
+		Reader (Reader && other) noexcept : slot_ (other.slot_), record_ (other.record_) {
+			other.record_ = nullptr;
+		}
+		Reader & operator= (Reader && other) noexcept {
+			std::swap (slot_, other.slot_);
+			std::swap (record_, other.record_);
+			return *this;
+		}
+		~Reader () {
+			if (record_ != nullptr)
+				record_->claimed.store (false, std::memory_order_release);
+		}
+
+		// Wait-free snapshot of the current value.
+		FrozenPtr<T> load () const { return slot_->load_with_record (*record_); }
+
+	private:
+		friend class FrozenSlot;
+		Reader (const FrozenSlot & slot, ReaderRecord & record) noexcept
+		    : slot_ (&slot), record_ (&record) {}
+
+		const FrozenSlot * slot_;
+		ReaderRecord * record_;
+	};
+
+	/* max_readers is the maximum number of simultaneous readers (Reader handles and load() calls).
+	 * Defaults to 2 readers per hardware thread, with a minimum of 16.
+	 */
+	explicit FrozenSlot (FrozenPtr<T> initial = {}, std::size_t max_readers = default_max_readers ())
+	    : current_ (new Node (std::move (initial))),
+	      max_readers_ (max_readers),
+	      records_ (max_readers) {}
+	FrozenSlot (const FrozenSlot &) = delete;
+	FrozenSlot & operator= (const FrozenSlot &) = delete;
+	~FrozenSlot () {
+		delete current_.load (std::memory_order_relaxed);
+		for (auto & retired : retired_)
+			delete retired.node;
+	}
+
+	static std::size_t default_max_readers () {
+		auto threads = static_cast<std::size_t> (std::thread::hardware_concurrency ());
+		return std::max (2 * threads, std::size_t (16));
+	}
+
+	// Publish a new snapshot. Old snapshots are reclaimed if they are no longer read.
+	void store (FrozenPtr<T> ptr) {
+		auto * node = new Node (std::move (ptr));
+		std::lock_guard<std::mutex> lock (writer_mutex_);
+		auto * old = current_.exchange (node, std::memory_order_seq_cst);
+		auto retire_epoch = epoch_.fetch_add (1, std::memory_order_seq_cst);
+		retired_.push_back (RetiredNode{old, retire_epoch});
+		reclaim_locked ();
+	}
+
+	// Get a reader handle, throws std::length_error if max_readers are already in use.
+	Reader reader () const {
+		auto * record = try_claim_record ();
+		if (record == nullptr)
+			throw std::length_error ("FrozenSlot: too many readers");
+		return Reader{*this, *record};
+	}
+
+	/* Snapshot without a Reader handle.
+	 * Claims a reader record for the duration of the call: lock-free but not wait-free.
+	 */
+	FrozenPtr<T> load () const { return reader ().load (); }
+
+	// Try to delete retired snapshots now (also done by store()).
+	void reclaim () {
+		std::lock_guard<std::mutex> lock (writer_mutex_);
+		reclaim_locked ();
+	}
+	// Number of retired snapshots not yet deleted.
+	std::size_t retired_count () const {
+		std::lock_guard<std::mutex> lock (writer_mutex_);
+		return retired_.size ();
+	}
+
+private:
+	FrozenPtr<T> load_with_record (ReaderRecord & record) const {
+		// Acquire: seeing a new epoch implies seeing the node swapped before its increment.
+		record.epoch.store (epoch_.load (std::memory_order_acquire), std::memory_order_seq_cst);
+		auto * node = current_.load (std::memory_order_seq_cst);
+		FrozenPtr<T> snapshot = node->value;
+		record.epoch.store (not_reading, std::memory_order_release);
+		return snapshot;
+	}
+
+	ReaderRecord * try_claim_record () const {
+		for (std::size_t i = 0; i < max_readers_; ++i) {
+			auto & record = records_[i];
+			if (!record.claimed.load (std::memory_order_relaxed) &&
+			    !record.claimed.exchange (true, std::memory_order_acquire))
+				return &record;
+		}
+		return nullptr;
+	}
+
+	void reclaim_locked () {
+		// Oldest epoch announced by an active reader
+		auto oldest_read = epoch_.load (std::memory_order_seq_cst);
+		for (std::size_t i = 0; i < max_readers_; ++i) {
+			auto e = records_[i].epoch.load (std::memory_order_seq_cst);
+			if (e != not_reading && e < oldest_read)
+				oldest_read = e;
+		}
+		auto still_read = [oldest_read](const RetiredNode & retired) {
+			return retired.epoch >= oldest_read;
+		};
+		auto it = std::partition (retired_.begin (), retired_.end (), still_read);
+		for (auto reclaimed = it; reclaimed != retired_.end (); ++reclaimed)
+			delete reclaimed->node;
+		retired_.erase (it, retired_.end ());
+	}
+
+	std::atomic<Node *> current_;
+	std::atomic<std::uint64_t> epoch_{1};
+	std::size_t max_readers_;
+	ReaderRecords records_;
+
+	// Writer side
+	mutable std::mutex writer_mutex_;
+	std::vector<RetiredNode> retired_;
+};
+} // namespace duck
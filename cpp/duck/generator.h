@@ -0,0 +1,249 @@
+#pragma once
+
+// Coroutine generators: input ranges produced with co_yield (requires C++20).
+// STATUS: prototype
+
+#if !defined(__cpp_impl_coroutine)
+#error "duck/generator.h requires C++20 coroutines"
+#endif
+
+#include <coroutine>
+#include <cstddef>
+#include <duck/range/range.h>
+#include <duck/type_traits.h>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace duck {
+namespace Detail {
+	/* Thread local cache of coroutine frames, by size class.
+	 * Generators are often short lived (one per parsed file, per sub tree...): their frames are
+	 * recycled instead of calling operator new / delete each time.
+	 * A frame released by another thread than the allocating one goes to the cache of the releasing
+	 * thread. After the destruction of the cache (thread exit), frames use operator new / delete.
+	 */
+	class GeneratorFrameCache {
+	public:
+		static constexpr std::size_t granularity = 64;
+		static constexpr std::size_t nb_classes = 32; // Frames up to 2KiB are recycled
+		static constexpr std::size_t max_cached = 16; // Per size class
+
+		GeneratorFrameCache () = default;
+		GeneratorFrameCache (const GeneratorFrameCache &) = delete;
+		GeneratorFrameCache & operator= (const GeneratorFrameCache &) = delete;
+		~GeneratorFrameCache () {
+			for (auto & list : free_)
+				while (list.head != nullptr)
+					::operator delete (std::exchange (list.head, list.head->next));
+		}
+
+		void * allocate (std::size_t size) {
+			auto c = size_class (size);
+			if (c >= nb_classes)
+				return ::operator new (size);
+			auto & list = free_[c];
+			if (list.head == nullptr)
+				return ::operator new ((c + 1) * granularity);
+			--list.count;
+			return std::exchange (list.head, list.head->next);
+		}
+		void deallocate (void * p, std::size_t size) noexcept {
+			auto c = size_class (size);
+			if (c < nb_classes && free_[c].count < max_cached) {
+				free_[c].head = ::new (p) Node{free_[c].head};
+				++free_[c].count;
+			} else {
+				::operator delete (p);
+			}
+		}
+
+		// Cache of the current thread, or nullptr if already destroyed
+		static GeneratorFrameCache * local () noexcept {
+			struct Local {
+				GeneratorFrameCache cache;
+				~Local () { alive () = false; }
+			};
+			static thread_local Local local;
+			return alive () ? &local.cache : nullptr;
+		}
+
+	private:
+		struct Node {
+			Node * next;
+		};
+		struct FreeList {
+			Node * head{nullptr};
+			std::size_t count{0};
+		};
+
+		static std::size_t size_class (std::size_t size) noexcept { return (size - 1) / granularity; }
+		static bool & alive () noexcept {
+			static thread_local bool alive = true; // Trivially destructible: usable until thread exit
+			return alive;
+		}
+
+		FreeList free_[nb_classes];
+	};
+
+	inline void * generator_frame_allocate (std::size_t size) {
+		if (auto cache = GeneratorFrameCache::local ())
+			return cache->allocate (size);
+		return ::operator new (size);
+	}
+	inline void generator_frame_deallocate (void * p, std::size_t size) noexcept {
+		if (auto cache = GeneratorFrameCache::local ())
+			cache->deallocate (p, size);
+		else
+			::operator delete (p);
+	}
+} // namespace Detail
+
+/* Generator: input range of the values produced by a coroutine with co_yield.
+ * > duck::generator<const Record &> parse (string_view text) {
+ * >     for (...) co_yield record;
+ * > }
+ * > for (auto & r : parse (text) | duck::filter (is_valid)) ...
+ *
+ * Values are not copied: iterators point to the yielded object, which lives in the coroutine
+ * until it is resumed (next increment).
+ * - generator<T &>, generator<const T &>: reference type is T & / const T &.
+ *   generator<const T &> accepts temporaries (co_yield f (x)).
+ * - generator<T>: reference type is T &, the values can be moved out by the consumer.
+ *   Lvalues of T and temporaries are not copied. Other values (const T, convertible types) are
+ *   copied in the coroutine frame.
+ *
+ * The coroutine starts at the first begin (); begin () can be called again and returns the current
+ * position (single pass, like istream ranges). Exceptions are propagated to begin / operator++.
+ * Coroutine frames come from a thread local recycling cache (Detail::GeneratorFrameCache).
+ * co_await is not supported in generators.
+ */
+template <typename T> class generator {
+public:
+	using value_type = remove_cvref_t<T>;
+	using reference = conditional_t<std::is_reference<T>::value, T, T &>;
+	using pointer = std::add_pointer_t<reference>;
+
+	class promise_type;
+	using handle_type = std::coroutine_handle<promise_type>;
+
+	class promise_type {
+	public:
+		generator get_return_object () noexcept {
+			return generator (handle_type::from_promise (*this));
+		}
+		std::suspend_always initial_suspend () const noexcept { return {}; }
+		std::suspend_always final_suspend () const noexcept { return {}; }
+		void return_void () const noexcept {}
+		void unhandled_exception () noexcept { exception_ = std::current_exception (); }
+
+		// Yielded objects stay alive while the coroutine is suspended: store their address.
+		std::suspend_always yield_value (reference v) noexcept {
+			value_ = std::addressof (v);
+			return {};
+		}
+		std::suspend_always yield_value (value_type && v) noexcept
+		    requires (!std::is_reference_v<T>) {
+			value_ = std::addressof (v);
+			return {};
+		}
+		// Other values are copied in the awaiter, which is part of the frame while suspended.
+		struct copy_awaiter {
+			value_type value;
+			bool await_ready () const noexcept { return false; }
+			void await_suspend (handle_type h) noexcept { h.promise ().value_ = std::addressof (value); }
+			void await_resume () const noexcept {}
+		};
+		template <typename U>
+		copy_awaiter yield_value (U && v) requires (!std::is_reference_v<T> &&
+		                                            std::is_constructible_v<value_type, U &&>) {
+			return copy_awaiter{value_type (std::forward<U> (v))};
+		}
+
+		template <typename U> std::suspend_never await_transform (U &&) = delete;
+
+		static void * operator new (std::size_t size) {
+			return Detail::generator_frame_allocate (size);
+		}
+		static void operator delete (void * p, std::size_t size) noexcept {
+			Detail::generator_frame_deallocate (p, size);
+		}
+
+	private:
+		friend class generator;
+
+		void rethrow_if_exception () {
+			if (exception_)
+				std::rethrow_exception (std::exchange (exception_, nullptr));
+		}
+
+		pointer value_{nullptr};
+		std::exception_ptr exception_{};
+		bool started_{false};
+	};
+
+	class iterator {
+	public:
+		using iterator_category = std::input_iterator_tag;
+		using value_type = generator::value_type;
+		using difference_type = std::ptrdiff_t;
+		using pointer = generator::pointer;
+		using reference = generator::reference;
+
+		iterator () = default;
+		explicit iterator (handle_type handle) noexcept : handle_ (handle) {}
+
+		// Input
+		iterator & operator++ () {
+			handle_.resume ();
+			handle_.promise ().rethrow_if_exception ();
+			return *this;
+		}
+		void operator++ (int) { ++*this; }
+		reference operator* () const { return static_cast<reference> (*handle_.promise ().value_); }
+		pointer operator-> () const { return handle_.promise ().value_; }
+		// Iterators are equal if both are at the end, or both are not
+		bool operator== (const iterator & o) const noexcept { return at_end () == o.at_end (); }
+		bool operator!= (const iterator & o) const noexcept { return !(*this == o); }
+
+	private:
+		bool at_end () const noexcept { return !handle_ || handle_.done (); }
+
+		handle_type handle_{};
+	};
+
+	generator () = default;
+	generator (generator && other) noexcept : handle_ (std::exchange (other.handle_, nullptr)) {}
+	generator & operator= (generator && other) noexcept {
+		if (this != &other) {
+			destroy ();
+			handle_ = std::exchange (other.handle_, nullptr);
+		}
+		return *this;
+	}
+	~generator () { destroy (); }
+
+	iterator begin () const {
+		if (handle_ && !handle_.promise ().started_) {
+			handle_.promise ().started_ = true;
+			handle_.resume ();
+			handle_.promise ().rethrow_if_exception ();
+		}
+		return iterator (handle_);
+	}
+	iterator end () const noexcept { return {}; }
+
+private:
+	explicit generator (handle_type handle) noexcept : handle_ (handle) {}
+
+	void destroy () noexcept {
+		if (handle_)
+			handle_.destroy ();
+	}
+
+	handle_type handle_{};
+};
+} // namespace duck
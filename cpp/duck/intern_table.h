@@ -0,0 +1,183 @@
+#pragma once
+
+// Hash-consing of immutable values: one canonical FrozenPtr per distinct value.
+// STATUS: prototype
+
+#include <cstddef>
+#include <cstdint>
+#include <duck/frozen_ptr.h>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace duck {
+
+template <typename T, typename Hash = std::hash<T>, typename KeyEqual = std::equal_to<T>>
+class InternTable {
+	/* Returns a canonical FrozenPtr<T> for each distinct value (by Hash / KeyEqual).
+	 * Interned values can then be compared by pointer, and duplicates share memory.
+	 *
+	 * Entries are weak: the table does not keep values alive.
+	 * When all FrozenPtr to a value are destroyed, its entry expires.
+	 * Expired entries are cleaned when encountered during probing, on growth, or by purge().
+	 * Note that a weak entry keeps the control block of the value (and its storage if allocated by
+	 * make_frozen) until cleaned.
+	 *
+	 * The table is split in shards selected by hash, each an open addressing table (linear probing)
+	 * protected by its own mutex. Concurrent interning of values in different shards do not contend.
+	 */
+public:
+	explicit InternTable (std::size_t nb_shards = default_nb_shards (), const Hash & hash = Hash (),
+	                      const KeyEqual & equal = KeyEqual ())
+	    : shards_ (round_up_to_power_of_2 (nb_shards)), hash_ (hash), equal_ (equal) {}
+
+	static std::size_t default_nb_shards () {
+		auto threads = static_cast<std::size_t> (std::thread::hardware_concurrency ());
+		return threads > 0 ? 4 * threads : 16;
+	}
+
+	// Get the canonical pointer for value ; the value is copied / moved if it is new.
+	FrozenPtr<T> intern (const T & value) {
+		return intern_impl (value, [&value] { return make_frozen<T> (value); });
+	}
+	FrozenPtr<T> intern (T && value) {
+		return intern_impl (value, [&value] { return make_frozen<T> (std::move (value)); });
+	}
+	// If new, ptr becomes the canonical pointer, avoiding a copy. A null ptr is returned as is.
+	FrozenPtr<T> intern (FrozenPtr<T> ptr) {
+		if (!ptr)
+			return ptr;
+		const auto & value = *ptr;
+		return intern_impl (value, [&ptr] { return std::move (ptr); });
+	}
+
+	// Number of entries (including expired entries not yet cleaned).
+	std::size_t size () const {
+		std::size_t n = 0;
+		for (const auto & shard : shards_) {
+			std::lock_guard<std::mutex> lock (shard.mutex);
+			n += shard.nb_entries;
+		}
+		return n;
+	}
+	// Remove all expired entries.
+	void purge () {
+		for (auto & shard : shards_) {
+			std::lock_guard<std::mutex> lock (shard.mutex);
+			shard.rehash (shard.slots.size ());
+		}
+	}
+
+private:
+	enum class SlotState : std::uint8_t { Empty, Used, Deleted };
+	struct Slot {
+		std::size_t hash{0};
+		std::weak_ptr<const T> entry;
+		SlotState state{SlotState::Empty};
+	};
+
+	struct Shard {
+		mutable std::mutex mutex;
+		std::vector<Slot> slots; // Size is 0 or a power of 2
+		std::size_t nb_entries{0};
+		std::size_t nb_deleted{0};
+
+		void erase (Slot & slot) {
+			slot.entry.reset ();
+			slot.state = SlotState::Deleted;
+			--nb_entries;
+			++nb_deleted;
+		}
+
+		// Rebuild with new_size slots, dropping expired and deleted entries.
+		void rehash (std::size_t new_size) {
+			std::vector<Slot> old (new_size);
+			old.swap (slots);
+			nb_entries = 0;
+			nb_deleted = 0;
+			for (auto & slot : old) {
+				if (slot.state == SlotState::Used && !slot.entry.expired ()) {
+					auto & target = slots[find_empty (slot.hash)];
+					target.hash = slot.hash;
+					target.entry = std::move (slot.entry);
+					target.state = SlotState::Used;
+					++nb_entries;
+				}
+			}
+		}
+		std::size_t find_empty (std::size_t hash) const {
+			auto mask = slots.size () - 1;
+			auto i = hash & mask;
+			while (slots[i].state != SlotState::Empty)
+				i = (i + 1) & mask;
+			return i;
+		}
+		void grow_if_needed () {
+			// Keep load factor (including deleted slots) under 3/4
+			auto used = nb_entries + nb_deleted + 1;
+			if (slots.empty ()) {
+				rehash (16);
+			} else if (4 * used > 3 * slots.size ()) {
+				// Only grow if live entries need it, otherwise just clean in place.
+				rehash (4 * (nb_entries + 1) > 2 * slots.size () ? 2 * slots.size () : slots.size ());
+			}
+		}
+	};
+
+	template <typename MakeNew> FrozenPtr<T> intern_impl (const T & value, MakeNew make_new) {
+		auto hash = mix (hash_ (value));
+		auto & shard = shards_[(hash >> shard_shift) & (shards_.size () - 1)];
+		std::lock_guard<std::mutex> lock (shard.mutex);
+
+		if (!shard.slots.empty ()) {
+			auto mask = shard.slots.size () - 1;
+			for (auto i = hash & mask; shard.slots[i].state != SlotState::Empty; i = (i + 1) & mask) {
+				auto & slot = shard.slots[i];
+				if (slot.state != SlotState::Used || slot.hash != hash)
+					continue;
+				auto existing = slot.entry.lock ();
+				if (!existing) {
+					shard.erase (slot); // Expired, clean it
+				} else if (equal_ (*existing, value)) {
+					return FrozenPtr<T>::from_shared (std::move (existing));
+				}
+			}
+		}
+
+		// Not found: insert
+		auto canonical = make_new ();
+		shard.grow_if_needed ();
+		auto & slot = shard.slots[shard.find_empty (hash)];
+		slot.hash = hash;
+		slot.entry = canonical.get_shared ();
+		slot.state = SlotState::Used;
+		++shard.nb_entries;
+		return canonical;
+	}
+
+	// Spread bits of weak hash functions (std::hash<int> is identity).
+	static std::size_t mix (std::size_t h) noexcept {
+		auto x = static_cast<std::uint64_t> (h);
+		x ^= x >> 33;
+		x *= 0xff51afd7ed558ccdULL;
+		x ^= x >> 33;
+		return static_cast<std::size_t> (x);
+	}
+	// Shards use high bits, slots in shards use low bits.
+	static constexpr unsigned shard_shift = sizeof (std::size_t) * 8 - 16;
+
+	static std::size_t round_up_to_power_of_2 (std::size_t n) {
+		std::size_t p = 1;
+		while (p < n)
+			p *= 2;
+		return p;
+	}
+
+	std::vector<Shard> shards_;
+	Hash hash_;
+	KeyEqual equal_;
+};
+} // namespace duck
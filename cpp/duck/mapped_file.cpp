@@ -0,0 +1,78 @@
+#include <duck/mapped_file.h>
+
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <system_error>
+#include <unistd.h>
+#include <utility>
+
+namespace duck {
+[[noreturn]] static void throw_system_error (int error, const std::string & what) {
+	throw std::system_error (error, std::generic_category (), "MappedFile: " + what);
+}
+
+static int advice_for (MappedFile::Access access) {
+	switch (access) {
+	case MappedFile::Access::sequential:
+		return MADV_SEQUENTIAL;
+	case MappedFile::Access::random:
+		return MADV_RANDOM;
+	default:
+		return MADV_NORMAL;
+	}
+}
+
+MappedFile::MappedFile (const std::string & path, Access access) {
+	int fd = ::open (path.c_str (), O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		throw_system_error (errno, "open '" + path + "'");
+	auto fail = [fd, &path](const char * what) {
+		int error = errno;
+		::close (fd);
+		throw_system_error (error, what + (" '" + path + "'"));
+	};
+	struct stat info;
+	if (::fstat (fd, &info) != 0)
+		fail ("stat");
+	auto size = static_cast<std::size_t> (info.st_size);
+	if (size > 0) { // mmap rejects empty mappings
+		auto p = ::mmap (nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (p == MAP_FAILED)
+			fail ("mmap");
+		data_ = static_cast<const char *> (p);
+		size_ = size;
+	}
+	::close (fd); // The mapping stays valid
+	advise (access);
+}
+
+MappedFile::~MappedFile () {
+	unmap ();
+}
+
+MappedFile::MappedFile (MappedFile && other) noexcept
+    : data_ (std::exchange (other.data_, nullptr)), size_ (std::exchange (other.size_, 0)) {}
+
+MappedFile & MappedFile::operator= (MappedFile && other) noexcept {
+	if (this != &other) {
+		unmap ();
+		data_ = std::exchange (other.data_, nullptr);
+		size_ = std::exchange (other.size_, 0);
+	}
+	return *this;
+}
+
+void MappedFile::advise (Access access) noexcept {
+	if (size_ > 0)
+		::madvise (const_cast<char *> (data_), size_, advice_for (access)); // Hint, may fail
+}
+
+void MappedFile::unmap () noexcept {
+	if (data_ != nullptr)
+		::munmap (const_cast<char *> (data_), size_);
+	data_ = nullptr;
+	size_ = 0;
+}
+} // namespace duck
@@ -0,0 +1,160 @@
+#pragma once
+
+// Memory mapped files, and lazy ranges of string_view on text / binary data
+// STATUS: prototype
+
+#include <cassert>
+#include <cstddef>
+#include <duck/range/range.h>
+#include <duck/view.h>
+#include <iterator>
+#include <string>
+
+namespace duck {
+/* Read only memory mapping of a whole file (POSIX mmap).
+ * The file content is accessible as span<const char> without copying it.
+ * Pages are loaded on demand by the kernel: multi GB files can be processed with constant memory.
+ * The access pattern hint is given to the kernel with madvise (readahead policy).
+ *
+ * Views (string_view, span) on the content are valid until the MappedFile is destroyed.
+ * Move only. Errors throw std::system_error.
+ */
+class MappedFile {
+public:
+	enum class Access {
+		normal,     // No hint
+		sequential, // Aggressive readahead, pages can be freed soon after access
+		random,     // No readahead
+	};
+
+	MappedFile () = default;
+	explicit MappedFile (const std::string & path, Access access = Access::sequential);
+	~MappedFile ();
+
+	MappedFile (const MappedFile &) = delete;
+	MappedFile & operator= (const MappedFile &) = delete;
+	MappedFile (MappedFile && other) noexcept;
+	MappedFile & operator= (MappedFile && other) noexcept;
+
+	// Change the access pattern hint for the whole mapping (best effort, errors are ignored)
+	void advise (Access access) noexcept;
+
+	const char * data () const noexcept { return data_; }
+	std::size_t size () const noexcept { return size_; }
+	bool empty () const noexcept { return size_ == 0; }
+	const char * begin () const noexcept { return data_; }
+	const char * end () const noexcept { return data_ + size_; }
+
+	span<const char> bytes () const noexcept { return {data_, data_ + size_}; }
+	string_view text () const noexcept { return {data_, data_ + size_}; }
+
+private:
+	void unmap () noexcept;
+
+	const char * data_{nullptr};
+	std::size_t size_{0};
+};
+
+/********************************************************************************
+ * Lazy ranges on text, yielding string_view pointing into the text (no allocation).
+ * The text must outlive the ranges (MappedFile::text (), std::string, literals).
+ *
+ * fields (sep, text): parts between separators, same as split_range (sep, text).
+ *   Empty parts are kept ; n separators give n + 1 fields ; an empty text gives one empty field.
+ * lines (text): lines separated by '\n', without the '\n'.
+ *   A final '\n' does not start a new line ; an empty text has no lines. '\r' is not removed.
+ */
+inline lazy_split_range<Detail::CharDelimiter> fields (char separator, string_view text) {
+	return split_range (separator, text);
+}
+inline lazy_split_range<Detail::CharDelimiter> lines (string_view text) {
+	if (text.empty ())
+		return {Detail::CharDelimiter{'\n'}, text, false};
+	if (text[text.size () - 1] == '\n')
+		text = text.first (text.size () - 1);
+	return split_range ('\n', text);
+}
+
+/* records (bytes, record_size): consecutive fixed size records of a binary buffer, as string_view.
+ * Random access. An incomplete record at the end of bytes is not part of the range.
+ */
+class record_range {
+public:
+	class iterator {
+	public:
+		using iterator_category = std::random_access_iterator_tag;
+		using value_type = string_view;
+		using difference_type = std::ptrdiff_t;
+		using pointer = const string_view *;
+		using reference = string_view;
+
+		iterator () = default;
+		iterator (const char * record, std::ptrdiff_t record_size)
+		    : record_ (record), record_size_ (record_size) {}
+
+		// Input / output
+		iterator & operator++ () { return record_ += record_size_, *this; }
+		reference operator* () const { return {record_, record_ + record_size_}; }
+		bool operator== (const iterator & o) const { return record_ == o.record_; }
+		bool operator!= (const iterator & o) const { return record_ != o.record_; }
+
+		// Forward
+		iterator operator++ (int) {
+			iterator tmp (*this);
+			++*this;
+			return tmp;
+		}
+
+		// Bidir
+		iterator & operator-- () { return record_ -= record_size_, *this; }
+		iterator operator-- (int) {
+			iterator tmp (*this);
+			--*this;
+			return tmp;
+		}
+
+		// Random access
+		iterator & operator+= (difference_type n) { return record_ += n * record_size_, *this; }
+		iterator operator+ (difference_type n) const {
+			return iterator (record_ + n * record_size_, record_size_);
+		}
+		friend iterator operator+ (difference_type n, const iterator & it) { return it + n; }
+		iterator & operator-= (difference_type n) { return record_ -= n * record_size_, *this; }
+		iterator operator- (difference_type n) const {
+			return iterator (record_ - n * record_size_, record_size_);
+		}
+		difference_type operator- (const iterator & o) const {
+			return (record_ - o.record_) / record_size_;
+		}
+		reference operator[] (difference_type n) const { return *(*this + n); }
+		bool operator< (const iterator & o) const { return record_ < o.record_; }
+		bool operator> (const iterator & o) const { return record_ > o.record_; }
+		bool operator<= (const iterator & o) const { return record_ <= o.record_; }
+		bool operator>= (const iterator & o) const { return record_ >= o.record_; }
+
+	private:
+		const char * record_{nullptr};
+		std::ptrdiff_t record_size_{1};
+	};
+
+	record_range (span<const char> bytes, std::ptrdiff_t record_size)
+	    : base_ (bytes.data ()), record_size_ (record_size) {
+		assert (record_size > 0);
+		size_ = static_cast<std::ptrdiff_t> (bytes.size ()) / record_size;
+	}
+
+	iterator begin () const { return {base_, record_size_}; }
+	iterator end () const { return {base_ + size_ * record_size_, record_size_}; }
+	std::ptrdiff_t size () const { return size_; }
+	string_view operator[] (std::ptrdiff_t n) const { return begin ()[n]; }
+
+private:
+	const char * base_;
+	std::ptrdiff_t record_size_;
+	std::ptrdiff_t size_;
+};
+
+inline record_range records (span<const char> bytes, std::ptrdiff_t record_size) {
+	return {bytes, record_size};
+}
+} // namespace duck
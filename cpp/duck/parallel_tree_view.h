@@ -0,0 +1,242 @@
+#pragma once
+
+// Parallel tree algorithms, on the tree topologies of duck/tree_view.h.
+// STATUS: prototype
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <duck/execution.h>
+#include <duck/tree_view.h>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace duck {
+
+/* Level synchronous parallel traversal: call f (node) for each node of the tree, level by level.
+ * All nodes of a level are processed before the next level starts: f can use results computed
+ * for the fathers. Each level is split in blocks (see Detail::parallel_blocks) processed on the
+ * policy pool ; each block gathers the children of its nodes in its own buffer, and the buffers
+ * are concatenated in order to form the next level. Levels of at most grain nodes are processed
+ * serially by the caller. Buffers are reused between levels.
+ * f and the topology are called concurrently: they must be thread safe.
+ * The first exception thrown by f is rethrown at the end of its level.
+ */
+template <typename Topology, typename F>
+void level_order_for_each (const parallel_policy & policy, const Topology & tree, F f) {
+	static_assert (is_downward_tree_topology<Topology>::value,
+	               "level_order_for_each: Topology must be a tree topology");
+	using node_id = tree_node_id_t<Topology>;
+	auto root = tree.root_node ();
+	if (root == tree.invalid_node ())
+		return;
+	std::vector<node_id> level{root};
+	std::vector<node_id> next_level;
+	std::vector<std::vector<node_id>> block_children;
+	std::vector<std::size_t> offsets;
+	while (!level.empty ()) {
+		auto n = level.size ();
+		auto block_size = Detail::parallel_block_size (policy, n);
+		auto nb_blocks = Detail::parallel_nb_blocks (n, block_size);
+		if (block_children.size () < nb_blocks)
+			block_children.resize (nb_blocks);
+		Detail::parallel_blocks (
+		    policy, n, block_size,
+		    [&tree, &f, &level, &block_children](std::size_t b, std::size_t from, std::size_t to) {
+			    auto & children = block_children[b];
+			    children.clear ();
+			    for (auto i = from; i < to; ++i) {
+				    f (level[i]);
+				    Detail::for_each_child_node (
+				        tree, level[i], [&children](const node_id & child) { children.push_back (child); });
+			    }
+		    });
+		if (nb_blocks == 1) {
+			level.swap (block_children[0]);
+			continue;
+		}
+		offsets.assign (nb_blocks + 1, 0);
+		for (std::size_t b = 0; b < nb_blocks; ++b)
+			offsets[b + 1] = offsets[b] + block_children[b].size ();
+		next_level.resize (offsets[nb_blocks]);
+		Detail::parallel_chunks (
+		    policy.with_grain (1), nb_blocks,
+		    [&next_level, &block_children, &offsets](std::size_t first_block, std::size_t last_block) {
+			    for (auto b = first_block; b < last_block; ++b)
+				    std::copy (block_children[b].begin (), block_children[b].end (),
+				               next_level.begin () + static_cast<std::ptrdiff_t> (offsets[b]));
+		    });
+		level.swap (next_level);
+	}
+}
+
+namespace Detail {
+	/* Parallel reduction: a task reduces a subtree with tree_reduce_walk, stopping after grain
+	 * nodes. The walk is then split: expanded nodes of its stack (the current path) become frames
+	 * waiting for the results of their pending children, which are spawned as new tasks.
+	 * Big subtrees near the root are spawned first, so they are the ones stolen by idle workers.
+	 * The task completing the last child of a frame combines it, and so on up to the root: tasks
+	 * never wait for each other. Chains are not split (a single pending node), and are reduced
+	 * serially without recursion.
+	 * Walk stacks are scratch buffers reused by successive tasks (about one per worker).
+	 */
+	template <typename Topology, typename T, typename LeafFn, typename CombineFn>
+	class ParallelTreeReduce {
+	public:
+		using node_id = tree_node_id_t<Topology>;
+
+		ParallelTreeReduce (const Topology & tree, LeafFn & leaf_fn, CombineFn & combine_fn,
+		                    ThreadPool & pool, std::size_t grain)
+		    : tree_ (tree),
+		      leaf_fn_ (leaf_fn),
+		      combine_fn_ (combine_fn),
+		      grain_ (grain),
+		      group_ (pool) {}
+
+		T run (const node_id & root) {
+			reduce_subtree (root, nullptr, 0);
+			group_.wait ();
+			return std::move (result_);
+		}
+
+	private:
+		using Scratch = TreeReduceScratch<Topology, T>;
+
+		struct Frame {
+			node_id node;
+			std::shared_ptr<Frame> parent; // nullptr for the root
+			std::size_t slot;              // In parent results
+			std::size_t nb_children;
+			std::unique_ptr<T[]> results; // One per child
+			std::atomic<std::size_t> nb_pending;
+		};
+
+		// Scratch buffer lease, returned to the free list after the task
+		class ScratchLease {
+		public:
+			explicit ScratchLease (ParallelTreeReduce & reduce) : reduce_ (reduce) {
+				std::lock_guard<std::mutex> lock (reduce_.scratch_mutex_);
+				if (reduce_.free_scratch_.empty ()) {
+					scratch_.reset (new Scratch);
+				} else {
+					scratch_ = std::move (reduce_.free_scratch_.back ());
+					reduce_.free_scratch_.pop_back ();
+				}
+			}
+			~ScratchLease () {
+				std::lock_guard<std::mutex> lock (reduce_.scratch_mutex_);
+				reduce_.free_scratch_.push_back (std::move (scratch_));
+			}
+			ScratchLease (const ScratchLease &) = delete;
+			ScratchLease & operator= (const ScratchLease &) = delete;
+			Scratch & operator* () const { return *scratch_; }
+
+		private:
+			ParallelTreeReduce & reduce_;
+			std::unique_ptr<Scratch> scratch_;
+		};
+
+		void spawn_subtree (const node_id & node, std::shared_ptr<Frame> parent, std::size_t slot) {
+			group_.spawn ([this, node, parent, slot] { reduce_subtree (node, parent, slot); });
+		}
+
+		void reduce_subtree (const node_id & node, std::shared_ptr<Frame> parent, std::size_t slot) {
+			ScratchLease scratch (*this);
+			if (tree_reduce_walk (tree_, node, leaf_fn_, combine_fn_, *scratch, grain_)) {
+				deliver (std::move (parent), slot, std::move ((*scratch).results.back ()));
+			} else {
+				split (*scratch, std::move (parent), slot);
+			}
+		}
+
+		void split (Scratch & scratch, std::shared_ptr<Frame> parent, std::size_t slot) {
+			auto & stack = scratch.stack;
+			// Frames for expanded entries. Children of an expanded entry are the entries above it,
+			// up to the next expanded entry (included): their slots are the last ones, in reverse.
+			std::vector<std::pair<std::size_t, std::shared_ptr<Frame>>> frames; // Stack position, frame
+			for (std::size_t p = 0; p < stack.size (); ++p) {
+				if (!stack[p].expanded)
+					continue;
+				if (!frames.empty ()) {
+					auto father_position = frames.back ().first;
+					slot = stack[father_position].nb_children - (p - father_position);
+					parent = frames.back ().second;
+				}
+				auto frame = std::make_shared<Frame> ();
+				frame->node = stack[p].node;
+				frame->parent = std::move (parent);
+				frame->slot = slot;
+				frame->nb_children = stack[p].nb_children;
+				frame->results.reset (new T[stack[p].nb_children]);
+				frames.emplace_back (p, std::move (frame));
+			}
+			for (std::size_t i = 0; i < frames.size (); ++i) {
+				auto p = frames[i].first;
+				auto & frame = *frames[i].second;
+				auto end = i + 1 < frames.size () ? frames[i + 1].first + 1 : stack.size ();
+				auto nb_in_stack = end - p - 1;
+				auto nb_done = stack[p].nb_children - nb_in_stack;
+				auto done = scratch.results.begin () + static_cast<std::ptrdiff_t> (stack[p].results_base);
+				std::move (done, done + static_cast<std::ptrdiff_t> (nb_done), frame.results.get ());
+				frame.nb_pending.store (nb_in_stack, std::memory_order_relaxed);
+			}
+			// Spawn pending entries once all frames are set up
+			for (std::size_t i = 0; i < frames.size (); ++i) {
+				auto p = frames[i].first;
+				auto end = i + 1 < frames.size () ? frames[i + 1].first : stack.size ();
+				for (auto c = p + 1; c < end; ++c)
+					spawn_subtree (stack[c].node, frames[i].second, stack[p].nb_children - (c - p));
+			}
+		}
+
+		// Store the result of a subtree, and combine the frames it completes
+		void deliver (std::shared_ptr<Frame> frame, std::size_t slot, T value) {
+			while (frame != nullptr) {
+				frame->results[slot] = std::move (value);
+				if (frame->nb_pending.fetch_sub (1, std::memory_order_acq_rel) != 1)
+					return;
+				T acc = leaf_fn_ (frame->node);
+				for (std::size_t i = 0; i < frame->nb_children; ++i)
+					acc = combine_fn_ (std::move (acc), std::move (frame->results[i]));
+				value = std::move (acc);
+				slot = frame->slot;
+				auto parent = frame->parent;
+				frame = std::move (parent);
+			}
+			result_ = std::move (value);
+		}
+
+		const Topology & tree_;
+		LeafFn & leaf_fn_;
+		CombineFn & combine_fn_;
+		const std::size_t grain_;
+		T result_{};
+		std::mutex scratch_mutex_;
+		std::vector<std::unique_ptr<Scratch>> free_scratch_;
+		TaskGroup group_; // Last: waits for tasks before the destruction of other members
+	};
+} // namespace Detail
+
+/* Parallel tree_reduce on the policy pool: tasks reduce subtrees serially, and split their
+ * remaining work in new tasks after each grain nodes (see Detail::ParallelTreeReduce).
+ * leaf_fn, combine_fn and the topology are called concurrently: they must be thread safe.
+ * The combination order is the same as the serial version. The first exception thrown by
+ * leaf_fn or combine_fn is rethrown (after all running tasks are done).
+ */
+template <typename Topology, typename LeafFn, typename CombineFn>
+Detail::tree_reduce_result_t<Topology, LeafFn>
+tree_reduce (const parallel_policy & policy, const Topology & tree, LeafFn leaf_fn,
+             CombineFn combine_fn) {
+	static_assert (is_downward_tree_topology<Topology>::value,
+	               "tree_reduce: Topology must be a tree topology");
+	using T = Detail::tree_reduce_result_t<Topology, LeafFn>;
+	auto root = tree.root_node ();
+	if (root == tree.invalid_node ())
+		return T{};
+	Detail::ParallelTreeReduce<Topology, T, LeafFn, CombineFn> reduce (
+	    tree, leaf_fn, combine_fn, policy.pool (), policy.grain ());
+	return reduce.run (root);
+}
+} // namespace duck
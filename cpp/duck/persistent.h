@@ -0,0 +1,801 @@
+#pragma once
+
+// Persistent (immutable, structurally shared) vector and hash map.
+// STATUS: prototype
+
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <duck/frozen_ptr.h>
+#include <duck/type_traits.h>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace duck {
+
+namespace Detail {
+	/* Transient edit tokens.
+	 * Nodes created by a transient are tagged with its token, and can be modified in place by it.
+	 * Tokens are never reused, so nodes become immutable when the transient is made persistent.
+	 * 0 is the token of persistent operations (always copy).
+	 */
+	using EditToken = std::uint64_t;
+	constexpr EditToken persistent_edit = 0;
+	inline EditToken new_edit_token () {
+		static std::atomic<EditToken> next{1};
+		return next.fetch_add (1, std::memory_order_relaxed);
+	}
+
+	// Inline storage for up to N T values, which need not be default constructible.
+	template <typename T, std::size_t N> class InlineArray {
+	public:
+		InlineArray () = default;
+		InlineArray (const InlineArray & other) {
+			for (std::size_t i = 0; i < other.size (); ++i)
+				emplace_back (other[i]);
+		}
+		InlineArray & operator= (const InlineArray &) = delete;
+		~InlineArray () {
+			while (size_ > 0)
+				pop_back ();
+		}
+
+		std::size_t size () const noexcept { return size_; }
+		T & operator[] (std::size_t i) noexcept { return *reinterpret_cast<T *> (&storage_[i]); }
+		const T & operator[] (std::size_t i) const noexcept {
+			return *reinterpret_cast<const T *> (&storage_[i]);
+		}
+		template <typename... Args> void emplace_back (Args &&... args) {
+			assert (size_ < N);
+			::new (&storage_[size_]) T (std::forward<Args> (args)...);
+			++size_;
+		}
+		void pop_back () noexcept {
+			assert (size_ > 0);
+			--size_;
+			(*this)[size_].~T ();
+		}
+
+	private:
+		std::size_t size_{0};
+		aligned_storage_t<sizeof (T), alignof (T)> storage_[N];
+	};
+
+	// Get a mutable pointer to a node built as a FreezablePtr (legal, it was not created const).
+	template <typename Derived, typename Base> Derived * mutable_node (const FrozenPtr<Base> & p) {
+		return const_cast<Derived *> (static_cast<const Derived *> (p.get ()));
+	}
+} // namespace Detail
+
+template <typename T> class PersistentVector {
+	/* Immutable vector with structural sharing between versions.
+	 *
+	 * Implemented as a 32-way trie of FrozenPtr nodes, with a separate tail leaf (like Clojure).
+	 * Updates (push_back, set, pop_back) return a new vector in O(log32 n), sharing all untouched
+	 * nodes with the original. Copying a PersistentVector is O(1).
+	 *
+	 * For batches of updates, use a Transient (like a FreezablePtr for the whole vector):
+	 * it modifies in place the nodes it created, and is frozen back with persistent().
+	 *
+	 * T must be copyable: modifying a shared node copies it.
+	 */
+private:
+	static constexpr unsigned bits = 5;
+	static constexpr std::size_t width = std::size_t (1) << bits;
+	static constexpr std::size_t mask = width - 1;
+
+	struct Node {
+		Detail::EditToken edit;
+		explicit Node (Detail::EditToken e) noexcept : edit (e) {}
+	};
+	struct Branch : Node {
+		std::array<FrozenPtr<Node>, width> children;
+		explicit Branch (Detail::EditToken e) noexcept : Node (e) {}
+		Branch (const Branch & other, Detail::EditToken e) : Node (e), children (other.children) {}
+	};
+	struct Leaf : Node {
+		Detail::InlineArray<T, width> values;
+		explicit Leaf (Detail::EditToken e) noexcept : Node (e) {}
+		Leaf (const Leaf & other, Detail::EditToken e) : Node (e), values (other.values) {}
+	};
+	using NodePtr = FrozenPtr<Node>;
+
+public:
+	using value_type = T;
+	using size_type = std::size_t;
+	using difference_type = std::ptrdiff_t;
+	using reference = const T &;
+	using const_reference = const T &;
+	class Transient;
+
+	class const_iterator {
+	public:
+		using iterator_category = std::random_access_iterator_tag;
+		using value_type = T;
+		using difference_type = std::ptrdiff_t;
+		using pointer = const T *;
+		using reference = const T &;
+
+		const_iterator () = default;
+		const_iterator (const PersistentVector & v, size_type index) : vec_ (&v), index_ (index) {}
+
+		// Input / output
+		const_iterator & operator++ () noexcept { return ++index_, *this; }
+		reference operator* () const {
+			// Cache the current leaf, recomputed only when leaving it
+			if (leaf_ == nullptr || index_ - leaf_base_ >= width) {
+				leaf_ = vec_->leaf_for (index_);
+				leaf_base_ = index_ & ~mask;
+			}
+			return leaf_->values[index_ & mask];
+		}
+		pointer operator-> () const { return &**this; }
+		bool operator== (const const_iterator & o) const noexcept { return index_ == o.index_; }
+		bool operator!= (const const_iterator & o) const noexcept { return index_ != o.index_; }
+
+		// Forward
+		const_iterator operator++ (int) noexcept {
+			auto tmp = *this;
+			++*this;
+			return tmp;
+		}
+
+		// Bidir
+		const_iterator & operator-- () noexcept { return --index_, *this; }
+		const_iterator operator-- (int) noexcept {
+			auto tmp = *this;
+			--*this;
+			return tmp;
+		}
+
+		// Random access
+		const_iterator & operator+= (difference_type n) noexcept { return index_ += n, *this; }
+		const_iterator operator+ (difference_type n) const noexcept {
+			return const_iterator (*vec_, index_ + n);
+		}
+		friend const_iterator operator+ (difference_type n, const const_iterator & it) noexcept {
+			return it + n;
+		}
+		const_iterator & operator-= (difference_type n) noexcept { return index_ -= n, *this; }
+		const_iterator operator- (difference_type n) const noexcept {
+			return const_iterator (*vec_, index_ - n);
+		}
+		difference_type operator- (const const_iterator & o) const noexcept {
+			return static_cast<difference_type> (index_) - static_cast<difference_type> (o.index_);
+		}
+		reference operator[] (difference_type n) const { return (*vec_)[index_ + n]; }
+		bool operator< (const const_iterator & o) const noexcept { return index_ < o.index_; }
+		bool operator> (const const_iterator & o) const noexcept { return index_ > o.index_; }
+		bool operator<= (const const_iterator & o) const noexcept { return index_ <= o.index_; }
+		bool operator>= (const const_iterator & o) const noexcept { return index_ >= o.index_; }
+
+	private:
+		const PersistentVector * vec_{nullptr};
+		size_type index_{0};
+		mutable const Leaf * leaf_{nullptr};
+		mutable size_type leaf_base_{0};
+	};
+	using iterator = const_iterator;
+
+	PersistentVector () = default;
+	PersistentVector (std::initializer_list<T> ilist) {
+		auto t = transient ();
+		for (const auto & v : ilist)
+			t.push_back (v);
+		*this = std::move (t).persistent ();
+	}
+
+	// Access
+	bool empty () const noexcept { return size_ == 0; }
+	size_type size () const noexcept { return size_; }
+	const T & operator[] (size_type i) const { return leaf_for (i)->values[i & mask]; }
+	const T & at (size_type i) const {
+		if (i >= size_)
+			throw std::out_of_range{"at()"};
+		return (*this)[i];
+	}
+	const T & front () const { return (*this)[0]; }
+	const T & back () const { return (*this)[size_ - 1]; }
+
+	const_iterator begin () const { return {*this, 0}; }
+	const_iterator end () const { return {*this, size_}; }
+
+	// Updates, return a new version
+	PersistentVector push_back (T value) const {
+		auto v = *this;
+		v.push_back_impl (std::move (value), Detail::persistent_edit);
+		return v;
+	}
+	PersistentVector set (size_type i, T value) const {
+		assert (i < size_);
+		auto v = *this;
+		v.set_impl (i, std::move (value), Detail::persistent_edit);
+		return v;
+	}
+	PersistentVector pop_back () const {
+		assert (size_ > 0);
+		auto v = *this;
+		v.pop_back_impl (Detail::persistent_edit);
+		return v;
+	}
+
+	// Batch edits: start a transient (O(1), shares all nodes until modified)
+	Transient transient () const & { return Transient{*this}; }
+	Transient transient () && { return Transient{std::move (*this)}; }
+
+private:
+	// Index of the first element in the tail.
+	size_type tail_offset () const noexcept {
+		return size_ < width ? 0 : ((size_ - 1) >> bits) << bits;
+	}
+
+	const Leaf * leaf_for (size_type i) const {
+		assert (i < size_);
+		if (i >= tail_offset ())
+			return static_cast<const Leaf *> (tail_.get ());
+		const Node * node = root_.get ();
+		for (auto level = shift_; level > 0; level -= bits)
+			node = static_cast<const Branch *> (node)->children[(i >> level) & mask].get ();
+		return static_cast<const Leaf *> (node);
+	}
+
+	/* Node creation: copy, unless the node belongs to the current transient (edit).
+	 * Nodes are always built as FreezablePtr, then frozen: in place modification is legal.
+	 */
+	template <typename N, typename... Args> static NodePtr make_node (Args &&... args) {
+		return NodePtr{FreezablePtr<N>::make (std::forward<Args> (args)...).freeze ()};
+	}
+	template <typename N> static N * editable (NodePtr & node, Detail::EditToken edit) {
+		if (edit == Detail::persistent_edit || node->edit != edit)
+			node = make_node<N> (*static_cast<const N *> (node.get ()), edit);
+		return Detail::mutable_node<N> (node);
+	}
+
+	NodePtr new_path (unsigned level, NodePtr node, Detail::EditToken edit) const {
+		if (level == 0)
+			return node;
+		auto branch = make_node<Branch> (edit);
+		Detail::mutable_node<Branch> (branch)->children[0] =
+		    new_path (level - bits, std::move (node), edit);
+		return branch;
+	}
+
+	// Insert a full tail leaf in the trie, under parent at level.
+	NodePtr push_tail (unsigned level, NodePtr parent, NodePtr tail, Detail::EditToken edit) const {
+		auto sub_index = ((size_ - 1) >> level) & mask;
+		auto * branch = editable<Branch> (parent, edit);
+		auto & child = branch->children[sub_index];
+		if (level == bits)
+			child = std::move (tail);
+		else if (child)
+			child = push_tail (level - bits, child, std::move (tail), edit);
+		else
+			child = new_path (level - bits, std::move (tail), edit);
+		return parent;
+	}
+
+	void push_back_impl (T && value, Detail::EditToken edit) {
+		if (size_ - tail_offset () < width && tail_) {
+			// Room in tail
+			editable<Leaf> (tail_, edit)->values.emplace_back (std::move (value));
+		} else {
+			if (tail_) {
+				// Move full tail into trie
+				if ((size_ >> bits) > (size_type (1) << shift_)) {
+					// Root overflow: add a level
+					auto new_root = make_node<Branch> (edit);
+					auto * b = Detail::mutable_node<Branch> (new_root);
+					b->children[0] = std::move (root_);
+					b->children[1] = new_path (shift_, std::move (tail_), edit);
+					root_ = std::move (new_root);
+					shift_ += bits;
+				} else {
+					root_ = push_tail (shift_, std::move (root_), std::move (tail_), edit);
+				}
+			}
+			tail_ = make_node<Leaf> (edit);
+			Detail::mutable_node<Leaf> (tail_)->values.emplace_back (std::move (value));
+		}
+		++size_;
+	}
+
+	NodePtr set_in_trie (unsigned level, NodePtr node, size_type i, T && value,
+	                     Detail::EditToken edit) const {
+		if (level == 0) {
+			auto * leaf = editable<Leaf> (node, edit);
+			leaf->values[i & mask] = std::move (value);
+		} else {
+			auto * branch = editable<Branch> (node, edit);
+			auto & child = branch->children[(i >> level) & mask];
+			child = set_in_trie (level - bits, child, i, std::move (value), edit);
+		}
+		return node;
+	}
+	void set_impl (size_type i, T && value, Detail::EditToken edit) {
+		if (i >= tail_offset ())
+			editable<Leaf> (tail_, edit)->values[i & mask] = std::move (value);
+		else
+			root_ = set_in_trie (shift_, std::move (root_), i, std::move (value), edit);
+	}
+
+	// Remove the last leaf of the trie, returns null if the node becomes empty.
+	NodePtr pop_tail (unsigned level, NodePtr node, Detail::EditToken edit) const {
+		auto sub_index = ((size_ - 2) >> level) & mask;
+		if (level > bits) {
+			const auto & child = static_cast<const Branch *> (node.get ())->children[sub_index];
+			auto new_child = pop_tail (level - bits, child, edit);
+			if (!new_child && sub_index == 0)
+				return {};
+			editable<Branch> (node, edit)->children[sub_index] = std::move (new_child);
+			return node;
+		} else if (sub_index == 0) {
+			return {};
+		} else {
+			editable<Branch> (node, edit)->children[sub_index] = {};
+			return node;
+		}
+	}
+	void pop_back_impl (Detail::EditToken edit) {
+		if (size_ == 1) {
+			*this = PersistentVector{};
+			return;
+		}
+		if (size_ - tail_offset () > 1) {
+			editable<Leaf> (tail_, edit)->values.pop_back ();
+		} else {
+			// Tail becomes empty: last leaf of the trie becomes the tail
+			const NodePtr * new_tail = &root_;
+			for (auto level = shift_; level > 0; level -= bits) {
+				auto * branch = static_cast<const Branch *> (new_tail->get ());
+				new_tail = &branch->children[((size_ - 2) >> level) & mask];
+			}
+			auto new_tail_ptr = *new_tail;
+			root_ = pop_tail (shift_, std::move (root_), edit);
+			if (!root_)
+				root_ = empty_root ();
+			if (shift_ > bits && !static_cast<const Branch *> (root_.get ())->children[1]) {
+				// Remove a level
+				root_ = NodePtr{static_cast<const Branch *> (root_.get ())->children[0]};
+				shift_ -= bits;
+			}
+			tail_ = std::move (new_tail_ptr);
+		}
+		--size_;
+	}
+
+	// Empty vectors share the same empty root
+	static const NodePtr & empty_root () {
+		static const NodePtr root = make_node<Branch> (Detail::persistent_edit);
+		return root;
+	}
+
+	size_type size_{0};
+	unsigned shift_{bits};
+	NodePtr root_{empty_root ()};
+	NodePtr tail_;
+};
+
+template <typename T> class PersistentVector<T>::Transient {
+	/* Mutable version of a PersistentVector, for batch edits.
+	 * Like FreezablePtr: a unique owner which modifies in place, then persistent() freezes it.
+	 * Nodes shared with other versions are copied on first modification only.
+	 * Copy is disabled; a transient must not be used after persistent().
+	 */
+public:
+	Transient (const Transient &) = delete;
+	Transient & operator= (const Transient &) = delete;
+	Transient (Transient &&) = default;
+	Transient & operator= (Transient &&) = default;
+
+	size_type size () const noexcept { return vec_.size (); }
+	const T & operator[] (size_type i) const { return vec_[i]; }
+
+	Transient & push_back (T value) {
+		vec_.push_back_impl (std::move (value), edit_);
+		return *this;
+	}
+	Transient & set (size_type i, T value) {
+		assert (i < size ());
+		vec_.set_impl (i, std::move (value), edit_);
+		return *this;
+	}
+	Transient & pop_back () {
+		assert (size () > 0);
+		vec_.pop_back_impl (edit_);
+		return *this;
+	}
+
+	// Freeze: nodes become immutable as the edit token is never used again.
+	PersistentVector persistent () && { return std::move (vec_); }
+
+private:
+	friend class PersistentVector;
+	explicit Transient (PersistentVector v)
+	    : vec_ (std::move (v)), edit_ (Detail::new_edit_token ()) {}
+
+	PersistentVector vec_;
+	Detail::EditToken edit_;
+};
+namespace Detail {
+	inline unsigned popcount (std::uint32_t v) noexcept {
+#ifdef __GNUC__
+		return static_cast<unsigned> (__builtin_popcount (v));
+#else
+		unsigned n = 0;
+		for (; v != 0; v &= v - 1)
+			++n;
+		return n;
+#endif
+	}
+} // namespace Detail
+
+template <typename Key, typename T, typename Hash = std::hash<Key>,
+          typename KeyEqual = std::equal_to<Key>>
+class PersistentMap {
+	/* Immutable hash map with structural sharing between versions.
+	 *
+	 * Implemented as a hash array mapped trie (HAMT, CHAMP variant) of FrozenPtr nodes.
+	 * Each node uses 5 bits of the hash to select one of 32 slots, and has two bitmaps:
+	 * - datamap: slots storing a key / value entry inline.
+	 * - nodemap: slots pointing to a child node.
+	 * Entries and children are stored compactly (index = popcount of lower bits).
+	 * When all hash bits are used, nodes store colliding entries in a plain list.
+	 *
+	 * Updates (set, erase) return a new map in O(log32 n), sharing untouched nodes.
+	 * Batch edits use a Transient, like PersistentVector.
+	 * Key and T must be copyable: modifying a shared node copies it.
+	 */
+public:
+	using key_type = Key;
+	using mapped_type = T;
+	using value_type = std::pair<Key, T>;
+	using size_type = std::size_t;
+	class Transient;
+
+private:
+	static constexpr unsigned bits = 5;
+	static constexpr std::uint32_t mask = (std::uint32_t (1) << bits) - 1;
+	static constexpr unsigned hash_bits = sizeof (std::size_t) * 8;
+	static constexpr unsigned max_depth = hash_bits / bits + 2;
+
+	struct Node {
+		Detail::EditToken edit;
+		std::uint32_t datamap{0};
+		std::uint32_t nodemap{0};
+		std::vector<value_type> data;
+		std::vector<FrozenPtr<Node>> children;
+
+		explicit Node (Detail::EditToken e) noexcept : edit (e) {}
+		Node (const Node & other, Detail::EditToken e)
+		    : edit (e),
+		      datamap (other.datamap),
+		      nodemap (other.nodemap),
+		      data (other.data),
+		      children (other.children) {}
+	};
+	using NodePtr = FrozenPtr<Node>;
+
+	static std::uint32_t bit_for (std::size_t hash, unsigned shift) noexcept {
+		return std::uint32_t (1) << ((hash >> shift) & mask);
+	}
+	static std::size_t index_for (std::uint32_t map, std::uint32_t bit) noexcept {
+		return Detail::popcount (map & (bit - 1));
+	}
+
+public:
+	class const_iterator {
+		// Depth first walk: entries of a node, then its children.
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = PersistentMap::value_type;
+		using difference_type = std::ptrdiff_t;
+		using pointer = const value_type *;
+		using reference = const value_type &;
+
+		const_iterator () = default;
+
+		// Input / output
+		const_iterator & operator++ () {
+			++data_index_;
+			settle ();
+			return *this;
+		}
+		reference operator* () const { return stack_[depth_ - 1].node->data[data_index_]; }
+		pointer operator-> () const { return &**this; }
+		bool operator== (const const_iterator & o) const noexcept {
+			if (depth_ != o.depth_)
+				return false;
+			return depth_ == 0 ||
+			       (stack_[depth_ - 1].node == o.stack_[depth_ - 1].node && data_index_ == o.data_index_);
+		}
+		bool operator!= (const const_iterator & o) const noexcept { return !(*this == o); }
+
+		// Forward
+		const_iterator operator++ (int) {
+			auto tmp = *this;
+			++*this;
+			return tmp;
+		}
+
+	private:
+		friend class PersistentMap;
+		explicit const_iterator (const Node * root) {
+			stack_[0] = Frame{root, 0};
+			depth_ = 1;
+			settle ();
+		}
+
+		// Move to the next entry if the current position is past the end of a node data.
+		void settle () {
+			while (depth_ > 0) {
+				auto & top = stack_[depth_ - 1];
+				if (data_index_ < top.node->data.size ())
+					return;
+				if (top.next_child < top.node->children.size ()) {
+					auto * child = top.node->children[top.next_child++].get ();
+					stack_[depth_++] = Frame{child, 0};
+					data_index_ = 0;
+				} else {
+					--depth_;
+					if (depth_ > 0)
+						data_index_ = stack_[depth_ - 1].node->data.size ();
+				}
+			}
+		}
+
+		struct Frame {
+			const Node * node;
+			std::size_t next_child;
+		};
+		std::array<Frame, max_depth> stack_;
+		unsigned depth_{0}; // 0 is end
+		std::size_t data_index_{0};
+	};
+	using iterator = const_iterator;
+
+	explicit PersistentMap (const Hash & hash = Hash (), const KeyEqual & equal = KeyEqual ())
+	    : hash_ (hash), equal_ (equal) {}
+	PersistentMap (std::initializer_list<value_type> ilist) {
+		auto t = transient ();
+		for (const auto & kv : ilist)
+			t.set (kv.first, kv.second);
+		*this = std::move (t).persistent ();
+	}
+
+	// Access
+	bool empty () const noexcept { return size_ == 0; }
+	size_type size () const noexcept { return size_; }
+
+	// Returns a pointer to the value for key, or nullptr.
+	const T * find (const Key & key) const {
+		auto hash = hash_ (key);
+		const Node * node = root_.get ();
+		for (unsigned shift = 0; shift < hash_bits; shift += bits) {
+			auto bit = bit_for (hash, shift);
+			if (node->datamap & bit) {
+				const auto & kv = node->data[index_for (node->datamap, bit)];
+				return equal_ (kv.first, key) ? &kv.second : nullptr;
+			} else if (node->nodemap & bit) {
+				node = node->children[index_for (node->nodemap, bit)].get ();
+			} else {
+				return nullptr;
+			}
+		}
+		// Collision node
+		for (const auto & kv : node->data)
+			if (equal_ (kv.first, key))
+				return &kv.second;
+		return nullptr;
+	}
+	size_type count (const Key & key) const { return find (key) != nullptr ? 1 : 0; }
+	const T & at (const Key & key) const {
+		auto * v = find (key);
+		if (v == nullptr)
+			throw std::out_of_range{"at()"};
+		return *v;
+	}
+
+	const_iterator begin () const { return const_iterator{root_.get ()}; }
+	const_iterator end () const { return {}; }
+
+	// Updates, return a new version
+	PersistentMap set (Key key, T value) const {
+		auto m = *this;
+		m.set_impl (std::move (key), std::move (value), Detail::persistent_edit);
+		return m;
+	}
+	PersistentMap erase (const Key & key) const {
+		auto m = *this;
+		m.erase_impl (key, Detail::persistent_edit);
+		return m;
+	}
+
+	// Batch edits
+	Transient transient () const & { return Transient{*this}; }
+	Transient transient () && { return Transient{std::move (*this)}; }
+
+private:
+	static NodePtr make_node (Detail::EditToken edit) {
+		return NodePtr{FreezablePtr<Node>::make (edit).freeze ()};
+	}
+	static Node * editable (NodePtr & node, Detail::EditToken edit) {
+		if (edit == Detail::persistent_edit || node->edit != edit)
+			node = NodePtr{FreezablePtr<Node>::make (*node, edit).freeze ()};
+		return Detail::mutable_node<Node> (node);
+	}
+	static const NodePtr & empty_root () {
+		static const NodePtr root = make_node (Detail::persistent_edit);
+		return root;
+	}
+
+	// Build a subtree containing two entries with different keys.
+	NodePtr merge (value_type a, std::size_t a_hash, value_type b, std::size_t b_hash, unsigned shift,
+	               Detail::EditToken edit) const {
+		auto node = make_node (edit);
+		auto * n = Detail::mutable_node<Node> (node);
+		if (shift >= hash_bits) {
+			n->data.push_back (std::move (a));
+			n->data.push_back (std::move (b));
+			return node;
+		}
+		auto a_bit = bit_for (a_hash, shift);
+		auto b_bit = bit_for (b_hash, shift);
+		if (a_bit != b_bit) {
+			n->datamap = a_bit | b_bit;
+			if (a_bit > b_bit)
+				std::swap (a, b);
+			n->data.push_back (std::move (a));
+			n->data.push_back (std::move (b));
+		} else {
+			n->nodemap = a_bit;
+			n->children.push_back (
+			    merge (std::move (a), a_hash, std::move (b), b_hash, shift + bits, edit));
+		}
+		return node;
+	}
+
+	// Returns true if a new entry was added, false if an existing value was replaced.
+	bool set_in (NodePtr & node, unsigned shift, std::size_t hash, Key && key, T && value,
+	             Detail::EditToken edit) const {
+		if (shift >= hash_bits) {
+			// Collision node
+			for (std::size_t i = 0; i < node->data.size (); ++i) {
+				if (equal_ (node->data[i].first, key)) {
+					editable (node, edit)->data[i].second = std::move (value);
+					return false;
+				}
+			}
+			editable (node, edit)->data.emplace_back (std::move (key), std::move (value));
+			return true;
+		}
+		auto bit = bit_for (hash, shift);
+		if (node->datamap & bit) {
+			auto i = index_for (node->datamap, bit);
+			const auto & existing = node->data[i];
+			if (equal_ (existing.first, key)) {
+				editable (node, edit)->data[i].second = std::move (value);
+				return false;
+			}
+			// Different key in slot: push both in a sub node
+			auto sub = merge (existing, hash_ (existing.first),
+			                  value_type (std::move (key), std::move (value)), hash, shift + bits, edit);
+			auto * n = editable (node, edit);
+			n->data.erase (n->data.begin () + i);
+			n->datamap ^= bit;
+			n->nodemap |= bit;
+			n->children.insert (n->children.begin () + index_for (n->nodemap, bit), std::move (sub));
+			return true;
+		} else if (node->nodemap & bit) {
+			auto i = index_for (node->nodemap, bit);
+			auto child = node->children[i];
+			auto added = set_in (child, shift + bits, hash, std::move (key), std::move (value), edit);
+			editable (node, edit)->children[i] = std::move (child);
+			return added;
+		} else {
+			auto * n = editable (node, edit);
+			n->data.insert (n->data.begin () + index_for (n->datamap, bit),
+			                value_type (std::move (key), std::move (value)));
+			n->datamap |= bit;
+			return true;
+		}
+	}
+	void set_impl (Key && key, T && value, Detail::EditToken edit) {
+		auto hash = hash_ (key);
+		if (set_in (root_, 0, hash, std::move (key), std::move (value), edit))
+			++size_;
+	}
+
+	// Returns true if the entry was removed.
+	bool erase_in (NodePtr & node, unsigned shift, std::size_t hash, const Key & key,
+	               Detail::EditToken edit) const {
+		if (shift >= hash_bits) {
+			for (std::size_t i = 0; i < node->data.size (); ++i) {
+				if (equal_ (node->data[i].first, key)) {
+					auto * n = editable (node, edit);
+					n->data.erase (n->data.begin () + i);
+					return true;
+				}
+			}
+			return false;
+		}
+		auto bit = bit_for (hash, shift);
+		if (node->datamap & bit) {
+			auto i = index_for (node->datamap, bit);
+			if (!equal_ (node->data[i].first, key))
+				return false;
+			auto * n = editable (node, edit);
+			n->data.erase (n->data.begin () + i);
+			n->datamap ^= bit;
+			return true;
+		} else if (node->nodemap & bit) {
+			auto i = index_for (node->nodemap, bit);
+			auto child = node->children[i];
+			if (!erase_in (child, shift + bits, hash, key, edit))
+				return false;
+			auto * n = editable (node, edit);
+			if (child->children.empty () && child->data.size () == 1) {
+				// Canonical form: a sub node with one entry is inlined in its parent
+				n->children.erase (n->children.begin () + i);
+				n->nodemap ^= bit;
+				n->data.insert (n->data.begin () + index_for (n->datamap, bit), child->data.front ());
+				n->datamap |= bit;
+			} else {
+				n->children[i] = std::move (child);
+			}
+			return true;
+		} else {
+			return false;
+		}
+	}
+	void erase_impl (const Key & key, Detail::EditToken edit) {
+		if (erase_in (root_, 0, hash_ (key), key, edit))
+			--size_;
+	}
+
+	size_type size_{0};
+	NodePtr root_{empty_root ()};
+	Hash hash_;
+	KeyEqual equal_;
+};
+
+template <typename Key, typename T, typename Hash, typename KeyEqual>
+class PersistentMap<Key, T, Hash, KeyEqual>::Transient {
+	/* Mutable version of a PersistentMap, for batch edits.
+	 * Same contract as PersistentVector::Transient.
+	 */
+public:
+	Transient (const Transient &) = delete;
+	Transient & operator= (const Transient &) = delete;
+	Transient (Transient &&) = default;
+	Transient & operator= (Transient &&) = default;
+
+	size_type size () const noexcept { return map_.size (); }
+	const T * find (const Key & key) const { return map_.find (key); }
+
+	Transient & set (Key key, T value) {
+		map_.set_impl (std::move (key), std::move (value), edit_);
+		return *this;
+	}
+	Transient & erase (const Key & key) {
+		map_.erase_impl (key, edit_);
+		return *this;
+	}
+
+	PersistentMap persistent () && { return std::move (map_); }
+
+private:
+	friend class PersistentMap;
+	explicit Transient (PersistentMap m)
+	    : map_ (std::move (m)), edit_ (Detail::new_edit_token ()) {}
+
+	PersistentMap map_;
+	Detail::EditToken edit_;
+};
+} // namespace duck
@@ -1,58 +1,371 @@
 #pragma once
 
 // Overloads of <algorithm> functions to accept range arguments instead of iterator pairs.
+// Overloads taking an execution policy are in duck/range/parallel_algorithm.h.
 // STATUS: WIP (missing part of <algorithm>), NSC
 
 #include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <duck/range/range.h>
+#include <duck/simd.h>
+#include <functional>
+#include <iterator>
+#include <vector>
 
 namespace duck {
 
 // non modifying sequence operations
 
+/* pure_predicate (p): p without side effects, that all_of, any_of and none_of may call on more
+ * elements than needed. Other predicates are called in order, up to the first conclusive element.
+ */
+template <typename Predicate> struct pure_predicate_t {
+	Predicate predicate;
+	template <typename T> bool operator() (const T & t) const { return predicate (t); }
+};
+template <typename Predicate> pure_predicate_t<decay_t<Predicate>> pure_predicate (Predicate && p) {
+	return {std::forward<Predicate> (p)};
+}
+
+/* Implementation selection:
+ * - contiguous ranges of arithmetic values (std::vector, span, SmallVector, arrays) use the SIMD
+ *   kernels of duck/simd.h for find, count, mismatch, equal, min_element, max_element, and for
+ *   all_of, any_of and none_of with a pure_predicate.
+ * - segmented ranges (duck::join, see duck::is_segmented_range) run all_of, any_of, none_of,
+ *   for_each, count, count_if, find and find_if on each segment, selecting the implementation for
+ *   the segment type.
+ * - ranges with a push method (filter / map chains, see duck::push_each) run for_each, count and
+ *   predicate checks with internal iteration: one fused loop instead of nested iterators.
+ * - other ranges use the <algorithm> function on iterators.
+ */
+namespace internal_range {
+	struct simd_path {};
+	struct segmented_path {};
+	struct push_path {};
+	struct iterator_path {};
+
+	template <typename R>
+	using range_value_t = iterator_value_type_t<range_iterator_t<const R &>>;
+	template <typename R>
+	using is_simd_range = bool_constant<is_contiguous_range<const R &>::value &&
+	                                    Detail::is_simd_type<range_value_t<R>>::value>;
+	template <typename R>
+	using algorithm_path_t = conditional_t<
+	    is_simd_range<R>::value, simd_path,
+	    conditional_t<is_segmented_range<const R &>::value, segmented_path,
+	                  conditional_t<has_push_method<const R &>::value, push_path, iterator_path>>>;
+	// SIMD predicate checks evaluate blocks of elements: only for pure predicates
+	template <typename P> struct is_pure_predicate : std::false_type {};
+	template <typename P> struct is_pure_predicate<pure_predicate_t<P>> : std::true_type {};
+	template <typename R, typename P>
+	using predicate_path_t =
+	    conditional_t<is_simd_range<R>::value && !is_pure_predicate<P>::value, iterator_path,
+	                  algorithm_path_t<R>>;
+	// Searches return an iterator: no push path
+	template <typename R>
+	using find_path_t =
+	    conditional_t<is_simd_range<R>::value, simd_path,
+	                  conditional_t<is_segmented_range<const R &>::value, segmented_path,
+	                                iterator_path>>;
+
+	// Type of segments of a segmented range
+	template <typename R>
+	using segment_t = remove_cvref_t<
+	    iterator_reference_t<range_iterator_t<decltype (std::declval<const R &> ().segments ())>>>;
+
+	template <typename R> std::size_t simd_size (const R & r) {
+		return static_cast<std::size_t> (size (r));
+	}
+
+	template <typename R, typename UnaryPredicate>
+	bool all_of_impl (const R & r, UnaryPredicate & p, simd_path) {
+		return Detail::simd_all_of (duck::data (r), simd_size (r), p);
+	}
+	template <typename R, typename UnaryPredicate>
+	bool all_of_impl (const R & r, UnaryPredicate & p, push_path) {
+		return push_each (r, [&p](auto && v) { return static_cast<bool> (p (v)); });
+	}
+	template <typename R, typename UnaryPredicate>
+	bool all_of_impl (const R & r, UnaryPredicate & p, iterator_path) {
+		return std::all_of (begin (r), end (r), p);
+	}
+	template <typename R, typename UnaryPredicate>
+	bool all_of_impl (const R & r, UnaryPredicate & p, segmented_path) {
+		for (auto && segment : r.segments ())
+			if (!all_of_impl (segment, p, predicate_path_t<segment_t<R>, UnaryPredicate>{}))
+				return false;
+		return true;
+	}
+	template <typename R, typename UnaryPredicate>
+	bool any_of_impl (const R & r, UnaryPredicate & p, simd_path) {
+		auto not_p = [&p](const range_value_t<R> & v) { return !p (v); };
+		return !Detail::simd_all_of (duck::data (r), simd_size (r), not_p);
+	}
+	template <typename R, typename UnaryPredicate>
+	bool any_of_impl (const R & r, UnaryPredicate & p, push_path) {
+		return !push_each (r, [&p](auto && v) { return !p (v); });
+	}
+	template <typename R, typename UnaryPredicate>
+	bool any_of_impl (const R & r, UnaryPredicate & p, iterator_path) {
+		return std::any_of (begin (r), end (r), p);
+	}
+	template <typename R, typename UnaryPredicate>
+	bool any_of_impl (const R & r, UnaryPredicate & p, segmented_path) {
+		for (auto && segment : r.segments ())
+			if (any_of_impl (segment, p, predicate_path_t<segment_t<R>, UnaryPredicate>{}))
+				return true;
+		return false;
+	}
+
+	template <typename R, typename UnaryFunction>
+	void for_each_impl (const R & r, UnaryFunction & f, push_path) {
+		push_each (r, [&f](auto && v) {
+			f (std::forward<decltype (v)> (v));
+			return true;
+		});
+	}
+	template <typename R, typename UnaryFunction, typename Path>
+	void for_each_impl (const R & r, UnaryFunction & f, Path) {
+		std::for_each (begin (r), end (r), f);
+	}
+	template <typename R, typename UnaryFunction>
+	void for_each_impl (const R & r, UnaryFunction & f, segmented_path) {
+		for (auto && segment : r.segments ())
+			for_each_impl (segment, f, algorithm_path_t<segment_t<R>>{});
+	}
+
+	template <typename R, typename T>
+	iterator_difference_t<range_iterator_t<const R &>> count_impl (const R & r, const T & value,
+	                                                               simd_path) {
+		range_value_t<R> converted;
+		if (Detail::simd_convert_value (value, converted))
+			return static_cast<iterator_difference_t<range_iterator_t<const R &>>> (
+			    Detail::simd_count (duck::data (r), simd_size (r), converted));
+		return std::count (begin (r), end (r), value);
+	}
+	template <typename R, typename T>
+	iterator_difference_t<range_iterator_t<const R &>> count_impl (const R & r, const T & value,
+	                                                               push_path) {
+		iterator_difference_t<range_iterator_t<const R &>> n = 0;
+		push_each (r, [&value, &n](const auto & v) {
+			if (v == value)
+				++n;
+			return true;
+		});
+		return n;
+	}
+	template <typename R, typename T>
+	iterator_difference_t<range_iterator_t<const R &>> count_impl (const R & r, const T & value,
+	                                                               iterator_path) {
+		return std::count (begin (r), end (r), value);
+	}
+	template <typename R, typename T>
+	iterator_difference_t<range_iterator_t<const R &>> count_impl (const R & r, const T & value,
+	                                                               segmented_path) {
+		iterator_difference_t<range_iterator_t<const R &>> n = 0;
+		for (auto && segment : r.segments ())
+			n += count_impl (segment, value, algorithm_path_t<segment_t<R>>{});
+		return n;
+	}
+	template <typename R, typename UnaryPredicate>
+	iterator_difference_t<range_iterator_t<const R &>> count_if_impl (const R & r,
+	                                                                  UnaryPredicate & p,
+	                                                                  push_path) {
+		iterator_difference_t<range_iterator_t<const R &>> n = 0;
+		push_each (r, [&p, &n](auto && v) {
+			if (p (v))
+				++n;
+			return true;
+		});
+		return n;
+	}
+	template <typename R, typename UnaryPredicate, typename Path>
+	iterator_difference_t<range_iterator_t<const R &>> count_if_impl (const R & r,
+	                                                                  UnaryPredicate & p, Path) {
+		return std::count_if (begin (r), end (r), p);
+	}
+	template <typename R, typename UnaryPredicate>
+	iterator_difference_t<range_iterator_t<const R &>> count_if_impl (const R & r,
+	                                                                  UnaryPredicate & p,
+	                                                                  segmented_path) {
+		iterator_difference_t<range_iterator_t<const R &>> n = 0;
+		for (auto && segment : r.segments ())
+			n += count_if_impl (segment, p, algorithm_path_t<segment_t<R>>{});
+		return n;
+	}
+
+	template <typename R, typename T>
+	range_iterator_t<const R &> find_impl (const R & r, const T & value, simd_path) {
+		range_value_t<R> converted;
+		if (Detail::simd_convert_value (value, converted))
+			return begin (r) + static_cast<iterator_difference_t<range_iterator_t<const R &>>> (
+			                       Detail::simd_find (duck::data (r), simd_size (r), converted));
+		return std::find (begin (r), end (r), value);
+	}
+	template <typename R, typename T>
+	range_iterator_t<const R &> find_impl (const R & r, const T & value, iterator_path) {
+		return std::find (begin (r), end (r), value);
+	}
+	template <typename R, typename UnaryPredicate, typename Path>
+	range_iterator_t<const R &> find_if_impl (const R & r, UnaryPredicate & p, Path) {
+		return std::find_if (begin (r), end (r), p);
+	}
+
+	// Search in a segment, returning an iterator of the segment (mutable if the segment is).
+	template <typename S, typename T>
+	range_iterator_t<S &> segment_find (S & segment, const T & value, simd_path) {
+		const S & const_segment = segment;
+		return begin (segment) +
+		       (find_impl (const_segment, value, simd_path{}) - begin (const_segment));
+	}
+	template <typename S, typename T>
+	range_iterator_t<S &> segment_find (S & segment, const T & value, segmented_path) {
+		return find_impl (segment, value, segmented_path{});
+	}
+	template <typename S, typename T>
+	range_iterator_t<S &> segment_find (S & segment, const T & value, iterator_path) {
+		return std::find (begin (segment), end (segment), value);
+	}
+	template <typename S, typename UnaryPredicate>
+	range_iterator_t<S &> segment_find_if (S & segment, UnaryPredicate & p, segmented_path) {
+		return find_if_impl (segment, p, segmented_path{});
+	}
+	template <typename S, typename UnaryPredicate, typename Path>
+	range_iterator_t<S &> segment_find_if (S & segment, UnaryPredicate & p, Path) {
+		return std::find_if (begin (segment), end (segment), p);
+	}
+
+	// Search segments in order, and convert the first match to an iterator of r.
+	template <typename R, typename FindInSegment>
+	range_iterator_t<const R &> find_in_segments (const R & r, FindInSegment find_in_segment) {
+		auto && segments = r.segments ();
+		for (auto it = begin (segments); it != end (segments); ++it) {
+			auto && segment = *it;
+			auto found = find_in_segment (segment);
+			if (found != end (segment))
+				return r.make_iterator (it, found);
+		}
+		return end (r);
+	}
+	template <typename R, typename T>
+	range_iterator_t<const R &> find_impl (const R & r, const T & value, segmented_path) {
+		return find_in_segments (r, [&value](auto & segment) {
+			return segment_find (segment, value, find_path_t<segment_t<R>>{});
+		});
+	}
+	template <typename R, typename UnaryPredicate>
+	range_iterator_t<const R &> find_if_impl (const R & r, UnaryPredicate & p, segmented_path) {
+		return find_in_segments (r, [&p](auto & segment) {
+			return segment_find_if (segment, p, find_path_t<segment_t<R>>{});
+		});
+	}
+
+	// SIMD mismatch between r and [it, ...) if it is a pointer to elements of the same type.
+	template <typename R, typename InputIt>
+	using is_simd_mismatch =
+	    bool_constant<is_simd_range<R>::value && std::is_pointer<InputIt>::value &&
+	                  std::is_same<remove_cv_t<remove_pointer_t<InputIt>>, range_value_t<R>>::value>;
+	template <typename R, typename InputIt>
+	std::pair<range_iterator_t<const R &>, InputIt> mismatch_impl (const R & r, InputIt it,
+	                                                               std::true_type /*simd*/) {
+		auto n = Detail::simd_mismatch (duck::data (r), it, simd_size (r));
+		auto offset = static_cast<iterator_difference_t<range_iterator_t<const R &>>> (n);
+		return {begin (r) + offset, it + offset};
+	}
+	template <typename R, typename InputIt>
+	std::pair<range_iterator_t<const R &>, InputIt> mismatch_impl (const R & r, InputIt it,
+	                                                               std::false_type) {
+		return std::mismatch (begin (r), end (r), it);
+	}
+
+	// SIMD mismatch between r and r2 if both are contiguous ranges of the same arithmetic type.
+	template <typename R1, typename R2>
+	using is_simd_range_mismatch =
+	    bool_constant<is_simd_range<R1>::value && is_simd_range<R2>::value &&
+	                  std::is_same<range_value_t<R1>, range_value_t<R2>>::value>;
+	template <typename R1, typename R2>
+	std::pair<range_iterator_t<const R1 &>, range_iterator_t<const R2 &>>
+	range_mismatch_impl (const R1 & r, const R2 & r2, std::true_type /*simd*/) {
+		auto n = Detail::simd_mismatch (duck::data (r), duck::data (r2),
+		                                std::min (simd_size (r), simd_size (r2)));
+		return {begin (r) + static_cast<iterator_difference_t<range_iterator_t<const R1 &>>> (n),
+		        begin (r2) + static_cast<iterator_difference_t<range_iterator_t<const R2 &>>> (n)};
+	}
+	template <typename R1, typename R2>
+	std::pair<range_iterator_t<const R1 &>, range_iterator_t<const R2 &>>
+	range_mismatch_impl (const R1 & r, const R2 & r2, std::false_type) {
+		return std::mismatch (begin (r), end (r), begin (r2), end (r2));
+	}
+	template <typename T>
+	bool equal_impl (const T * a, const T * b, std::size_t n, std::true_type /*integral*/) {
+		return std::memcmp (a, b, n * sizeof (T)) == 0; // Faster than SIMD mismatch
+	}
+	template <typename T>
+	bool equal_impl (const T * a, const T * b, std::size_t n, std::false_type) {
+		return Detail::simd_mismatch (a, b, n) == n;
+	}
+	template <typename R1, typename R2>
+	bool equal_impl (const R1 & r, const R2 & r2, std::true_type /*simd*/) {
+		auto n = simd_size (r);
+		if (n != simd_size (r2))
+			return false;
+		return equal_impl (duck::data (r), duck::data (r2), n,
+		                   std::is_integral<range_value_t<R1>>{});
+	}
+	template <typename R1, typename R2>
+	bool equal_impl (const R1 & r, const R2 & r2, std::false_type) {
+		return std::equal (begin (r), end (r), begin (r2), end (r2));
+	}
+} // namespace internal_range
+
 template <typename R, typename UnaryPredicate, typename = enable_if_t<is_range<const R &>::value>>
 bool all_of (const R & r, UnaryPredicate p) {
-	return std::all_of (begin (r), end (r), p);
+	return internal_range::all_of_impl (
+	    r, p, internal_range::predicate_path_t<R, UnaryPredicate>{});
 }
 template <typename R, typename UnaryPredicate, typename = enable_if_t<is_range<const R &>::value>>
 bool none_of (const R & r, UnaryPredicate p) {
-	return std::none_of (begin (r), end (r), p);
+	return !internal_range::any_of_impl (
+	    r, p, internal_range::predicate_path_t<R, UnaryPredicate>{});
 }
 template <typename R, typename UnaryPredicate, typename = enable_if_t<is_range<const R &>::value>>
 bool any_of (const R & r, UnaryPredicate p) {
-	return std::any_of (begin (r), end (r), p);
+	return internal_range::any_of_impl (
+	    r, p, internal_range::predicate_path_t<R, UnaryPredicate>{});
 }
 
 template <typename R, typename UnaryFunction, typename = enable_if_t<is_range<const R &>::value>>
 void for_each (const R & r, UnaryFunction f) {
-	std::for_each (begin (r), end (r), f);
+	internal_range::for_each_impl (r, f, internal_range::algorithm_path_t<R>{});
 }
 
 template <typename R, typename T, typename = enable_if_t<is_range<const R &>::value>>
 iterator_difference_t<range_iterator_t<const R>> count (const R & r, const T & value) {
-	return std::count (begin (r), end (r), value);
+	return internal_range::count_impl (r, value, internal_range::algorithm_path_t<R>{});
 }
 template <typename R, typename UnaryPredicate, typename = enable_if_t<is_range<const R &>::value>>
 iterator_difference_t<range_iterator_t<const R>> count_if (const R & r, UnaryPredicate p) {
-	return std::count_if (begin (r), end (r), p);
+	return internal_range::count_if_impl (r, p, internal_range::algorithm_path_t<R>{});
 }
 
-template <typename R, typename InputIt, typename = enable_if_t<is_range<const R &>::value>>
+template <typename R, typename InputIt,
+          typename = enable_if_t<is_range<const R &>::value && is_iterator<InputIt>::value>>
 std::pair<range_iterator_t<const R>, InputIt> mismatch (const R & r, InputIt it) {
-	return std::mismatch (begin (r), end (r), it);
+	return internal_range::mismatch_impl (r, it, internal_range::is_simd_mismatch<R, InputIt>{});
 }
 template <typename R, typename InputIt, typename BinaryPredicate,
-          typename = enable_if_t<is_range<const R &>::value>>
+          typename = enable_if_t<is_range<const R &>::value && is_iterator<InputIt>::value>>
 std::pair<range_iterator_t<const R>, InputIt> mismatch (const R & r, InputIt it,
                                                         BinaryPredicate p) {
 	return std::mismatch (begin (r), end (r), it, p);
 }
-#if __cpluplus >= 201402L
 template <typename R1, typename R2,
           typename = enable_if_t<is_range<const R1 &>::value && is_range<const R2 &>::value>>
 std::pair<range_iterator_t<const R1>, range_iterator_t<const R2>> mismatch (const R1 & r,
                                                                             const R2 & r2) {
-	return std::mismatch (begin (r), end (r), begin (r2), end (r2));
+	return internal_range::range_mismatch_impl (r, r2,
+	                                            internal_range::is_simd_range_mismatch<R1, R2>{});
 }
 template <typename R1, typename R2, typename BinaryPredicate,
           typename = enable_if_t<is_range<const R1 &>::value && is_range<const R2 &>::value>>
@@ -60,37 +373,35 @@ std::pair<range_iterator_t<const R1>, range_iterator_t<const R2>>
 mismatch (const R1 & r, const R2 & r2, BinaryPredicate p) {
 	return std::mismatch (begin (r), end (r), begin (r2), end (r2), p);
 }
-#endif
 
-template <typename R, typename InputIt, typename = enable_if_t<is_range<const R &>::value>>
+template <typename R, typename InputIt,
+          typename = enable_if_t<is_range<const R &>::value && is_iterator<InputIt>::value>>
 bool equal (const R & r, InputIt it) {
-	return std::equal (begin (r), end (r), it);
+	return duck::mismatch (r, it).first == end (r);
 }
 template <typename R, typename InputIt, typename BinaryPredicate,
-          typename = enable_if_t<is_range<const R &>::value>>
+          typename = enable_if_t<is_range<const R &>::value && is_iterator<InputIt>::value>>
 bool equal (const R & r, InputIt it, BinaryPredicate p) {
 	return std::equal (begin (r), end (r), it, p);
 }
-#if __cpluplus >= 201402L
 template <typename R1, typename R2,
           typename = enable_if_t<is_range<const R1 &>::value && is_range<const R2 &>::value>>
 bool equal (const R1 & r, const R2 & r2) {
-	return std::equal (begin (r), end (r), begin (r2), end (r2));
+	return internal_range::equal_impl (r, r2, internal_range::is_simd_range_mismatch<R1, R2>{});
 }
 template <typename R1, typename R2, typename BinaryPredicate,
           typename = enable_if_t<is_range<const R1 &>::value && is_range<const R2 &>::value>>
 bool equal (const R1 & r, const R2 & r2, BinaryPredicate p) {
 	return std::equal (begin (r), end (r), begin (r2), end (r2), p);
 }
-#endif
 
 template <typename R, typename T, typename = enable_if_t<is_range<const R &>::value>>
 range_iterator_t<const R> find (const R & r, const T & value) {
-	return std::find (begin (r), end (r), value);
+	return internal_range::find_impl (r, value, internal_range::find_path_t<R>{});
 }
 template <typename R, typename UnaryPredicate, typename = enable_if_t<is_range<const R &>::value>>
 range_iterator_t<const R> find_if (const R & r, UnaryPredicate p) {
-	return std::find_if (begin (r), end (r), p);
+	return internal_range::find_if_impl (r, p, internal_range::find_path_t<R>{});
 }
 template <typename R, typename UnaryPredicate, typename = enable_if_t<is_range<const R &>::value>>
 range_iterator_t<const R> find_if_not (const R & r, UnaryPredicate p) {
@@ -149,5 +460,281 @@ range_iterator_t<const R> search_n (const R & r, Size count, const T & value, Bi
 	return std::search_n (begin (r), end (r), count, value, p);
 }
 
+// sorting operations
+
+/* Sorting functions take mutable random access ranges (containers, span, slices...).
+ *
+ * radix_sort (r[, key]): stable LSD radix sort, on keys of integral or floating point type of up to
+ * 8 bytes (key (value) defaults to the value itself).
+ * Keys are ordered like operator< (floats: -0.0 before +0.0, and NaN at an end depending on sign).
+ * One histogram pass, then one scatter pass per key byte, skipping bytes equal for all keys.
+ * Uses a buffer of n values: values must be default constructible and movable.
+ * key is called multiple times per value, and should be a cheap projection (member access...).
+ *
+ * sort (r) uses radix_sort on contiguous ranges of arithmetic values (with at least 256 elements
+ * per key byte), and std::sort otherwise. stable_sort (r) does the same for
+ * integers, and uses std::stable_sort otherwise.
+ */
+namespace internal_range {
+	template <std::size_t Size> struct unsigned_of_size;
+	template <> struct unsigned_of_size<1> { using type = std::uint8_t; };
+	template <> struct unsigned_of_size<2> { using type = std::uint16_t; };
+	template <> struct unsigned_of_size<4> { using type = std::uint32_t; };
+	template <> struct unsigned_of_size<8> { using type = std::uint64_t; };
+
+	template <typename K>
+	using is_radix_key =
+	    bool_constant<(std::is_integral<K>::value || std::is_floating_point<K>::value) &&
+	                  !std::is_same<K, bool>::value &&
+	                  (sizeof (K) == 1 || sizeof (K) == 2 || sizeof (K) == 4 || sizeof (K) == 8)>;
+	template <typename K> using radix_bits_t = typename unsigned_of_size<sizeof (K)>::type;
+
+	// Unsigned integer with the same ordering as the key
+	template <typename K> radix_bits_t<K> radix_bits (K key, std::true_type /*integral*/) {
+		using U = radix_bits_t<K>;
+		constexpr U sign_flip = std::is_signed<K>::value ? U (U (1) << (8 * sizeof (K) - 1)) : 0;
+		return U (U (key) ^ sign_flip);
+	}
+	template <typename K> radix_bits_t<K> radix_bits (K key, std::false_type /*floating*/) {
+		using U = radix_bits_t<K>;
+		constexpr U sign = U (1) << (8 * sizeof (K) - 1);
+		U bits;
+		std::memcpy (&bits, &key, sizeof (K));
+		// Negative: reverse the order of magnitudes and put them first.
+		return (bits & sign) ? U (~bits) : U (bits | sign);
+	}
+	template <typename K> radix_bits_t<K> radix_bits (K key) {
+		return radix_bits (key, std::is_integral<K>{});
+	}
+
+	struct identity_key {
+		template <typename T> const T & operator() (const T & t) const noexcept { return t; }
+	};
+
+	template <typename It, typename Key>
+	using radix_key_t = decay_t<invoke_result_t<Key &, iterator_reference_t<It>>>;
+
+	// Stable scatter of [first, last) to out, by byte shift / 8 of the key.
+	template <typename InputIt, typename OutputIt, typename Key>
+	void radix_scatter (InputIt first, InputIt last, OutputIt out, Key & key, unsigned shift,
+	                    std::size_t (&offsets)[256]) {
+		for (; first != last; ++first) {
+			auto digit = (radix_bits (key (*first)) >> shift) & 0xFF;
+			out[static_cast<iterator_difference_t<OutputIt>> (offsets[digit]++)] =
+			    std::move (*first);
+		}
+	}
+
+	template <typename It, typename Key> void radix_sort_impl (It first, It last, Key & key) {
+		using T = iterator_value_type_t<It>;
+		using K = radix_key_t<It, Key>;
+		static_assert (is_radix_key<K>::value, "radix_sort key must be an integral or float");
+		constexpr std::size_t nb_passes = sizeof (K);
+
+		auto n = static_cast<std::size_t> (last - first);
+		if (n < 2)
+			return;
+		std::size_t counts[nb_passes][256] = {};
+		for (auto it = first; it != last; ++it) {
+			auto bits = radix_bits (key (*it));
+			for (std::size_t pass = 0; pass < nb_passes; ++pass)
+				++counts[pass][(bits >> (8 * pass)) & 0xFF];
+		}
+
+		std::vector<T> buffer (n);
+		bool in_buffer = false;
+		auto first_bits = radix_bits (key (*first));
+		for (std::size_t pass = 0; pass < nb_passes; ++pass) {
+			auto shift = static_cast<unsigned> (8 * pass);
+			if (counts[pass][(first_bits >> shift) & 0xFF] == n)
+				continue; // Same byte for all keys
+			std::size_t offsets[256];
+			std::size_t sum = 0;
+			for (std::size_t digit = 0; digit < 256; ++digit) {
+				offsets[digit] = sum;
+				sum += counts[pass][digit];
+			}
+			if (in_buffer)
+				radix_scatter (buffer.begin (), buffer.end (), first, key, shift, offsets);
+			else
+				radix_scatter (first, last, buffer.begin (), key, shift, offsets);
+			in_buffer = !in_buffer;
+			first_bits = radix_bits (key (in_buffer ? buffer.front () : *first));
+		}
+		if (in_buffer)
+			std::move (buffer.begin (), buffer.end (), first);
+	}
+
+	// Below this size, std::sort is faster than radix sort passes (one per key byte).
+	template <typename K> constexpr std::size_t radix_sort_threshold () {
+		return 256 * sizeof (K);
+	}
+
+	template <typename R> using range_element_t = iterator_value_type_t<range_iterator_t<R>>;
+	template <typename R>
+	using is_radix_range =
+	    bool_constant<is_contiguous_range<R>::value && is_radix_key<range_element_t<R>>::value>;
+	template <typename R>
+	using is_stable_radix_range =
+	    bool_constant<is_radix_range<R>::value && std::is_integral<range_element_t<R>>::value>;
+
+	template <typename It> void sort_impl (It first, It last, std::true_type /*radix*/) {
+		using T = iterator_value_type_t<It>;
+		if (static_cast<std::size_t> (last - first) < radix_sort_threshold<T> ())
+			return std::sort (first, last);
+		identity_key key;
+		radix_sort_impl (first, last, key);
+	}
+	template <typename It> void sort_impl (It first, It last, std::false_type) {
+		std::sort (first, last);
+	}
+	// Equal integers are indistinguishable (unlike -0.0 and +0.0): any sort is stable for them.
+	template <typename It> void stable_sort_impl (It first, It last, std::true_type /*radix*/) {
+		sort_impl (first, last, std::true_type{});
+	}
+	template <typename It> void stable_sort_impl (It first, It last, std::false_type) {
+		std::stable_sort (first, last);
+	}
+} // namespace internal_range
+
+template <typename R, typename = enable_if_t<is_range<R>::value>> void radix_sort (R && r) {
+	internal_range::identity_key key;
+	internal_range::radix_sort_impl (begin (r), end (r), key);
+}
+template <typename R, typename Key, typename = enable_if_t<is_range<R>::value>>
+void radix_sort (R && r, Key key) {
+	internal_range::radix_sort_impl (begin (r), end (r), key);
+}
+
+template <typename R, typename = enable_if_t<is_range<R>::value>> void sort (R && r) {
+	internal_range::sort_impl (begin (r), end (r), internal_range::is_radix_range<R>{});
+}
+template <typename R, typename Compare, typename = enable_if_t<is_range<R>::value>>
+void sort (R && r, Compare comp) {
+	std::sort (begin (r), end (r), comp);
+}
+template <typename R, typename = enable_if_t<is_range<R>::value>> void stable_sort (R && r) {
+	internal_range::stable_sort_impl (begin (r), end (r),
+	                                  internal_range::is_stable_radix_range<R>{});
+}
+template <typename R, typename Compare, typename = enable_if_t<is_range<R>::value>>
+void stable_sort (R && r, Compare comp) {
+	std::stable_sort (begin (r), end (r), comp);
+}
+
+// Sort the first (middle - begin (r)) elements, leave the rest in unspecified order.
+template <typename R, typename = enable_if_t<is_range<R>::value>>
+void partial_sort (R && r, range_iterator_t<R> middle) {
+	std::partial_sort (begin (r), middle, end (r));
+}
+template <typename R, typename Compare, typename = enable_if_t<is_range<R>::value>>
+void partial_sort (R && r, range_iterator_t<R> middle, Compare comp) {
+	std::partial_sort (begin (r), middle, end (r), comp);
+}
+
+// Put the value of sorted order at nth, with smaller values before and greater ones after.
+template <typename R, typename = enable_if_t<is_range<R>::value>>
+void nth_element (R && r, range_iterator_t<R> nth) {
+	std::nth_element (begin (r), nth, end (r));
+}
+template <typename R, typename Compare, typename = enable_if_t<is_range<R>::value>>
+void nth_element (R && r, range_iterator_t<R> nth, Compare comp) {
+	std::nth_element (begin (r), nth, end (r), comp);
+}
+
+namespace internal_range {
+	// Replace the top (greatest) value of a non empty max heap, and sift it down.
+	template <typename T, typename V, typename Compare>
+	void heap_replace_top (std::vector<T> & heap, V && value, Compare & comp) {
+		std::size_t hole = 0;
+		auto n = heap.size ();
+		for (;;) {
+			auto child = 2 * hole + 1;
+			if (child >= n)
+				break;
+			if (child + 1 < n && comp (heap[child], heap[child + 1]))
+				++child;
+			if (!comp (value, heap[child]))
+				break;
+			heap[hole] = std::move (heap[child]);
+			hole = child;
+		}
+		heap[hole] = std::forward<V> (value);
+	}
+} // namespace internal_range
+
+/* top_k (r, k[, comp]): the k first values of r in comp order (default: the k smallest), sorted.
+ * Single pass on any input range (streams, lazy combinators), keeping a heap of the k best values:
+ * O(n log k) time and O(k) memory. Returns all values sorted if r has less than k values.
+ * Use std::greater<> as comp for the k largest values.
+ */
+template <typename R, typename Compare, typename = enable_if_t<is_range<const R &>::value>>
+std::vector<iterator_value_type_t<range_iterator_t<const R &>>> top_k (const R & r, std::size_t k,
+                                                                         Compare comp) {
+	std::vector<iterator_value_type_t<range_iterator_t<const R &>>> heap;
+	if (k == 0)
+		return heap;
+	auto hint = size_hint (r);
+	auto capacity = k;
+	if (hint.kind != SizeHint::unknown)
+		capacity = std::min (capacity, static_cast<std::size_t> (hint.value));
+	heap.reserve (capacity);
+	for (auto && v : r) {
+		if (heap.size () < k) {
+			heap.emplace_back (std::forward<decltype (v)> (v));
+			std::push_heap (heap.begin (), heap.end (), comp);
+		} else if (comp (v, heap.front ())) {
+			internal_range::heap_replace_top (heap, std::forward<decltype (v)> (v), comp);
+		}
+	}
+	std::sort_heap (heap.begin (), heap.end (), comp);
+	return heap;
+}
+template <typename R, typename = enable_if_t<is_range<const R &>::value>>
+std::vector<iterator_value_type_t<range_iterator_t<const R &>>> top_k (const R & r,
+                                                                         std::size_t k) {
+	return top_k (r, k, std::less<iterator_value_type_t<range_iterator_t<const R &>>>{});
+}
+
+// minimum / maximum operations
+
+namespace internal_range {
+	template <typename R>
+	range_iterator_t<const R &> min_element_impl (const R & r, std::true_type /*simd*/) {
+		auto index = Detail::simd_min_index (duck::data (r), simd_size (r));
+		return begin (r) + static_cast<iterator_difference_t<range_iterator_t<const R &>>> (index);
+	}
+	template <typename R>
+	range_iterator_t<const R &> min_element_impl (const R & r, std::false_type) {
+		return std::min_element (begin (r), end (r));
+	}
+	template <typename R>
+	range_iterator_t<const R &> max_element_impl (const R & r, std::true_type /*simd*/) {
+		auto index = Detail::simd_max_index (duck::data (r), simd_size (r));
+		return begin (r) + static_cast<iterator_difference_t<range_iterator_t<const R &>>> (index);
+	}
+	template <typename R>
+	range_iterator_t<const R &> max_element_impl (const R & r, std::false_type) {
+		return std::max_element (begin (r), end (r));
+	}
+} // namespace internal_range
+
+template <typename R, typename = enable_if_t<is_range<const R &>::value>>
+range_iterator_t<const R> min_element (const R & r) {
+	return internal_range::min_element_impl (r, internal_range::is_simd_range<R>{});
+}
+template <typename R, typename Compare, typename = enable_if_t<is_range<const R &>::value>>
+range_iterator_t<const R> min_element (const R & r, Compare comp) {
+	return std::min_element (begin (r), end (r), comp);
+}
+template <typename R, typename = enable_if_t<is_range<const R &>::value>>
+range_iterator_t<const R> max_element (const R & r) {
+	return internal_range::max_element_impl (r, internal_range::is_simd_range<R>{});
+}
+template <typename R, typename Compare, typename = enable_if_t<is_range<const R &>::value>>
+range_iterator_t<const R> max_element (const R & r, Compare comp) {
+	return std::max_element (begin (r), end (r), comp);
+}
+
 // TODO rest of algorithm
 } // namespace duck
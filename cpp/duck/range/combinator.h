@@ -5,8 +5,12 @@
 
 #include <algorithm>
 #include <cassert>
+#include <duck/optional.h>
 #include <duck/range/range.h>
+#include <duck/view.h>
 #include <limits>
+#include <tuple>
+#include <utility>
 
 namespace duck {
 /********************************************************************************
@@ -30,9 +34,34 @@ struct is_unary_predicate<
     void_t<decltype (static_cast<bool> (std::declval<Predicate> () (std::declval<Arg> ())))>>
     : std::true_type {};
 
+namespace internal_range {
+	/* Optional iterator on the inner range of a combinator, computed on first use.
+	 * Copies are empty and assignments empty it: the stored iterator may refer to the source inner
+	 * range (held by value).
+	 */
+	template <typename It> class iterator_cache : public Optional<It> {
+	public:
+		iterator_cache () = default;
+		iterator_cache (const iterator_cache &) noexcept : Optional<It> () {}
+		iterator_cache & operator= (const iterator_cache &) noexcept {
+			this->reset ();
+			return *this;
+		}
+		using Optional<It>::operator=;
+	};
+} // namespace internal_range
+
 /********************************************************************************
  * Pop front.
  */
+namespace internal_range {
+	// Size hint of r without n elements
+	template <typename R> SizeHint size_hint_minus (const R & r, std::ptrdiff_t n) {
+		return size_hint (r).transform (
+		    [n](std::ptrdiff_t s) { return std::max (s - n, std::ptrdiff_t (0)); });
+	}
+} // namespace internal_range
+
 template <typename R> class pop_front_range {
 	static_assert (is_range<R>::value, "pop_front_range<R>: R must be a range");
 
@@ -48,6 +77,7 @@ public:
 	iterator begin () const { return std::next (duck::adl_begin (inner_), n_); }
 	iterator end () const { return duck::adl_end (inner_); }
 	iterator_difference_t<iterator> size () const { return duck::size (inner_) - n_; }
+	SizeHint size_hint () const { return internal_range::size_hint_minus (inner_, n_); }
 
 private:
 	R inner_;
@@ -108,6 +138,7 @@ public:
 	iterator begin () const { return duck::adl_begin (inner_); }
 	iterator end () const { return internal_range::nth_iterator_from_end (inner_, n_); }
 	iterator_difference_t<iterator> size () const { return duck::size (inner_) - n_; }
+	SizeHint size_hint () const { return internal_range::size_hint_minus (inner_, n_); }
 
 private:
 	R inner_;
@@ -153,6 +184,15 @@ public:
 		return internal_range::normalize_index (inner_, to_) -
 		       internal_range::normalize_index (inner_, from_);
 	}
+	SizeHint size_hint () const {
+		if (from_ >= 0 && to_ >= 0)
+			return {SizeHint::exact, static_cast<std::ptrdiff_t> (to_ - from_)};
+		auto hint = duck::size_hint (inner_);
+		if (hint.kind != SizeHint::exact)
+			return {};
+		auto normalize = [&hint](std::ptrdiff_t i) { return i < 0 ? hint.value + i : i; };
+		return {SizeHint::exact, normalize (to_) - normalize (from_)};
+	}
 
 private:
 	R inner_;
@@ -193,6 +233,7 @@ public:
 	iterator begin () const { return iterator{duck::adl_end (inner_)}; }
 	iterator end () const { return iterator{duck::adl_begin (inner_)}; }
 	iterator_difference_t<iterator> size () const { return duck::size (inner_); }
+	SizeHint size_hint () const { return duck::size_hint (inner_); }
 
 private:
 	R inner_;
@@ -295,6 +336,7 @@ public:
 	iterator begin () const { return {duck::adl_begin (inner_), 0}; }
 	iterator end () const { return {duck::adl_end (inner_), std::numeric_limits<Int>::max ()}; }
 	iterator_difference_t<iterator> size () const { return duck::size (inner_); }
+	SizeHint size_hint () const { return duck::size_hint (inner_); }
 
 private:
 	R inner_;
@@ -372,6 +414,14 @@ public:
 
 	iterator begin () const { return {next (duck::adl_begin (inner_)), *this}; }
 	iterator end () const { return {duck::adl_end (inner_), *this}; }
+	SizeHint size_hint () const { return duck::size_hint (inner_).at_most (); }
+
+	// Internal iteration, see duck::push_each
+	template <typename Sink> bool push (Sink & sink) const {
+		return duck::push_each (inner_, [this, &sink](auto && v) {
+			return !predicate_ (v) || sink (std::forward<decltype (v)> (v));
+		});
+	}
 
 private:
 	inner_iterator next (inner_iterator from) const {
@@ -423,6 +473,52 @@ filtered_range<R, Predicate> operator| (R && r, filtered_range_tag<Predicate> ta
 	return {std::forward<R> (r), std::move (tag.predicate)};
 }
 
+/********************************************************************************
+ * Cached begin.
+ * begin () is computed on first use and stored: later calls (repeated iteration, duck::empty,
+ * duck::front, duck::size) are O(1). Useful on top of filter, whose begin () searches the first
+ * match each time: r | duck::filter (p) | duck::cache_begin ().
+ * The cache is not thread safe, even for const uses. It is dropped on copy / move / assignment,
+ * as the stored iterator may refer to the source range (see internal_range::iterator_cache).
+ * Like other combinators, it is not assignable if the inner range is an lvalue reference.
+ * The inner range must not be modified while the cache is used.
+ */
+template <typename R> class cached_begin_range {
+	static_assert (is_range<R>::value, "cached_begin_range<R>: R must be a range");
+
+public:
+	using iterator = range_iterator_t<R>;
+
+	cached_begin_range (R && r) : inner_ (std::forward<R> (r)) {}
+
+	iterator begin () const {
+		if (!cached_begin_)
+			cached_begin_ = duck::adl_begin (inner_);
+		return *cached_begin_;
+	}
+	iterator end () const { return duck::adl_end (inner_); }
+	SizeHint size_hint () const { return duck::size_hint (inner_); }
+
+	// Internal iteration, see duck::push_each
+	template <typename Sink> bool push (Sink & sink) const { return duck::push_each (inner_, sink); }
+
+private:
+	R inner_;
+	mutable internal_range::iterator_cache<iterator> cached_begin_;
+};
+
+template <typename R> cached_begin_range<R> cache_begin (R && r) {
+	return {std::forward<R> (r)};
+}
+
+struct cached_begin_range_tag {};
+inline cached_begin_range_tag cache_begin () {
+	return {};
+}
+template <typename R> cached_begin_range<R> operator| (R && r, cached_begin_range_tag) {
+	return {std::forward<R> (r)};
+}
+
 /********************************************************************************
  * Processed range.
  * Apply function f to each element.
@@ -495,6 +591,14 @@ public:
 	iterator begin () const { return {duck::adl_begin (inner_), *this}; }
 	iterator end () const { return {duck::adl_end (inner_), *this}; }
 	iterator_difference_t<iterator> size () const { return duck::size (inner_); }
+	SizeHint size_hint () const { return duck::size_hint (inner_); }
+
+	// Internal iteration, see duck::push_each
+	template <typename Sink> bool push (Sink & sink) const {
+		return duck::push_each (inner_, [this, &sink](auto && v) {
+			return sink (function_ (std::forward<decltype (v)> (v)));
+		});
+	}
 
 private:
 	R inner_;
@@ -518,4 +622,618 @@ template <typename R, typename Function>
 mapped_range<R, Function> operator| (R && r, mapped_range_tag<Function> tag) {
 	return {std::forward<R> (r), std::move (tag.function)};
 }
+
+/********************************************************************************
+ * Chunks of up to n elements.
+ * Each element is a sub range of n elements (the last one may be shorter):
+ * - contiguous inputs (see is_contiguous_range): duck::span on the storage (zero copy).
+ *   The chunk iterator is random access.
+ * - other forward inputs: iterator_pair of inner iterators. O(1) per chunk for random access.
+ * - input (single pass) inputs: a chunk sub range sharing the iteration state with the chunk
+ *   range. Chunks must be iterated in order ; elements not iterated in a chunk are skipped.
+ *   The iteration state is set by the first begin () call, and not copied with the range.
+ */
+namespace internal_range {
+	struct chunk_contiguous_tag {};
+	struct chunk_forward_tag {};
+	struct chunk_input_tag {};
+
+	template <typename R>
+	using chunk_kind_t = conditional_t<
+	    is_contiguous_range<const R &>::value, chunk_contiguous_tag,
+	    conditional_t<is_iterator_of_category<range_iterator_t<R>, std::forward_iterator_tag>::value,
+	                  chunk_forward_tag, chunk_input_tag>>;
+
+	// Advance it by at most n, without going past end.
+	template <typename It>
+	It advance_bounded (It it, iterator_difference_t<It> n, It end, std::random_access_iterator_tag) {
+		return end - it <= n ? end : it + n;
+	}
+	template <typename It>
+	It advance_bounded (It it, iterator_difference_t<It> n, It end, std::input_iterator_tag) {
+		for (; n > 0 && it != end; --n)
+			++it;
+		return it;
+	}
+} // namespace internal_range
+
+template <typename R, typename Kind = internal_range::chunk_kind_t<R>> class chunk_range;
+
+template <typename R> class chunk_range<R, internal_range::chunk_contiguous_tag> {
+	static_assert (is_range<R>::value, "chunk_range<R>: R must be a range");
+
+public:
+	// Mutable span if R is a non const lvalue reference
+	using element_pointer = decltype (duck::data (std::declval<const R &> ()));
+	using chunk_type = span<remove_pointer_t<element_pointer>>;
+
+	class iterator {
+	public:
+		using iterator_category = std::random_access_iterator_tag;
+		using value_type = chunk_type;
+		using difference_type = std::ptrdiff_t;
+		using pointer = void;
+		using reference = value_type;
+
+		iterator () = default;
+		iterator (element_pointer base, std::ptrdiff_t size, std::ptrdiff_t n, std::ptrdiff_t chunk)
+		    : base_ (base), size_ (size), n_ (n), chunk_ (chunk) {}
+
+		// Input / output
+		iterator & operator++ () { return ++chunk_, *this; }
+		reference operator* () const {
+			auto offset = chunk_ * n_;
+			return chunk_type (base_ + offset, std::min (n_, size_ - offset));
+		}
+		bool operator== (const iterator & o) const { return chunk_ == o.chunk_; }
+		bool operator!= (const iterator & o) const { return chunk_ != o.chunk_; }
+
+		// Forward
+		iterator operator++ (int) {
+			iterator tmp (*this);
+			++*this;
+			return tmp;
+		}
+
+		// Bidir
+		iterator & operator-- () { return --chunk_, *this; }
+		iterator operator-- (int) {
+			iterator tmp (*this);
+			--*this;
+			return tmp;
+		}
+
+		// Random access
+		iterator & operator+= (difference_type n) { return chunk_ += n, *this; }
+		iterator operator+ (difference_type n) const { return iterator (base_, size_, n_, chunk_ + n); }
+		friend iterator operator+ (difference_type n, const iterator & it) { return it + n; }
+		iterator & operator-= (difference_type n) { return chunk_ -= n, *this; }
+		iterator operator- (difference_type n) const { return iterator (base_, size_, n_, chunk_ - n); }
+		difference_type operator- (const iterator & o) const { return chunk_ - o.chunk_; }
+		reference operator[] (difference_type n) const { return *(*this + n); }
+		bool operator< (const iterator & o) const { return chunk_ < o.chunk_; }
+		bool operator> (const iterator & o) const { return chunk_ > o.chunk_; }
+		bool operator<= (const iterator & o) const { return chunk_ <= o.chunk_; }
+		bool operator>= (const iterator & o) const { return chunk_ >= o.chunk_; }
+
+	private:
+		element_pointer base_{nullptr};
+		std::ptrdiff_t size_{0};
+		std::ptrdiff_t n_{1};
+		std::ptrdiff_t chunk_{0};
+	};
+
+	chunk_range (R && r, std::ptrdiff_t n) : inner_ (std::forward<R> (r)), n_ (n) { assert (n_ > 0); }
+
+	iterator begin () const { return {duck::data (inner_), inner_size (), n_, 0}; }
+	iterator end () const { return {duck::data (inner_), inner_size (), n_, size ()}; }
+	std::ptrdiff_t size () const { return (inner_size () + n_ - 1) / n_; }
+
+private:
+	std::ptrdiff_t inner_size () const { return static_cast<std::ptrdiff_t> (duck::size (inner_)); }
+
+	R inner_;
+	std::ptrdiff_t n_;
+};
+
+template <typename R> class chunk_range<R, internal_range::chunk_forward_tag> {
+	static_assert (is_range<R>::value, "chunk_range<R>: R must be a range");
+
+public:
+	using inner_iterator = range_iterator_t<R>;
+	using chunk_type = iterator_pair<inner_iterator>;
+
+	class iterator {
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = chunk_type;
+		using difference_type = iterator_difference_t<inner_iterator>;
+		using pointer = void;
+		using reference = value_type;
+
+		iterator () = default;
+		iterator (inner_iterator it, inner_iterator end, difference_type n)
+		    : it_ (it), chunk_end_ (next_chunk_end (it, end, n)), end_ (end), n_ (n) {}
+
+		// Input / output
+		iterator & operator++ () {
+			it_ = chunk_end_;
+			chunk_end_ = next_chunk_end (it_, end_, n_);
+			return *this;
+		}
+		reference operator* () const { return {it_, chunk_end_}; }
+		bool operator== (const iterator & o) const { return it_ == o.it_; }
+		bool operator!= (const iterator & o) const { return it_ != o.it_; }
+
+		// Forward
+		iterator operator++ (int) {
+			iterator tmp (*this);
+			++*this;
+			return tmp;
+		}
+
+	private:
+		static inner_iterator next_chunk_end (inner_iterator it, inner_iterator end,
+		                                      difference_type n) {
+			return internal_range::advance_bounded (it, n, end,
+			                                        iterator_category_t<inner_iterator>{});
+		}
+
+		inner_iterator it_{};
+		inner_iterator chunk_end_{};
+		inner_iterator end_{};
+		difference_type n_{1};
+	};
+
+	chunk_range (R && r, std::ptrdiff_t n) : inner_ (std::forward<R> (r)), n_ (n) { assert (n_ > 0); }
+
+	iterator begin () const { return {duck::adl_begin (inner_), duck::adl_end (inner_), n_}; }
+	iterator end () const { return {duck::adl_end (inner_), duck::adl_end (inner_), n_}; }
+	iterator_difference_t<inner_iterator> size () const {
+		return (duck::size (inner_) + n_ - 1) / n_;
+	}
+	SizeHint size_hint () const {
+		auto n = n_;
+		return duck::size_hint (inner_).transform ([n](std::ptrdiff_t s) { return (s + n - 1) / n; });
+	}
+
+private:
+	R inner_;
+	iterator_difference_t<inner_iterator> n_;
+};
+
+template <typename R> class chunk_range<R, internal_range::chunk_input_tag> {
+	static_assert (is_range<R>::value, "chunk_range<R>: R must be a range");
+
+public:
+	using inner_iterator = range_iterator_t<R>;
+	using difference_type = iterator_difference_t<inner_iterator>;
+
+	// Elements of the current chunk: iterating advances the shared inner iterator.
+	class chunk_type {
+	public:
+		class iterator {
+		public:
+			using iterator_category = std::input_iterator_tag;
+			using value_type = iterator_value_type_t<inner_iterator>;
+			using difference_type = iterator_difference_t<inner_iterator>;
+			using pointer = iterator_pointer_t<inner_iterator>;
+			using reference = iterator_reference_t<inner_iterator>;
+
+			iterator () = default;
+			explicit iterator (const chunk_range * range) : range_ (range) {}
+
+			iterator & operator++ () { return range_->advance (), *this; }
+			reference operator* () const { return **range_->it_; }
+			// End iterator has a null range: equal if both are at the end of the chunk
+			bool operator== (const iterator & o) const { return at_end () == o.at_end (); }
+			bool operator!= (const iterator & o) const { return !(*this == o); }
+
+		private:
+			bool at_end () const { return range_ == nullptr || range_->chunk_done (); }
+			const chunk_range * range_{nullptr};
+		};
+
+		explicit chunk_type (const chunk_range & range) : range_ (&range) {}
+		iterator begin () const { return iterator{range_}; }
+		iterator end () const { return iterator{}; }
+
+	private:
+		const chunk_range * range_;
+	};
+
+	class iterator {
+	public:
+		using iterator_category = std::input_iterator_tag;
+		using value_type = chunk_type;
+		using difference_type = iterator_difference_t<inner_iterator>;
+		using pointer = void;
+		using reference = value_type;
+
+		iterator () = default;
+		explicit iterator (const chunk_range * range) : range_ (range) {}
+
+		iterator & operator++ () { return range_->next_chunk (), *this; }
+		reference operator* () const { return chunk_type{*range_}; }
+		bool operator== (const iterator & o) const { return at_end () == o.at_end (); }
+		bool operator!= (const iterator & o) const { return !(*this == o); }
+
+	private:
+		bool at_end () const { return range_ == nullptr || range_->at_end (); }
+		const chunk_range * range_{nullptr};
+	};
+
+	chunk_range (R && r, std::ptrdiff_t n) : inner_ (std::forward<R> (r)), n_ (n), remaining_ (n) {
+		assert (n_ > 0);
+	}
+	// Single pass: begin () continues from the current position.
+	iterator begin () const {
+		if (!it_) {
+			it_ = duck::adl_begin (inner_);
+			end_ = duck::adl_end (inner_);
+			remaining_ = n_;
+		}
+		return iterator{this};
+	}
+	iterator end () const { return iterator{}; }
+
+private:
+	bool at_end () const { return *it_ == *end_; }
+	bool chunk_done () const { return remaining_ == 0 || at_end (); }
+	void advance () const {
+		++*it_;
+		--remaining_;
+	}
+	void next_chunk () const {
+		while (!chunk_done ())
+			advance ();
+		remaining_ = n_;
+	}
+
+	R inner_;
+	difference_type n_;
+	// Iteration state, set by the first begin (). Copies and moves start again from begin ().
+	mutable internal_range::iterator_cache<inner_iterator> it_;
+	mutable internal_range::iterator_cache<inner_iterator> end_;
+	mutable difference_type remaining_;
+};
+
+template <typename R> chunk_range<R> chunk (R && r, std::ptrdiff_t n) {
+	return {std::forward<R> (r), n};
+}
+
+struct chunk_range_tag {
+	std::ptrdiff_t n;
+};
+inline chunk_range_tag chunk (std::ptrdiff_t n) {
+	return {n};
+}
+template <typename R> chunk_range<R> operator| (R && r, chunk_range_tag tag) {
+	return {std::forward<R> (r), tag.n};
+}
+
+/********************************************************************************
+ * Join (flatten) a range of ranges.
+ * Elements of the first segment (inner range), then of the second, etc. Empty segments are skipped.
+ * Iterators are forward at most. They point into segments: segments must be lvalues of the outer
+ * range, or views whose iterators stay valid after the view is destroyed (span, string_view).
+ *
+ * The range is segmented (see duck::is_segmented_range): duck algorithms (for_each, count, find...)
+ * run a tight loop on each segment (with SIMD for contiguous segments), without checking segment
+ * boundaries at each increment.
+ */
+template <typename R> class joined_range {
+	static_assert (is_range<R>::value, "joined_range<R>: R must be a range");
+	static_assert (is_range<iterator_reference_t<range_iterator_t<R>>>::value,
+	               "joined_range<R>: R elements must be ranges");
+
+public:
+	using outer_iterator = range_iterator_t<R>;
+	using inner_iterator = range_iterator_t<iterator_reference_t<outer_iterator>>;
+
+	class iterator {
+	public:
+		using iterator_category =
+		    common_type_t<std::forward_iterator_tag, iterator_category_t<outer_iterator>,
+		                  iterator_category_t<inner_iterator>>;
+		using value_type = iterator_value_type_t<inner_iterator>;
+		using difference_type = iterator_difference_t<inner_iterator>;
+		using pointer = iterator_pointer_t<inner_iterator>;
+		using reference = iterator_reference_t<inner_iterator>;
+
+		iterator () = default;
+		// Points to *it in *outer, or to the next element if it is the end of *outer.
+		iterator (outer_iterator outer, inner_iterator it, const joined_range & range)
+		    : outer_ (outer), range_ (&range) {
+			if (outer_ != range_->outer_end ()) {
+				it_ = it;
+				it_end_ = duck::adl_end (*outer_);
+				if (it_ == it_end_)
+					next_segment ();
+			}
+		}
+
+		outer_iterator segment () const { return outer_; }
+		inner_iterator base () const { return it_; }
+
+		// Input / output
+		iterator & operator++ () {
+			if (++it_ == it_end_)
+				next_segment ();
+			return *this;
+		}
+		reference operator* () const { return *it_; }
+		pointer operator-> () const { return it_.operator-> (); }
+		bool operator== (const iterator & o) const { return outer_ == o.outer_ && it_ == o.it_; }
+		bool operator!= (const iterator & o) const { return !(*this == o); }
+
+		// Forward
+		iterator operator++ (int) {
+			iterator tmp (*this);
+			++*this;
+			return tmp;
+		}
+
+	private:
+		// Move to the first element of the next non empty segment, or to the end
+		void next_segment () {
+			auto end = range_->outer_end ();
+			while (++outer_ != end) {
+				it_ = duck::adl_begin (*outer_);
+				it_end_ = duck::adl_end (*outer_);
+				if (it_ != it_end_)
+					return;
+			}
+			it_ = it_end_ = inner_iterator{};
+		}
+
+		outer_iterator outer_{};
+		inner_iterator it_{};
+		inner_iterator it_end_{};
+		const joined_range * range_{nullptr};
+	};
+
+	joined_range (R && r) : inner_ (std::forward<R> (r)) {}
+
+	iterator begin () const {
+		auto outer = duck::adl_begin (inner_);
+		if (outer == outer_end ())
+			return end ();
+		return {outer, duck::adl_begin (*outer), *this};
+	}
+	iterator end () const { return {outer_end (), inner_iterator{}, *this}; }
+
+	// Segmented range, see duck::is_segmented_range
+	const R & segments () const { return inner_; }
+	iterator make_iterator (outer_iterator segment, inner_iterator it) const {
+		return {segment, it, *this};
+	}
+
+	// Internal iteration, see duck::push_each
+	template <typename Sink> bool push (Sink & sink) const {
+		return duck::push_each (inner_, [&sink](auto && segment) {
+			return duck::push_each (segment, sink);
+		});
+	}
+
+private:
+	outer_iterator outer_end () const { return duck::adl_end (inner_); }
+
+	R inner_;
+};
+
+template <typename R> joined_range<R> join (R && r) {
+	return {std::forward<R> (r)};
+}
+
+struct joined_range_tag {};
+inline joined_range_tag join () {
+	return {};
+}
+template <typename R> joined_range<R> operator| (R && r, joined_range_tag) {
+	return {std::forward<R> (r)};
+}
+
+/********************************************************************************
+ * Zip ranges.
+ * Elements are tuples of references to the elements of each input, at the same position.
+ * The zipped range stops at the end of the shortest input.
+ * If all inputs are random access, iterators are random access: they store the begin iterators and
+ * one index, so a loop over zipped contiguous ranges compiles to an index loop (vectorizable).
+ * Otherwise iterators are at most forward: they advance all inputs together.
+ */
+namespace internal_range {
+	template <bool... B> struct bool_pack {};
+	template <bool... B> using all_true = std::is_same<bool_pack<true, B...>, bool_pack<B..., true>>;
+
+	template <typename... It>
+	using all_random_access =
+	    all_true<is_iterator_of_category<It, std::random_access_iterator_tag>::value...>;
+
+	// Evaluate f (I) for each index in order.
+	template <typename F, std::size_t... I> void for_each_index (F && f, std::index_sequence<I...>) {
+		int expand[] = {0, (f (std::integral_constant<std::size_t, I>{}), 0)...};
+		(void) expand;
+	}
+
+	// Size hint of the shortest range
+	inline SizeHint min_size_hint (SizeHint hint) {
+		return hint;
+	}
+	template <typename... Hints> SizeHint min_size_hint (SizeHint a, SizeHint b, Hints... others) {
+		SizeHint m;
+		if (a.kind == SizeHint::unknown)
+			m = b.at_most ();
+		else if (b.kind == SizeHint::unknown)
+			m = a.at_most ();
+		else
+			m = {a.kind == SizeHint::exact && b.kind == SizeHint::exact ? SizeHint::exact
+			                                                            : SizeHint::upper_bound,
+			     std::min (a.value, b.value)};
+		return min_size_hint (m, others...);
+	}
+
+	template <typename... It> class zip_index_iterator {
+	public:
+		using iterator_category = std::random_access_iterator_tag;
+		using value_type = std::tuple<iterator_value_type_t<It>...>;
+		using difference_type = common_type_t<iterator_difference_t<It>...>;
+		using pointer = void;
+		using reference = std::tuple<iterator_reference_t<It>...>;
+
+		zip_index_iterator () = default;
+		zip_index_iterator (const std::tuple<It...> & bases, difference_type index)
+		    : bases_ (bases), index_ (index) {}
+
+		difference_type index () const { return index_; }
+
+		// Input / output
+		zip_index_iterator & operator++ () { return ++index_, *this; }
+		reference operator* () const { return deref (index_, std::index_sequence_for<It...>{}); }
+		bool operator== (const zip_index_iterator & o) const { return index_ == o.index_; }
+		bool operator!= (const zip_index_iterator & o) const { return index_ != o.index_; }
+
+		// Forward
+		zip_index_iterator operator++ (int) {
+			zip_index_iterator tmp (*this);
+			++*this;
+			return tmp;
+		}
+
+		// Bidir
+		zip_index_iterator & operator-- () { return --index_, *this; }
+		zip_index_iterator operator-- (int) {
+			zip_index_iterator tmp (*this);
+			--*this;
+			return tmp;
+		}
+
+		// Random access
+		zip_index_iterator & operator+= (difference_type n) { return index_ += n, *this; }
+		zip_index_iterator operator+ (difference_type n) const {
+			return zip_index_iterator (bases_, index_ + n);
+		}
+		friend zip_index_iterator operator+ (difference_type n, const zip_index_iterator & it) {
+			return it + n;
+		}
+		zip_index_iterator & operator-= (difference_type n) { return index_ -= n, *this; }
+		zip_index_iterator operator- (difference_type n) const {
+			return zip_index_iterator (bases_, index_ - n);
+		}
+		difference_type operator- (const zip_index_iterator & o) const { return index_ - o.index_; }
+		reference operator[] (difference_type n) const {
+			return deref (index_ + n, std::index_sequence_for<It...>{});
+		}
+		bool operator< (const zip_index_iterator & o) const { return index_ < o.index_; }
+		bool operator> (const zip_index_iterator & o) const { return index_ > o.index_; }
+		bool operator<= (const zip_index_iterator & o) const { return index_ <= o.index_; }
+		bool operator>= (const zip_index_iterator & o) const { return index_ >= o.index_; }
+
+	private:
+		template <std::size_t... I>
+		reference deref (difference_type i, std::index_sequence<I...>) const {
+			return reference (*(std::get<I> (bases_) + i)...);
+		}
+
+		std::tuple<It...> bases_{};
+		difference_type index_{0};
+	};
+
+	template <typename... It> class zip_iterator {
+	public:
+		using iterator_category = common_type_t<std::forward_iterator_tag, iterator_category_t<It>...>;
+		using value_type = std::tuple<iterator_value_type_t<It>...>;
+		using difference_type = common_type_t<iterator_difference_t<It>...>;
+		using pointer = void;
+		using reference = std::tuple<iterator_reference_t<It>...>;
+
+		zip_iterator () = default;
+		zip_iterator (const std::tuple<It...> & its) : its_ (its) {}
+
+		// Input / output
+		zip_iterator & operator++ () {
+			for_each_index ([this](auto i) { ++std::get<decltype (i)::value> (its_); },
+			                std::index_sequence_for<It...>{});
+			return *this;
+		}
+		reference operator* () const { return deref (std::index_sequence_for<It...>{}); }
+		// Equal if any input iterator is equal: end () is reached at the end of the shortest input.
+		bool operator== (const zip_iterator & o) const {
+			bool equal = false;
+			for_each_index (
+			    [&](auto i) {
+				    constexpr auto I = decltype (i)::value;
+				    equal = equal || std::get<I> (its_) == std::get<I> (o.its_);
+			    },
+			    std::index_sequence_for<It...>{});
+			return equal;
+		}
+		bool operator!= (const zip_iterator & o) const { return !(*this == o); }
+
+		// Forward
+		zip_iterator operator++ (int) {
+			zip_iterator tmp (*this);
+			++*this;
+			return tmp;
+		}
+
+	private:
+		template <std::size_t... I> reference deref (std::index_sequence<I...>) const {
+			return reference (*std::get<I> (its_)...);
+		}
+
+		std::tuple<It...> its_{};
+	};
+} // namespace internal_range
+
+template <typename... R> class zip_range {
+	static_assert (sizeof...(R) > 0, "zip_range<R...>: needs at least one range");
+	static_assert (internal_range::all_true<is_range<R>::value...>::value,
+	               "zip_range<R...>: R must be ranges");
+
+	using is_random_access = internal_range::all_random_access<range_iterator_t<R>...>;
+	using indexes = std::index_sequence_for<R...>;
+
+public:
+	using iterator =
+	    conditional_t<is_random_access::value,
+	                  internal_range::zip_index_iterator<range_iterator_t<R>...>,
+	                  internal_range::zip_iterator<range_iterator_t<R>...>>;
+
+	zip_range (R &&... r) : inner_ (std::forward<R> (r)...) {}
+
+	iterator begin () const { return begin_impl (is_random_access{}); }
+	iterator end () const { return end_impl (is_random_access{}); }
+	iterator_difference_t<iterator> size () const { return size_impl (indexes{}); }
+	SizeHint size_hint () const { return size_hint_impl (indexes{}); }
+
+private:
+	iterator begin_impl (std::true_type /*random_access*/) const { return {begins (indexes{}), 0}; }
+	iterator begin_impl (std::false_type) const { return {begins (indexes{})}; }
+	iterator end_impl (std::true_type) const { return {begins (indexes{}), size ()}; }
+	iterator end_impl (std::false_type) const { return {ends (indexes{})}; }
+
+	template <std::size_t... I>
+	std::tuple<range_iterator_t<R>...> begins (std::index_sequence<I...>) const {
+		return std::tuple<range_iterator_t<R>...> (duck::adl_begin (std::get<I> (inner_))...);
+	}
+	template <std::size_t... I>
+	std::tuple<range_iterator_t<R>...> ends (std::index_sequence<I...>) const {
+		return std::tuple<range_iterator_t<R>...> (duck::adl_end (std::get<I> (inner_))...);
+	}
+	template <std::size_t... I>
+	iterator_difference_t<iterator> size_impl (std::index_sequence<I...>) const {
+		using D = iterator_difference_t<iterator>;
+		return std::min ({static_cast<D> (duck::size (std::get<I> (inner_)))...});
+	}
+	template <std::size_t... I> SizeHint size_hint_impl (std::index_sequence<I...>) const {
+		return internal_range::min_size_hint (duck::size_hint (std::get<I> (inner_))...);
+	}
+
+	std::tuple<R...> inner_;
+};
+
+template <typename... R> zip_range<R...> zip (R &&... r) {
+	return {std::forward<R> (r)...};
+}
 } // namespace duck
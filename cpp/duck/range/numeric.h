@@ -0,0 +1,265 @@
+#pragma once
+
+// Overloads of <numeric> functions to accept range arguments instead of iterator pairs.
+// Overloads taking an execution policy are in duck/range/parallel_numeric.h.
+// STATUS: WIP (missing part of <numeric>), NSC
+
+#include <algorithm>
+#include <duck/optional.h>
+#include <duck/range/range.h>
+#include <duck/simd.h>
+#include <functional>
+#include <iterator>
+#include <numeric>
+#include <vector>
+
+namespace duck {
+
+// accumulate: ranges with a push method (see duck::push_each) run as one fused loop
+namespace internal_range {
+	template <typename R, typename T, typename BinaryOperation>
+	T accumulate_impl (const R & r, T init, BinaryOperation & op, std::true_type /*push*/) {
+		push_each (r, [&init, &op](auto && v) {
+			init = op (std::move (init), std::forward<decltype (v)> (v));
+			return true;
+		});
+		return init;
+	}
+	template <typename R, typename T, typename BinaryOperation>
+	T accumulate_impl (const R & r, T init, BinaryOperation & op, std::false_type) {
+		return std::accumulate (begin (r), end (r), std::move (init), op);
+	}
+} // namespace internal_range
+
+template <typename R, typename T, typename BinaryOperation,
+          typename = enable_if_t<is_range<const R &>::value>>
+T accumulate (const R & r, T init, BinaryOperation op) {
+	return internal_range::accumulate_impl (r, std::move (init), op, has_push_method<const R &>{});
+}
+template <typename R, typename T, typename = enable_if_t<is_range<const R &>::value>>
+T accumulate (const R & r, T init) {
+	return duck::accumulate (r, std::move (init), std::plus<>{});
+}
+
+/* sum: sum of elements, like std::reduce (first, last).
+ * The order of additions is unspecified: contiguous ranges of arithmetic values use SIMD kernels.
+ * The result has the element type, integers wrap around on overflow.
+ */
+namespace internal_range {
+	template <typename R>
+	iterator_value_type_t<range_iterator_t<const R &>> sum_impl (const R & r, std::true_type) {
+		return Detail::simd_sum (duck::data (r), static_cast<std::size_t> (size (r)));
+	}
+	template <typename R>
+	iterator_value_type_t<range_iterator_t<const R &>> sum_impl (const R & r, std::false_type) {
+		return duck::accumulate (r, iterator_value_type_t<range_iterator_t<const R &>>{});
+	}
+} // namespace internal_range
+template <typename R, typename = enable_if_t<is_range<const R &>::value>>
+iterator_value_type_t<range_iterator_t<const R &>> sum (const R & r) {
+	using T = iterator_value_type_t<range_iterator_t<const R &>>;
+	return internal_range::sum_impl (
+	    r, bool_constant<is_contiguous_range<const R &>::value && Detail::is_simd_type<T>::value>{});
+}
+
+/* C++17 reductions and scans:
+ * - reduce (r[, init[, op]]), transform_reduce (r, init, reduce_op, transform_op)
+ * - inclusive_scan (r, out[, op[, init]]) and exclusive_scan (r, out, init[, op]), writing prefix
+ *   results to out, and returning the end of the output. out can be begin (r) (in place scan).
+ * op must be associative: operations are grouped in unspecified order.
+ *
+ * Implementation selection:
+ * - contiguous ranges of arithmetic values combined with std::plus into the same type use the
+ *   SIMD sum and prefix sum kernels of duck/simd.h. Integers wrap around on overflow.
+ * - ranges with a push method (filter / map chains, see duck::push_each) run as one fused loop.
+ * - others use an iterator loop.
+ */
+namespace internal_range {
+	template <typename R> using numeric_value_t = iterator_value_type_t<range_iterator_t<const R &>>;
+
+	template <typename BinaryOperation, typename T> struct is_plus : std::false_type {};
+	template <typename T> struct is_plus<std::plus<>, T> : std::true_type {};
+	template <typename T> struct is_plus<std::plus<T>, T> : std::true_type {};
+
+	template <typename R, typename T, typename BinaryOperation>
+	using is_simd_sum =
+	    bool_constant<is_contiguous_range<const R &>::value && Detail::is_simd_type<T>::value &&
+	                  std::is_same<numeric_value_t<R>, T>::value &&
+	                  is_plus<BinaryOperation, T>::value>;
+
+	// f (v) for each element v of r, with a fused loop if r has a push method
+	template <typename R, typename F> void each_value (const R & r, F & f, std::true_type /*push*/) {
+		push_each (r, [&f](auto && v) {
+			f (std::forward<decltype (v)> (v));
+			return true;
+		});
+	}
+	template <typename R, typename F> void each_value (const R & r, F & f, std::false_type) {
+		for (auto && v : r)
+			f (std::forward<decltype (v)> (v));
+	}
+	template <typename R, typename F> void each_value (const R & r, F f) {
+		each_value (r, f, has_push_method<const R &>{});
+	}
+
+	template <typename R> std::size_t numeric_size (const R & r) {
+		return static_cast<std::size_t> (size (r));
+	}
+
+	template <typename R, typename T, typename BinaryOperation>
+	T reduce_impl (const R & r, T init, BinaryOperation &, std::true_type /*simd*/) {
+		return Detail::wrapping_add (init, Detail::simd_sum (duck::data (r), numeric_size (r)));
+	}
+	template <typename R, typename T, typename BinaryOperation>
+	T reduce_impl (const R & r, T init, BinaryOperation & op, std::false_type) {
+		return accumulate_impl (r, std::move (init), op, has_push_method<const R &>{});
+	}
+
+	// SIMD scans to any output iterator: pointers are written directly, others through a buffer.
+	template <typename T> T * simd_inclusive_scan_to (const T * in, std::size_t n, T * out, T init) {
+		Detail::simd_inclusive_scan (in, out, n, init);
+		return out + n;
+	}
+	template <typename T, typename OutputIt>
+	OutputIt simd_inclusive_scan_to (const T * in, std::size_t n, OutputIt out, T init) {
+		constexpr std::size_t block = 256;
+		T buffer[block];
+		for (std::size_t i = 0; i < n; i += block) {
+			auto len = std::min (block, n - i);
+			Detail::simd_inclusive_scan (in + i, buffer, len, init);
+			init = buffer[len - 1];
+			out = std::copy (buffer, buffer + len, out);
+		}
+		return out;
+	}
+	template <typename T> T * simd_exclusive_scan_to (const T * in, std::size_t n, T * out, T init) {
+		Detail::simd_exclusive_scan (in, out, n, init);
+		return out + n;
+	}
+	template <typename T, typename OutputIt>
+	OutputIt simd_exclusive_scan_to (const T * in, std::size_t n, OutputIt out, T init) {
+		constexpr std::size_t block = 256;
+		T buffer[block];
+		for (std::size_t i = 0; i < n; i += block) {
+			auto len = std::min (block, n - i);
+			Detail::simd_exclusive_scan (in + i, buffer, len, init);
+			init = Detail::wrapping_add (buffer[len - 1], in[i + len - 1]); // Before in place writes
+			out = std::copy (buffer, buffer + len, out);
+		}
+		return out;
+	}
+
+	template <typename R, typename OutputIt, typename BinaryOperation, typename T>
+	OutputIt inclusive_scan_impl (const R & r, OutputIt out, BinaryOperation &, T init,
+	                              std::true_type /*simd*/) {
+		return simd_inclusive_scan_to (duck::data (r), numeric_size (r), out, init);
+	}
+	template <typename R, typename OutputIt, typename BinaryOperation, typename T>
+	OutputIt inclusive_scan_impl (const R & r, OutputIt out, BinaryOperation & op, T init,
+	                              std::false_type) {
+		each_value (r, [&out, &op, &init](auto && v) {
+			init = op (std::move (init), std::forward<decltype (v)> (v));
+			*out = init;
+			++out;
+		});
+		return out;
+	}
+	// Without init: the first element starts the sums
+	template <typename R, typename OutputIt, typename BinaryOperation>
+	OutputIt inclusive_scan_impl (const R & r, OutputIt out, BinaryOperation &,
+	                              std::true_type /*simd*/) {
+		auto n = numeric_size (r);
+		if (n == 0)
+			return out;
+		auto in = duck::data (r);
+		auto first = in[0];
+		*out = first;
+		++out;
+		return simd_inclusive_scan_to (in + 1, n - 1, out, first);
+	}
+	template <typename R, typename OutputIt, typename BinaryOperation>
+	OutputIt inclusive_scan_impl (const R & r, OutputIt out, BinaryOperation & op, std::false_type) {
+		Optional<numeric_value_t<R>> sum;
+		each_value (r, [&out, &op, &sum](auto && v) {
+			if (sum)
+				sum = op (std::move (*sum), std::forward<decltype (v)> (v));
+			else
+				sum = std::forward<decltype (v)> (v);
+			*out = *sum;
+			++out;
+		});
+		return out;
+	}
+
+	template <typename R, typename OutputIt, typename T, typename BinaryOperation>
+	OutputIt exclusive_scan_impl (const R & r, OutputIt out, T init, BinaryOperation &,
+	                              std::true_type /*simd*/) {
+		return simd_exclusive_scan_to (duck::data (r), numeric_size (r), out, init);
+	}
+	template <typename R, typename OutputIt, typename T, typename BinaryOperation>
+	OutputIt exclusive_scan_impl (const R & r, OutputIt out, T init, BinaryOperation & op,
+	                              std::false_type) {
+		each_value (r, [&out, &op, &init](auto && v) {
+			auto next = op (init, std::forward<decltype (v)> (v)); // Before in place writes
+			*out = std::move (init);
+			++out;
+			init = std::move (next);
+		});
+		return out;
+	}
+} // namespace internal_range
+
+template <typename R, typename T, typename BinaryOperation,
+          typename = enable_if_t<is_range<const R &>::value>>
+T reduce (const R & r, T init, BinaryOperation op) {
+	return internal_range::reduce_impl (r, std::move (init), op,
+	                                    internal_range::is_simd_sum<R, T, BinaryOperation>{});
+}
+template <typename R, typename T, typename = enable_if_t<is_range<const R &>::value>>
+T reduce (const R & r, T init) {
+	return duck::reduce (r, std::move (init), std::plus<>{});
+}
+template <typename R, typename = enable_if_t<is_range<const R &>::value>>
+internal_range::numeric_value_t<R> reduce (const R & r) {
+	return duck::reduce (r, internal_range::numeric_value_t<R>{});
+}
+
+template <typename R, typename T, typename BinaryOperation, typename UnaryOperation,
+          typename = enable_if_t<is_range<const R &>::value>>
+T transform_reduce (const R & r, T init, BinaryOperation reduce_op,
+                    UnaryOperation transform_op) {
+	return duck::accumulate (r, std::move (init), [&reduce_op, &transform_op](T acc, auto && v) {
+		return reduce_op (std::move (acc), transform_op (std::forward<decltype (v)> (v)));
+	});
+}
+
+template <typename R, typename OutputIt, typename BinaryOperation, typename T,
+          typename = enable_if_t<is_range<const R &>::value>>
+OutputIt inclusive_scan (const R & r, OutputIt out, BinaryOperation op, T init) {
+	return internal_range::inclusive_scan_impl (
+	    r, out, op, std::move (init), internal_range::is_simd_sum<R, T, BinaryOperation>{});
+}
+template <typename R, typename OutputIt, typename BinaryOperation,
+          typename = enable_if_t<is_range<const R &>::value>>
+OutputIt inclusive_scan (const R & r, OutputIt out, BinaryOperation op) {
+	using T = internal_range::numeric_value_t<R>;
+	return internal_range::inclusive_scan_impl (
+	    r, out, op, internal_range::is_simd_sum<R, T, BinaryOperation>{});
+}
+template <typename R, typename OutputIt, typename = enable_if_t<is_range<const R &>::value>>
+OutputIt inclusive_scan (const R & r, OutputIt out) {
+	return duck::inclusive_scan (r, out, std::plus<>{});
+}
+
+template <typename R, typename OutputIt, typename T, typename BinaryOperation,
+          typename = enable_if_t<is_range<const R &>::value>>
+OutputIt exclusive_scan (const R & r, OutputIt out, T init, BinaryOperation op) {
+	return internal_range::exclusive_scan_impl (
+	    r, out, std::move (init), op, internal_range::is_simd_sum<R, T, BinaryOperation>{});
+}
+template <typename R, typename OutputIt, typename T,
+          typename = enable_if_t<is_range<const R &>::value>>
+OutputIt exclusive_scan (const R & r, OutputIt out, T init) {
+	return duck::exclusive_scan (r, out, std::move (init), std::plus<>{});
+}
+} // namespace duck
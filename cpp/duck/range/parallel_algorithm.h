@@ -0,0 +1,325 @@
+#pragma once
+
+// Parallel overloads of duck/range/algorithm.h functions, taking an execution policy first.
+// STATUS: prototype
+
+#include <algorithm>
+#include <atomic>
+#include <duck/execution.h>
+#include <duck/range/algorithm.h>
+#include <duck/thread_pool.h>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace duck {
+
+/* Execution policies: duck::par (), duck::par_unseq () (see duck/execution.h).
+ * Random access ranges (including slice, reverse, indexed and map combinators on random access
+ * ranges) are split in chunks processed on the policy thread pool.
+ * Searches (find, any_of, all_of, none_of, mismatch, equal) stop early once a match is known.
+ * Other ranges are processed serially.
+ * Functions and predicates are called concurrently and must be safe to call from many threads.
+ */
+namespace internal_range {
+	template <typename It, typename UnaryPredicate>
+	It find_if_impl (const parallel_policy & policy, It first, It last, UnaryPredicate p,
+	                 std::random_access_iterator_tag) {
+		auto n = static_cast<std::size_t> (last - first);
+		auto index = Detail::parallel_find_index (policy, n, [first, &p](std::size_t from,
+		                                                                 std::size_t to) {
+			auto block_first = first + from;
+			return from + static_cast<std::size_t> (std::find_if (block_first, first + to, p) -
+			                                        block_first);
+		});
+		return first + index;
+	}
+	template <typename It, typename UnaryPredicate>
+	It find_if_impl (const parallel_policy &, It first, It last, UnaryPredicate p,
+	                 std::input_iterator_tag) {
+		return std::find_if (first, last, p);
+	}
+	template <typename It, typename UnaryPredicate>
+	It find_if_impl (const parallel_policy & policy, It first, It last, UnaryPredicate p) {
+		return find_if_impl (policy, first, last, p, iterator_category_t<It>{});
+	}
+
+	template <typename It, typename UnaryFunction>
+	void for_each_impl (const parallel_policy & policy, It first, It last, UnaryFunction f,
+	                    std::random_access_iterator_tag) {
+		auto n = static_cast<std::size_t> (last - first);
+		Detail::parallel_chunks (policy, n, [first, &f](std::size_t from, std::size_t to) {
+			std::for_each (first + from, first + to, f);
+		});
+	}
+	template <typename It, typename UnaryFunction>
+	void for_each_impl (const parallel_policy &, It first, It last, UnaryFunction f,
+	                    std::input_iterator_tag) {
+		std::for_each (first, last, f);
+	}
+
+	template <typename It, typename UnaryPredicate>
+	iterator_difference_t<It> count_if_impl (const parallel_policy & policy, It first, It last,
+	                                         UnaryPredicate p, std::random_access_iterator_tag) {
+		auto n = static_cast<std::size_t> (last - first);
+		std::atomic<iterator_difference_t<It>> total{0};
+		Detail::parallel_chunks (policy, n, [first, &p, &total](std::size_t from, std::size_t to) {
+			total.fetch_add (std::count_if (first + from, first + to, p), std::memory_order_relaxed);
+		});
+		return total.load ();
+	}
+	template <typename It, typename UnaryPredicate>
+	iterator_difference_t<It> count_if_impl (const parallel_policy &, It first, It last,
+	                                         UnaryPredicate p, std::input_iterator_tag) {
+		return std::count_if (first, last, p);
+	}
+
+	template <typename It1, typename It2, typename BinaryPredicate>
+	std::pair<It1, It2> mismatch_impl (const parallel_policy & policy, It1 first, It1 last,
+	                                   It2 first2, BinaryPredicate p,
+	                                   std::random_access_iterator_tag) {
+		auto n = static_cast<std::size_t> (last - first);
+		auto index = Detail::parallel_find_index (
+		    policy, n, [first, first2, &p](std::size_t from, std::size_t to) {
+			    auto block_first = first + from;
+			    auto r = std::mismatch (block_first, first + to, first2 + from, p);
+			    return from + static_cast<std::size_t> (r.first - block_first);
+		    });
+		return {first + index, first2 + index};
+	}
+	template <typename It1, typename It2, typename BinaryPredicate>
+	std::pair<It1, It2> mismatch_impl (const parallel_policy &, It1 first, It1 last, It2 first2,
+	                                   BinaryPredicate p, std::input_iterator_tag) {
+		return std::mismatch (first, last, first2, p);
+	}
+	template <typename It1, typename It2, typename BinaryPredicate>
+	std::pair<It1, It2> mismatch_impl (const parallel_policy & policy, It1 first, It1 last,
+	                                   It2 first2, BinaryPredicate p) {
+		using Category = common_type_t<iterator_category_t<It1>, iterator_category_t<It2>>;
+		return mismatch_impl (policy, first, last, first2, p, Category{});
+	}
+
+	struct equal_to {
+		template <typename T, typename U> bool operator() (const T & t, const U & u) const {
+			return t == u;
+		}
+	};
+} // namespace internal_range
+
+template <typename Policy, typename R, typename UnaryPredicate,
+          typename = enable_if_t<is_execution_policy<Policy>::value && is_range<const R &>::value>>
+bool all_of (const Policy & policy, const R & r, UnaryPredicate p) {
+	return internal_range::find_if_impl (policy, begin (r), end (r),
+	                                     [&p](iterator_reference_t<range_iterator_t<const R>> v) {
+		                                     return !p (v);
+	                                     }) == end (r);
+}
+template <typename Policy, typename R, typename UnaryPredicate,
+          typename = enable_if_t<is_execution_policy<Policy>::value && is_range<const R &>::value>>
+bool none_of (const Policy & policy, const R & r, UnaryPredicate p) {
+	return internal_range::find_if_impl (policy, begin (r), end (r), p) == end (r);
+}
+template <typename Policy, typename R, typename UnaryPredicate,
+          typename = enable_if_t<is_execution_policy<Policy>::value && is_range<const R &>::value>>
+bool any_of (const Policy & policy, const R & r, UnaryPredicate p) {
+	return internal_range::find_if_impl (policy, begin (r), end (r), p) != end (r);
+}
+
+template <typename Policy, typename R, typename UnaryFunction,
+          typename = enable_if_t<is_execution_policy<Policy>::value && is_range<const R &>::value>>
+void for_each (const Policy & policy, const R & r, UnaryFunction f) {
+	internal_range::for_each_impl (policy, begin (r), end (r), f,
+	                               iterator_category_t<range_iterator_t<const R>>{});
+}
+
+template <typename Policy, typename R, typename T,
+          typename = enable_if_t<is_execution_policy<Policy>::value && is_range<const R &>::value>>
+iterator_difference_t<range_iterator_t<const R>> count (const Policy & policy, const R & r,
+                                                        const T & value) {
+	return internal_range::count_if_impl (
+	    policy, begin (r), end (r),
+	    [&value](iterator_reference_t<range_iterator_t<const R>> v) { return v == value; },
+	    iterator_category_t<range_iterator_t<const R>>{});
+}
+template <typename Policy, typename R, typename UnaryPredicate,
+          typename = enable_if_t<is_execution_policy<Policy>::value && is_range<const R &>::value>>
+iterator_difference_t<range_iterator_t<const R>> count_if (const Policy & policy, const R & r,
+                                                           UnaryPredicate p) {
+	return internal_range::count_if_impl (policy, begin (r), end (r), p,
+	                                      iterator_category_t<range_iterator_t<const R>>{});
+}
+
+/* mismatch and equal are constrained in the return type: a default template argument would make
+ * (policy, range, iterator) the same template as the serial (range, range, predicate).
+ */
+template <typename Policy, typename R, typename InputIt>
+enable_if_t<is_execution_policy<Policy>::value && is_range<const R &>::value,
+            std::pair<range_iterator_t<const R>, InputIt>>
+mismatch (const Policy & policy, const R & r, InputIt it) {
+	return internal_range::mismatch_impl (policy, begin (r), end (r), it,
+	                                      internal_range::equal_to{});
+}
+template <typename Policy, typename R, typename InputIt, typename BinaryPredicate>
+enable_if_t<is_execution_policy<Policy>::value && is_range<const R &>::value,
+            std::pair<range_iterator_t<const R>, InputIt>>
+mismatch (const Policy & policy, const R & r, InputIt it, BinaryPredicate p) {
+	return internal_range::mismatch_impl (policy, begin (r), end (r), it, p);
+}
+
+template <typename Policy, typename R, typename InputIt>
+enable_if_t<is_execution_policy<Policy>::value && is_range<const R &>::value, bool>
+equal (const Policy & policy, const R & r, InputIt it) {
+	return duck::mismatch (policy, r, it).first == end (r);
+}
+template <typename Policy, typename R, typename InputIt, typename BinaryPredicate>
+enable_if_t<is_execution_policy<Policy>::value && is_range<const R &>::value, bool>
+equal (const Policy & policy, const R & r, InputIt it, BinaryPredicate p) {
+	return duck::mismatch (policy, r, it, p).first == end (r);
+}
+
+template <typename Policy, typename R, typename T,
+          typename = enable_if_t<is_execution_policy<Policy>::value && is_range<const R &>::value>>
+range_iterator_t<const R> find (const Policy & policy, const R & r, const T & value) {
+	return internal_range::find_if_impl (
+	    policy, begin (r), end (r),
+	    [&value](iterator_reference_t<range_iterator_t<const R>> v) { return v == value; });
+}
+template <typename Policy, typename R, typename UnaryPredicate,
+          typename = enable_if_t<is_execution_policy<Policy>::value && is_range<const R &>::value>>
+range_iterator_t<const R> find_if (const Policy & policy, const R & r, UnaryPredicate p) {
+	return internal_range::find_if_impl (policy, begin (r), end (r), p);
+}
+template <typename Policy, typename R, typename UnaryPredicate,
+          typename = enable_if_t<is_execution_policy<Policy>::value && is_range<const R &>::value>>
+range_iterator_t<const R> find_if_not (const Policy & policy, const R & r, UnaryPredicate p) {
+	return internal_range::find_if_impl (policy, begin (r), end (r),
+	                                     [&p](iterator_reference_t<range_iterator_t<const R>> v) {
+		                                     return !p (v);
+	                                     });
+}
+
+// sorting operations
+
+/* Parallel sort (policy, r[, comp]) and stable_sort (policy, r[, comp]): merge sort on the policy
+ * thread pool, for random access ranges (others are sorted serially).
+ * Halves are sorted recursively in parallel (TaskGroup) down to blocks of grain elements, which are
+ * sorted with std::sort / std::stable_sort. Merges are parallel too: the larger input is split in
+ * its middle, and the other one at the matching position (binary search).
+ * Merges ping-pong between the range and a buffer of n values (values must be movable, not
+ * necessarily default constructible).
+ */
+namespace internal_range {
+	template <typename It1, typename It2, typename OutputIt, typename Compare>
+	void parallel_merge (ThreadPool & pool, std::size_t grain, It1 first1, It1 last1, It2 first2,
+	                     It2 last2, OutputIt out, Compare & comp) {
+		auto n1 = static_cast<std::size_t> (last1 - first1);
+		auto n2 = static_cast<std::size_t> (last2 - first2);
+		if (n1 + n2 <= std::max<std::size_t> (grain, 2) || n1 == 0 || n2 == 0) {
+			std::merge (std::make_move_iterator (first1), std::make_move_iterator (last1),
+			            std::make_move_iterator (first2), std::make_move_iterator (last2), out, comp);
+			return;
+		}
+		// Equal values from the first input must stay before those from the second (stability).
+		It1 mid1;
+		It2 mid2;
+		if (n1 >= n2) {
+			mid1 = first1 + static_cast<iterator_difference_t<It1>> (n1 / 2);
+			mid2 = std::lower_bound (first2, last2, *mid1, comp);
+		} else {
+			mid2 = first2 + static_cast<iterator_difference_t<It2>> (n2 / 2);
+			mid1 = std::upper_bound (first1, last1, *mid2, comp);
+		}
+		auto out_mid = out + static_cast<iterator_difference_t<OutputIt>> ((mid1 - first1) +
+		                                                                    (mid2 - first2));
+		TaskGroup group (pool);
+		group.spawn ([&] { parallel_merge (pool, grain, first1, mid1, first2, mid2, out, comp); });
+		parallel_merge (pool, grain, mid1, last1, mid2, last2, out_mid, comp);
+		group.wait ();
+	}
+
+	/* Sort [first, first + n), with the result in first (to_scratch = false) or scratch.
+	 * scratch [0, n) holds values (possibly moved-from) that are overwritten.
+	 */
+	template <bool Stable, typename It, typename ScratchIt, typename Compare>
+	void parallel_merge_sort (ThreadPool & pool, std::size_t grain, It first, ScratchIt scratch,
+	                          std::size_t n, bool to_scratch, Compare & comp) {
+		auto last = first + static_cast<iterator_difference_t<It>> (n);
+		if (n <= grain) {
+			if (Stable)
+				std::stable_sort (first, last, comp);
+			else
+				std::sort (first, last, comp);
+			if (to_scratch)
+				std::move (first, last, scratch);
+			return;
+		}
+		auto half = n / 2;
+		auto mid = first + static_cast<iterator_difference_t<It>> (half);
+		auto scratch_mid = scratch + static_cast<iterator_difference_t<ScratchIt>> (half);
+		auto scratch_last = scratch + static_cast<iterator_difference_t<ScratchIt>> (n);
+		{
+			// Halves end in the other storage, to be merged into the requested one
+			TaskGroup group (pool);
+			group.spawn ([&] {
+				parallel_merge_sort<Stable> (pool, grain, first, scratch, half, !to_scratch, comp);
+			});
+			parallel_merge_sort<Stable> (pool, grain, mid, scratch_mid, n - half, !to_scratch, comp);
+			group.wait ();
+		}
+		if (to_scratch)
+			parallel_merge (pool, grain, first, mid, mid, last, scratch, comp);
+		else
+			parallel_merge (pool, grain, scratch, scratch_mid, scratch_mid, scratch_last, first, comp);
+	}
+
+	template <bool Stable, typename It, typename Compare>
+	void sort_impl (const parallel_policy & policy, It first, It last, Compare comp,
+	                std::random_access_iterator_tag) {
+		auto n = static_cast<std::size_t> (last - first);
+		auto & pool = policy.pool ();
+		if (n <= policy.grain ()) {
+			if (Stable)
+				std::stable_sort (first, last, comp);
+			else
+				std::sort (first, last, comp);
+			return;
+		}
+		// Values are moved to the buffer and sorted there, with the range as scratch space.
+		std::vector<iterator_value_type_t<It>> buffer (std::make_move_iterator (first),
+		                                               std::make_move_iterator (last));
+		parallel_merge_sort<Stable> (pool, policy.grain (), buffer.begin (), first, n, true, comp);
+	}
+	template <bool Stable, typename It, typename Compare>
+	void sort_impl (const parallel_policy &, It first, It last, Compare comp,
+	                std::input_iterator_tag) {
+		if (Stable)
+			std::stable_sort (first, last, comp);
+		else
+			std::sort (first, last, comp);
+	}
+} // namespace internal_range
+
+template <typename Policy, typename R, typename Compare,
+          typename = enable_if_t<is_execution_policy<Policy>::value && is_range<R>::value>>
+void sort (const Policy & policy, R && r, Compare comp) {
+	internal_range::sort_impl<false> (policy, begin (r), end (r), comp,
+	                                  iterator_category_t<range_iterator_t<R>>{});
+}
+template <typename Policy, typename R,
+          typename = enable_if_t<is_execution_policy<Policy>::value && is_range<R>::value>>
+void sort (const Policy & policy, R && r) {
+	sort (policy, r, std::less<iterator_value_type_t<range_iterator_t<R>>>{});
+}
+template <typename Policy, typename R, typename Compare,
+          typename = enable_if_t<is_execution_policy<Policy>::value && is_range<R>::value>>
+void stable_sort (const Policy & policy, R && r, Compare comp) {
+	internal_range::sort_impl<true> (policy, begin (r), end (r), comp,
+	                                 iterator_category_t<range_iterator_t<R>>{});
+}
+template <typename Policy, typename R,
+          typename = enable_if_t<is_execution_policy<Policy>::value && is_range<R>::value>>
+void stable_sort (const Policy & policy, R && r) {
+	stable_sort (policy, r, std::less<iterator_value_type_t<range_iterator_t<R>>>{});
+}
+} // namespace duck
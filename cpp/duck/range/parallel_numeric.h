@@ -0,0 +1,290 @@
+#pragma once
+
+// Parallel overloads of duck/range/numeric.h functions, taking an execution policy first.
+// STATUS: prototype
+
+#include <duck/execution.h>
+#include <duck/range/numeric.h>
+#include <duck/simd.h>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace duck {
+
+/* Execution policies: duck::par (), duck::par_unseq () (see duck/execution.h).
+ * Random access ranges (and output iterators for scans) are split in blocks of the policy grain,
+ * processed on the policy thread pool in two passes:
+ * - each block is reduced (SIMD sum if possible), then block results are combined in order ;
+ * - scans: block results give the initial value of each block, and blocks are scanned in parallel.
+ * Other ranges are processed serially. Results of float sums depend on the number of blocks.
+ */
+namespace internal_range {
+	template <typename R, typename OutputIt = range_iterator_t<const R &>>
+	using is_parallel_numeric = bool_constant<
+	    std::is_base_of<std::random_access_iterator_tag,
+	                    iterator_category_t<range_iterator_t<const R &>>>::value &&
+	    std::is_base_of<std::random_access_iterator_tag, iterator_category_t<OutputIt>>::value>;
+
+	// Reduction of non empty blocks [from, to) of r, without initial value
+	template <typename R, typename T, typename BinaryOperation>
+	T reduce_block (const R & r, std::size_t from, std::size_t to, BinaryOperation &,
+	                std::true_type /*simd*/) {
+		return Detail::simd_sum (duck::data (r) + from, to - from);
+	}
+	template <typename R, typename T, typename BinaryOperation>
+	T reduce_block (const R & r, std::size_t from, std::size_t to, BinaryOperation & op,
+	                std::false_type) {
+		auto first = begin (r);
+		T acc = first[from];
+		for (auto i = from + 1; i < to; ++i)
+			acc = op (std::move (acc), first[i]);
+		return acc;
+	}
+
+	// Two passes: reduce_block (from, to) for each block, combined with init in block order.
+	template <typename T, typename BinaryOperation, typename ReduceBlock>
+	T parallel_reduce (const parallel_policy & policy, std::size_t n, T init, BinaryOperation & op,
+	                   ReduceBlock reduce_block) {
+		auto block_size = Detail::parallel_block_size (policy, n);
+		std::vector<T> partials (Detail::parallel_nb_blocks (n, block_size), init);
+		Detail::parallel_blocks (policy, n, block_size,
+		                         [&partials, &reduce_block](std::size_t b, std::size_t from,
+		                                                    std::size_t to) {
+			                         partials[b] = reduce_block (from, to);
+		                         });
+		for (auto & partial : partials)
+			init = op (std::move (init), std::move (partial));
+		return init;
+	}
+
+	/* Scan in two passes: block sums (except the last block), then block offsets (exclusive scan
+	 * of block sums from init), then scan_block (from, to, offset) for each block.
+	 */
+	template <typename T, typename BinaryOperation, typename ReduceBlock, typename ScanBlock>
+	void parallel_scan (const parallel_policy & policy, std::size_t n, T init, BinaryOperation & op,
+	                    ReduceBlock reduce_block, ScanBlock scan_block) {
+		auto block_size = Detail::parallel_block_size (policy, n);
+		auto nb_blocks = Detail::parallel_nb_blocks (n, block_size);
+		if (nb_blocks <= 1) {
+			scan_block (std::size_t (0), n, std::move (init));
+			return;
+		}
+		std::vector<T> offsets (nb_blocks, init);
+		Detail::parallel_blocks (policy, (nb_blocks - 1) * block_size, block_size,
+		                         [&offsets, &reduce_block](std::size_t b, std::size_t from,
+		                                                   std::size_t to) {
+			                         offsets[b] = reduce_block (from, to);
+		                         });
+		for (std::size_t b = 0; b + 1 < nb_blocks; ++b) {
+			auto block_sum = std::move (offsets[b]);
+			offsets[b] = init;
+			init = op (std::move (init), std::move (block_sum));
+		}
+		offsets[nb_blocks - 1] = std::move (init);
+		Detail::parallel_blocks (
+		    policy, n, block_size,
+		    [&offsets, &scan_block](std::size_t b, std::size_t from, std::size_t to) {
+			    scan_block (from, to, std::move (offsets[b]));
+		    });
+	}
+
+	template <typename R, typename T, typename BinaryOperation>
+	T reduce_impl (const parallel_policy & policy, const R & r, T init, BinaryOperation & op,
+	               std::true_type /*parallel*/) {
+		using Simd = is_simd_sum<R, T, BinaryOperation>;
+		return parallel_reduce (policy, numeric_size (r), std::move (init), op,
+		                        [&r, &op](std::size_t from, std::size_t to) {
+			                        return reduce_block<R, T> (r, from, to, op, Simd{});
+		                        });
+	}
+	template <typename R, typename T, typename BinaryOperation>
+	T reduce_impl (const parallel_policy &, const R & r, T init, BinaryOperation & op,
+	               std::false_type) {
+		return duck::reduce (r, std::move (init), op);
+	}
+
+	template <typename R, typename T, typename BinaryOperation, typename UnaryOperation>
+	T transform_reduce_impl (const parallel_policy & policy, const R & r, T init,
+	                         BinaryOperation & reduce_op, UnaryOperation & transform_op,
+	                         std::true_type /*parallel*/) {
+		auto first = begin (r);
+		return parallel_reduce (
+		    policy, numeric_size (r), std::move (init), reduce_op,
+		    [first, &reduce_op, &transform_op](std::size_t from, std::size_t to) {
+			    T acc = transform_op (first[from]);
+			    for (auto i = from + 1; i < to; ++i)
+				    acc = reduce_op (std::move (acc), transform_op (first[i]));
+			    return acc;
+		    });
+	}
+	template <typename R, typename T, typename BinaryOperation, typename UnaryOperation>
+	T transform_reduce_impl (const parallel_policy &, const R & r, T init,
+	                         BinaryOperation & reduce_op, UnaryOperation & transform_op,
+	                         std::false_type) {
+		return duck::transform_reduce (r, std::move (init), reduce_op, transform_op);
+	}
+
+	// Scans of blocks [from, to) of r to out, starting from offset
+	template <typename R, typename OutputIt, typename T, typename BinaryOperation>
+	void inclusive_scan_block (const R & r, std::size_t from, std::size_t to, OutputIt out,
+	                           T offset, BinaryOperation &, std::true_type /*simd*/) {
+		simd_inclusive_scan_to (duck::data (r) + from, to - from, out, offset);
+	}
+	template <typename R, typename OutputIt, typename T, typename BinaryOperation>
+	void inclusive_scan_block (const R & r, std::size_t from, std::size_t to, OutputIt out,
+	                           T offset, BinaryOperation & op, std::false_type) {
+		auto first = begin (r);
+		for (auto i = from; i < to; ++i, ++out) {
+			offset = op (std::move (offset), first[i]);
+			*out = offset;
+		}
+	}
+	template <typename R, typename OutputIt, typename T, typename BinaryOperation>
+	void exclusive_scan_block (const R & r, std::size_t from, std::size_t to, OutputIt out,
+	                           T offset, BinaryOperation &, std::true_type /*simd*/) {
+		simd_exclusive_scan_to (duck::data (r) + from, to - from, out, offset);
+	}
+	template <typename R, typename OutputIt, typename T, typename BinaryOperation>
+	void exclusive_scan_block (const R & r, std::size_t from, std::size_t to, OutputIt out,
+	                           T offset, BinaryOperation & op, std::false_type) {
+		auto first = begin (r);
+		for (auto i = from; i < to; ++i, ++out) {
+			auto next = op (offset, first[i]);
+			*out = std::move (offset);
+			offset = std::move (next);
+		}
+	}
+
+	// Inclusive scan of r [start, n) to out [start, n)
+	template <typename R, typename OutputIt, typename BinaryOperation, typename T>
+	OutputIt inclusive_scan_impl (const parallel_policy & policy, const R & r, std::size_t start,
+	                              OutputIt out, BinaryOperation & op, T init,
+	                              std::true_type /*parallel*/) {
+		using Simd = is_simd_sum<R, T, BinaryOperation>;
+		auto n = numeric_size (r);
+		parallel_scan (
+		    policy, n - start, std::move (init), op,
+		    [&r, start, &op](std::size_t from, std::size_t to) {
+			    return reduce_block<R, T> (r, start + from, start + to, op, Simd{});
+		    },
+		    [&r, start, out, &op](std::size_t from, std::size_t to, T offset) {
+			    auto block_out = out + static_cast<iterator_difference_t<OutputIt>> (start + from);
+			    inclusive_scan_block (r, start + from, start + to, block_out, std::move (offset), op,
+			                          Simd{});
+		    });
+		return out + static_cast<iterator_difference_t<OutputIt>> (n);
+	}
+
+	template <typename R, typename OutputIt, typename T, typename BinaryOperation>
+	OutputIt exclusive_scan_impl (const parallel_policy & policy, const R & r, OutputIt out,
+	                              T init, BinaryOperation & op, std::true_type /*parallel*/) {
+		using Simd = is_simd_sum<R, T, BinaryOperation>;
+		auto n = numeric_size (r);
+		parallel_scan (
+		    policy, n, std::move (init), op,
+		    [&r, &op](std::size_t from, std::size_t to) {
+			    return reduce_block<R, T> (r, from, to, op, Simd{});
+		    },
+		    [&r, out, &op](std::size_t from, std::size_t to, T offset) {
+			    auto block_out = out + static_cast<iterator_difference_t<OutputIt>> (from);
+			    exclusive_scan_block (r, from, to, block_out, std::move (offset), op, Simd{});
+		    });
+		return out + static_cast<iterator_difference_t<OutputIt>> (n);
+	}
+	template <typename R, typename OutputIt, typename T, typename BinaryOperation>
+	OutputIt exclusive_scan_impl (const parallel_policy &, const R & r, OutputIt out, T init,
+	                              BinaryOperation & op, std::false_type) {
+		return duck::exclusive_scan (r, out, std::move (init), op);
+	}
+} // namespace internal_range
+
+template <typename Policy, typename R, typename T, typename BinaryOperation,
+          typename = enable_if_t<is_execution_policy<Policy>::value && is_range<const R &>::value>>
+T reduce (const Policy & policy, const R & r, T init, BinaryOperation op) {
+	return internal_range::reduce_impl (policy, r, std::move (init), op,
+	                                    internal_range::is_parallel_numeric<R>{});
+}
+template <typename Policy, typename R, typename T,
+          typename = enable_if_t<is_execution_policy<Policy>::value && is_range<const R &>::value>>
+T reduce (const Policy & policy, const R & r, T init) {
+	return duck::reduce (policy, r, std::move (init), std::plus<>{});
+}
+template <typename Policy, typename R,
+          typename = enable_if_t<is_execution_policy<Policy>::value && is_range<const R &>::value>>
+internal_range::numeric_value_t<R> reduce (const Policy & policy, const R & r) {
+	return duck::reduce (policy, r, internal_range::numeric_value_t<R>{});
+}
+
+template <typename Policy, typename R, typename T, typename BinaryOperation,
+          typename UnaryOperation,
+          typename = enable_if_t<is_execution_policy<Policy>::value && is_range<const R &>::value>>
+T transform_reduce (const Policy & policy, const R & r, T init, BinaryOperation reduce_op,
+                    UnaryOperation transform_op) {
+	return internal_range::transform_reduce_impl (policy, r, std::move (init), reduce_op,
+	                                              transform_op,
+	                                              internal_range::is_parallel_numeric<R>{});
+}
+
+namespace internal_range {
+	template <typename R, typename OutputIt, typename BinaryOperation, typename T>
+	OutputIt inclusive_scan_impl (const parallel_policy &, const R & r, OutputIt out,
+	                              BinaryOperation & op, T init, std::false_type) {
+		return duck::inclusive_scan (r, out, op, std::move (init));
+	}
+	template <typename R, typename OutputIt, typename BinaryOperation, typename T>
+	OutputIt inclusive_scan_impl (const parallel_policy & policy, const R & r, OutputIt out,
+	                              BinaryOperation & op, T init, std::true_type /*parallel*/) {
+		return inclusive_scan_impl (policy, r, 0, out, op, std::move (init), std::true_type{});
+	}
+	// Without init: the first element is the initial value of the rest
+	template <typename R, typename OutputIt, typename BinaryOperation>
+	OutputIt inclusive_scan_impl (const parallel_policy &, const R & r, OutputIt out,
+	                              BinaryOperation & op, std::false_type) {
+		return duck::inclusive_scan (r, out, op);
+	}
+	template <typename R, typename OutputIt, typename BinaryOperation>
+	OutputIt inclusive_scan_impl (const parallel_policy & policy, const R & r, OutputIt out,
+	                              BinaryOperation & op, std::true_type /*parallel*/) {
+		if (empty (r))
+			return out;
+		numeric_value_t<R> init = *begin (r);
+		*out = init;
+		return inclusive_scan_impl (policy, r, 1, out, op, std::move (init), std::true_type{});
+	}
+} // namespace internal_range
+
+template <typename Policy, typename R, typename OutputIt, typename BinaryOperation, typename T,
+          typename = enable_if_t<is_execution_policy<Policy>::value && is_range<const R &>::value>>
+OutputIt inclusive_scan (const Policy & policy, const R & r, OutputIt out, BinaryOperation op,
+                         T init) {
+	return internal_range::inclusive_scan_impl (policy, r, out, op, std::move (init),
+	                                            internal_range::is_parallel_numeric<R, OutputIt>{});
+}
+template <typename Policy, typename R, typename OutputIt, typename BinaryOperation,
+          typename = enable_if_t<is_execution_policy<Policy>::value && is_range<const R &>::value>>
+OutputIt inclusive_scan (const Policy & policy, const R & r, OutputIt out, BinaryOperation op) {
+	return internal_range::inclusive_scan_impl (policy, r, out, op,
+	                                            internal_range::is_parallel_numeric<R, OutputIt>{});
+}
+template <typename Policy, typename R, typename OutputIt,
+          typename = enable_if_t<is_execution_policy<Policy>::value && is_range<const R &>::value>>
+OutputIt inclusive_scan (const Policy & policy, const R & r, OutputIt out) {
+	return duck::inclusive_scan (policy, r, out, std::plus<>{});
+}
+
+template <typename Policy, typename R, typename OutputIt, typename T, typename BinaryOperation,
+          typename = enable_if_t<is_execution_policy<Policy>::value && is_range<const R &>::value>>
+OutputIt exclusive_scan (const Policy & policy, const R & r, OutputIt out, T init,
+                         BinaryOperation op) {
+	return internal_range::exclusive_scan_impl (policy, r, out, std::move (init), op,
+	                                            internal_range::is_parallel_numeric<R, OutputIt>{});
+}
+template <typename Policy, typename R, typename OutputIt, typename T,
+          typename = enable_if_t<is_execution_policy<Policy>::value && is_range<const R &>::value>>
+OutputIt exclusive_scan (const Policy & policy, const R & r, OutputIt out, T init) {
+	return duck::exclusive_scan (policy, r, out, std::move (init), std::plus<>{});
+}
+} // namespace duck
@@ -90,6 +90,12 @@ template <typename T, typename = void> struct has_size_method : std::false_type
 template <typename T>
 struct has_size_method<T, void_t<decltype (std::declval<T> ().size ())>> : std::true_type {};
 
+// Has data() method returning a pointer
+template <typename T, typename = void> struct has_data_method : std::false_type {};
+template <typename T>
+struct has_data_method<T, void_t<decltype (std::declval<T> ().data ())>>
+    : std::is_pointer<decltype (std::declval<T> ().data ())> {};
+
 /*********************************************************************************
  * ADL versions of begin / end.
  * Alternative to the "using std::begin; begin (t)" pattern, in one line.
@@ -133,6 +139,76 @@ template <typename T> iterator_difference_t<range_iterator_t<const T &>> size (c
 	return internal_range::size_impl (t, has_size_method<T>{});
 }
 
+/* Size hints: number of elements known without iterating, used to reserve storage.
+ * A range can define a "SizeHint size_hint () const" member ; combinators propagate hints.
+ * Otherwise the hint is exact for ranges with a size() method or random access iterators.
+ */
+struct SizeHint {
+	enum Kind { unknown, upper_bound, exact };
+	Kind kind;
+	std::ptrdiff_t value; // Number of elements (exact), or maximum number ; 0 if unknown
+
+	constexpr SizeHint () : kind (unknown), value (0) {}
+	constexpr SizeHint (Kind k, std::ptrdiff_t n) : kind (k), value (n) {}
+
+	// Hint for a range with at most as many elements (filter)
+	constexpr SizeHint at_most () const {
+		return kind == unknown ? *this : SizeHint{upper_bound, value};
+	}
+	// Apply f to the value of a known hint
+	template <typename F> SizeHint transform (F f) const {
+		return kind == unknown ? *this : SizeHint{kind, f (value)};
+	}
+};
+
+template <typename T, typename = void> struct has_size_hint_method : std::false_type {};
+template <typename T>
+struct has_size_hint_method<T, void_t<decltype (std::declval<T> ().size_hint ())>>
+    : std::is_same<decltype (std::declval<T> ().size_hint ()), SizeHint> {};
+
+namespace internal_range {
+	template <typename T> SizeHint size_hint_fallback (const T & t, std::true_type /*sized*/) {
+		return {SizeHint::exact, static_cast<std::ptrdiff_t> (size (t))};
+	}
+	template <typename T> SizeHint size_hint_fallback (const T &, std::false_type) { return {}; }
+
+	template <typename T> SizeHint size_hint_impl (const T & t, std::true_type /*method*/) {
+		return t.size_hint ();
+	}
+	template <typename T> SizeHint size_hint_impl (const T & t, std::false_type) {
+		using category = iterator_category_t<range_iterator_t<const T &>>;
+		return size_hint_fallback (
+		    t, bool_constant<has_size_method<const T &>::value ||
+		                     std::is_base_of<std::random_access_iterator_tag, category>::value>{});
+	}
+} // namespace internal_range
+template <typename T> SizeHint size_hint (const T & t) {
+	return internal_range::size_hint_impl (t, has_size_hint_method<const T &>{});
+}
+
+/* Contiguous ranges: elements are stored in an array.
+ * Iterators are pointers, or random access with a data() method (std::vector, span, SmallVector).
+ * data (t) returns a pointer to the first element.
+ */
+template <typename T>
+using is_contiguous_range = bool_constant<
+    std::is_pointer<range_iterator_t<T>>::value ||
+    (has_data_method<T>::value &&
+     std::is_base_of<std::random_access_iterator_tag,
+                     iterator_category_t<range_iterator_t<T>>>::value)>;
+
+template <typename T, typename = enable_if_t<has_data_method<T>::value>>
+auto data (T && t) -> decltype (t.data ()) {
+	return t.data ();
+}
+template <typename T,
+          typename = enable_if_t<!has_data_method<T>::value &&
+                                 std::is_pointer<range_iterator_t<T>>::value>,
+          typename = void>
+range_iterator_t<T> data (T && t) {
+	return begin (std::forward<T> (t));
+}
+
 // front / back
 template <typename T> iterator_reference_t<range_iterator_t<T>> front (T && t) {
 	return *begin (std::forward<T> (t));
@@ -159,9 +235,102 @@ range_iterator_t<T> at (T && t, iterator_difference_t<range_iterator_t<T>> n) {
 	return std::next (begin (std::forward<T> (t)), internal_range::normalize_index (t, n));
 }
 
+/*********************************************************************************
+ * Internal iteration (push).
+ * push_each (t, sink) calls sink (element) on each element in order, until sink returns false.
+ * Returns false if sink stopped the iteration early.
+ *
+ * A range can define a "template <typename Sink> bool push (Sink & sink) const" member.
+ * It is used instead of its iterators: combinator chains (filter, map) compose their sinks and
+ * run a single loop over the innermost range, without nested iterator states.
+ */
+namespace internal_range {
+	// Sink type only used to detect push methods
+	struct any_sink {
+		template <typename T> bool operator() (T &&) const { return true; }
+	};
+} // namespace internal_range
+
+template <typename T, typename = void> struct has_push_method : std::false_type {};
+template <typename T>
+struct has_push_method<
+    T, void_t<decltype (std::declval<T> ().push (std::declval<internal_range::any_sink &> ()))>>
+    : std::true_type {};
+
+namespace internal_range {
+	template <typename T, typename Sink>
+	bool push_each_impl (const T & t, Sink & sink, std::true_type) {
+		return t.push (sink);
+	}
+	template <typename T, typename Sink>
+	bool push_each_impl (const T & t, Sink & sink, std::false_type) {
+		for (auto && v : t)
+			if (!sink (std::forward<decltype (v)> (v)))
+				return false;
+		return true;
+	}
+} // namespace internal_range
+template <typename T, typename Sink> bool push_each (const T & t, Sink && sink) {
+	return internal_range::push_each_impl (t, sink, has_push_method<const T &>{});
+}
+
+/* Segmented ranges: ranges made of consecutive segments (inner ranges), like duck::join.
+ * A segmented range defines:
+ * - segments (): the range of segments ;
+ * - make_iterator (segment_it, it): its iterator pointing to *it, in the segment *segment_it.
+ * Algorithms of duck/range/algorithm.h run on each segment (tight loop, SIMD for contiguous
+ * segments) instead of checking segment boundaries at each increment.
+ */
+template <typename T, typename = void> struct is_segmented_range : std::false_type {};
+template <typename T>
+struct is_segmented_range<T, void_t<decltype (std::declval<T> ().segments ())>>
+    : std::true_type {};
+
 // to_container
+namespace internal_range {
+	template <typename C, typename = void> struct has_reserve_method : std::false_type {};
+	template <typename C>
+	struct has_reserve_method<C, void_t<decltype (std::declval<C &> ().reserve (0))>>
+	    : std::true_type {};
+
+	// Reserve exact sizes only: an upper bound (filter) may be much larger than the result.
+	template <typename Container, typename T>
+	void reserve_for (Container & c, const T & t, std::true_type) {
+		auto hint = size_hint (t);
+		if (hint.kind == SizeHint::exact)
+			c.reserve (static_cast<typename Container::size_type> (hint.value));
+	}
+	template <typename Container, typename T>
+	void reserve_for (Container &, const T &, std::false_type) {}
+
+	// c.insert (c.end (), v) (not for std::forward_list, std::array...)
+	template <typename C, typename V, typename = void> struct has_end_insert : std::false_type {};
+	template <typename C, typename V>
+	struct has_end_insert<C, V,
+	                      void_t<decltype (std::declval<C &> ().insert (std::declval<C &> ().end (),
+	                                                                    std::declval<V> ()))>>
+	    : std::true_type {};
+
+	template <typename Container, typename T>
+	Container to_container_impl (const T & t, std::false_type /*push*/) {
+		return Container{begin (t), end (t)};
+	}
+	template <typename Container, typename T>
+	Container to_container_impl (const T & t, std::true_type /*push*/) {
+		Container c;
+		reserve_for (c, t, has_reserve_method<Container>{});
+		push_each (t, [&c](auto && v) {
+			c.insert (c.end (), std::forward<decltype (v)> (v));
+			return true;
+		});
+		return c;
+	}
+} // namespace internal_range
 template <typename Container, typename T> Container to_container (const T & t) {
-	return Container{begin (t), end (t)};
+	using Value = iterator_reference_t<range_iterator_t<const T &>>;
+	using use_push = bool_constant<has_push_method<const T &>::value &&
+	                               internal_range::has_end_insert<Container, Value>::value>;
+	return internal_range::to_container_impl<Container> (t, use_push{});
 }
 
 // contains
@@ -0,0 +1,513 @@
+#pragma once
+
+// SIMD kernels on arrays of arithmetic values, with runtime instruction set dispatch.
+// STATUS: prototype
+
+#include <cstddef>
+#include <cstdint>
+#include <duck/type_traits.h>
+#include <limits>
+
+/* Kernels use SSE2 and AVX2 on x86 with GCC or Clang, selected at runtime from the CPU features.
+ * Other platforms (or DUCK_NO_SIMD) use scalar loops.
+ */
+#if !defined(DUCK_NO_SIMD) && (defined(__GNUC__) || defined(__clang__)) &&                       \
+    (defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__)))
+#define DUCK_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+namespace duck {
+namespace Detail {
+	// Element types supported by kernels: arithmetic types of 1 to 8 bytes, except bool.
+	template <typename T>
+	using is_simd_type =
+	    bool_constant<std::is_arithmetic<T>::value && !std::is_same<T, bool>::value &&
+	                  (std::is_integral<T>::value || sizeof (T) == 4 || sizeof (T) == 8)>;
+
+	/* Lane types, used to select vector instructions:
+	 * - simd_bits_t: same bits for equality and additions (signed integer of same size, or float).
+	 * - simd_lane_t: same ordering (signed or unsigned integer of same size, or float).
+	 */
+	template <std::size_t Size, bool Signed> struct SimdInteger;
+	template <> struct SimdInteger<1, true> { using type = std::int8_t; };
+	template <> struct SimdInteger<2, true> { using type = std::int16_t; };
+	template <> struct SimdInteger<4, true> { using type = std::int32_t; };
+	template <> struct SimdInteger<8, true> { using type = std::int64_t; };
+	template <> struct SimdInteger<1, false> { using type = std::uint8_t; };
+	template <> struct SimdInteger<2, false> { using type = std::uint16_t; };
+	template <> struct SimdInteger<4, false> { using type = std::uint32_t; };
+	template <> struct SimdInteger<8, false> { using type = std::uint64_t; };
+
+	template <typename T, bool = std::is_floating_point<T>::value> struct SimdLane {
+		using type = T;
+		using bits = T;
+	};
+	template <typename T> struct SimdLane<T, false> {
+		using type = typename SimdInteger<sizeof (T), std::is_signed<T>::value>::type;
+		using bits = typename SimdInteger<sizeof (T), true>::type;
+	};
+	template <typename T> using simd_lane_t = typename SimdLane<T>::type;
+	template <typename T> using simd_bits_t = typename SimdLane<T>::bits;
+
+	// Tag selecting the instruction variant for a lane type
+	template <typename L> struct Lane {};
+
+	// Additions wrap around for integers (no signed overflow UB), as vector additions do.
+	template <typename T> T wrapping_add (T a, T b, std::true_type /*integral*/) {
+		using U = typename std::make_unsigned<T>::type;
+		return static_cast<T> (static_cast<U> (static_cast<U> (a) + static_cast<U> (b)));
+	}
+	template <typename T> T wrapping_add (T a, T b, std::false_type) { return a + b; }
+	template <typename T> T wrapping_add (T a, T b) {
+		return wrapping_add (a, b, std::is_integral<T>{});
+	}
+
+	// Maximum size of the set of values searched by find_any kernels
+	constexpr std::size_t simd_max_find_any_set = 16;
+
+#ifdef DUCK_SIMD_X86
+	namespace sse2 {
+		// SSE2 is always available on x86_64
+		struct Ops {
+			using Vector = __m128i;
+			static constexpr std::size_t width = 16;
+			static constexpr std::uint32_t full_mask = 0xFFFF;
+
+			static Vector load (const void * p) {
+				return _mm_loadu_si128 (static_cast<const Vector *> (p));
+			}
+			static void store (void * p, Vector v) { _mm_storeu_si128 (static_cast<Vector *> (p), v); }
+			static Vector zero () { return _mm_setzero_si128 (); }
+			static Vector select (Vector mask, Vector if_set, Vector if_unset) {
+				return _mm_or_si128 (_mm_and_si128 (mask, if_set), _mm_andnot_si128 (mask, if_unset));
+			}
+
+			static Vector set1 (std::int8_t x) { return _mm_set1_epi8 (x); }
+			static Vector set1 (std::int16_t x) { return _mm_set1_epi16 (x); }
+			static Vector set1 (std::int32_t x) { return _mm_set1_epi32 (x); }
+			static Vector set1 (std::int64_t x) { return _mm_set1_epi64x (x); }
+			static Vector set1 (float x) { return _mm_castps_si128 (_mm_set1_ps (x)); }
+			static Vector set1 (double x) { return _mm_castpd_si128 (_mm_set1_pd (x)); }
+
+			// One bit per byte, set for bytes of equal elements
+			static std::uint32_t equal_mask (Vector a, Vector b, Lane<std::int8_t>) {
+				return static_cast<std::uint32_t> (_mm_movemask_epi8 (_mm_cmpeq_epi8 (a, b)));
+			}
+			static std::uint32_t equal_mask (Vector a, Vector b, Lane<std::int16_t>) {
+				return static_cast<std::uint32_t> (_mm_movemask_epi8 (_mm_cmpeq_epi16 (a, b)));
+			}
+			static std::uint32_t equal_mask (Vector a, Vector b, Lane<std::int32_t>) {
+				return static_cast<std::uint32_t> (_mm_movemask_epi8 (_mm_cmpeq_epi32 (a, b)));
+			}
+			static std::uint32_t equal_mask (Vector a, Vector b, Lane<std::int64_t>) {
+				// Both 32 bit halves must be equal
+				auto halves = _mm_cmpeq_epi32 (a, b);
+				auto swapped = _mm_shuffle_epi32 (halves, _MM_SHUFFLE (2, 3, 0, 1));
+				return static_cast<std::uint32_t> (_mm_movemask_epi8 (_mm_and_si128 (halves, swapped)));
+			}
+			static std::uint32_t equal_mask (Vector a, Vector b, Lane<float>) {
+				auto eq = _mm_cmpeq_ps (_mm_castsi128_ps (a), _mm_castsi128_ps (b));
+				return static_cast<std::uint32_t> (_mm_movemask_epi8 (_mm_castps_si128 (eq)));
+			}
+			static std::uint32_t equal_mask (Vector a, Vector b, Lane<double>) {
+				auto eq = _mm_cmpeq_pd (_mm_castsi128_pd (a), _mm_castsi128_pd (b));
+				return static_cast<std::uint32_t> (_mm_movemask_epi8 (_mm_castpd_si128 (eq)));
+			}
+
+			static Vector add (Vector a, Vector b, Lane<std::int8_t>) { return _mm_add_epi8 (a, b); }
+			static Vector add (Vector a, Vector b, Lane<std::int16_t>) { return _mm_add_epi16 (a, b); }
+			static Vector add (Vector a, Vector b, Lane<std::int32_t>) { return _mm_add_epi32 (a, b); }
+			static Vector add (Vector a, Vector b, Lane<std::int64_t>) { return _mm_add_epi64 (a, b); }
+			static Vector add (Vector a, Vector b, Lane<float>) {
+				return _mm_castps_si128 (_mm_add_ps (_mm_castsi128_ps (a), _mm_castsi128_ps (b)));
+			}
+			static Vector add (Vector a, Vector b, Lane<double>) {
+				return _mm_castpd_si128 (_mm_add_pd (_mm_castsi128_pd (a), _mm_castsi128_pd (b)));
+			}
+
+			// Mask of a > b
+			static Vector greater (Vector a, Vector b, Lane<std::int8_t>) {
+				return _mm_cmpgt_epi8 (a, b);
+			}
+			static Vector greater (Vector a, Vector b, Lane<std::int16_t>) {
+				return _mm_cmpgt_epi16 (a, b);
+			}
+			static Vector greater (Vector a, Vector b, Lane<std::int32_t>) {
+				return _mm_cmpgt_epi32 (a, b);
+			}
+			static Vector greater (Vector a, Vector b, Lane<std::int64_t>) {
+				// No 64 bit compare in SSE2: sign of b - a, corrected for overflow
+				auto diff = _mm_sub_epi64 (b, a);
+				auto overflow = _mm_and_si128 (_mm_xor_si128 (a, b), _mm_xor_si128 (b, diff));
+				auto sign = _mm_srai_epi32 (_mm_xor_si128 (diff, overflow), 31);
+				return _mm_shuffle_epi32 (sign, _MM_SHUFFLE (3, 3, 1, 1));
+			}
+			template <typename U> static Vector greater (Vector a, Vector b, Lane<U>) {
+				// Unsigned: flip the sign bit and use the signed compare
+				using S = typename std::make_signed<U>::type;
+				auto bias = set1 (std::numeric_limits<S>::min ());
+				return greater (_mm_xor_si128 (a, bias), _mm_xor_si128 (b, bias), Lane<S>{});
+			}
+
+			// Element wise min / max. Keep acc if x is NaN.
+			template <typename L> static Vector min (Vector acc, Vector x, Lane<L> lane) {
+				return select (greater (acc, x, lane), x, acc);
+			}
+			template <typename L> static Vector max (Vector acc, Vector x, Lane<L> lane) {
+				return select (greater (x, acc, lane), x, acc);
+			}
+			static Vector min (Vector acc, Vector x, Lane<float>) {
+				return _mm_castps_si128 (_mm_min_ps (_mm_castsi128_ps (x), _mm_castsi128_ps (acc)));
+			}
+			static Vector max (Vector acc, Vector x, Lane<float>) {
+				return _mm_castps_si128 (_mm_max_ps (_mm_castsi128_ps (x), _mm_castsi128_ps (acc)));
+			}
+			static Vector min (Vector acc, Vector x, Lane<double>) {
+				return _mm_castpd_si128 (_mm_min_pd (_mm_castsi128_pd (x), _mm_castsi128_pd (acc)));
+			}
+			static Vector max (Vector acc, Vector x, Lane<double>) {
+				return _mm_castpd_si128 (_mm_max_pd (_mm_castsi128_pd (x), _mm_castsi128_pd (acc)));
+			}
+
+			// Shift elements towards the end of the vector by Bytes, shifting in zeros
+			template <int Bytes> static Vector shift_up (Vector v) { return _mm_slli_si128 (v, Bytes); }
+
+			// Last element copied in all elements
+			static Vector broadcast_last (Vector v, Lane<std::int8_t>) {
+				// Duplicate the high bytes to 16 bit elements
+				return broadcast_last (_mm_unpackhi_epi8 (v, v), Lane<std::int16_t>{});
+			}
+			static Vector broadcast_last (Vector v, Lane<std::int16_t>) {
+				auto high = _mm_shufflehi_epi16 (v, _MM_SHUFFLE (3, 3, 3, 3));
+				return _mm_unpackhi_epi64 (high, high);
+			}
+			static Vector broadcast_last (Vector v, Lane<std::int32_t>) {
+				return _mm_shuffle_epi32 (v, _MM_SHUFFLE (3, 3, 3, 3));
+			}
+			static Vector broadcast_last (Vector v, Lane<std::int64_t>) {
+				return _mm_shuffle_epi32 (v, _MM_SHUFFLE (3, 2, 3, 2));
+			}
+			static Vector broadcast_last (Vector v, Lane<float>) {
+				return broadcast_last (v, Lane<std::int32_t>{});
+			}
+			static Vector broadcast_last (Vector v, Lane<double>) {
+				return broadcast_last (v, Lane<std::int64_t>{});
+			}
+		};
+#include <duck/simd_kernels.h>
+	} // namespace sse2
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__ ((target ("avx2"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+	namespace avx2 {
+		// Only called if the CPU supports AVX2 (see cpu_has_avx2)
+		struct Ops {
+			using Vector = __m256i;
+			static constexpr std::size_t width = 32;
+			static constexpr std::uint32_t full_mask = 0xFFFFFFFF;
+
+			static Vector load (const void * p) {
+				return _mm256_loadu_si256 (static_cast<const Vector *> (p));
+			}
+			static void store (void * p, Vector v) {
+				_mm256_storeu_si256 (static_cast<Vector *> (p), v);
+			}
+			static Vector zero () { return _mm256_setzero_si256 (); }
+			static Vector select (Vector mask, Vector if_set, Vector if_unset) {
+				return _mm256_blendv_epi8 (if_unset, if_set, mask);
+			}
+
+			static Vector set1 (std::int8_t x) { return _mm256_set1_epi8 (x); }
+			static Vector set1 (std::int16_t x) { return _mm256_set1_epi16 (x); }
+			static Vector set1 (std::int32_t x) { return _mm256_set1_epi32 (x); }
+			static Vector set1 (std::int64_t x) { return _mm256_set1_epi64x (x); }
+			static Vector set1 (float x) { return _mm256_castps_si256 (_mm256_set1_ps (x)); }
+			static Vector set1 (double x) { return _mm256_castpd_si256 (_mm256_set1_pd (x)); }
+
+			static std::uint32_t movemask (Vector v) {
+				return static_cast<std::uint32_t> (_mm256_movemask_epi8 (v));
+			}
+			static std::uint32_t equal_mask (Vector a, Vector b, Lane<std::int8_t>) {
+				return movemask (_mm256_cmpeq_epi8 (a, b));
+			}
+			static std::uint32_t equal_mask (Vector a, Vector b, Lane<std::int16_t>) {
+				return movemask (_mm256_cmpeq_epi16 (a, b));
+			}
+			static std::uint32_t equal_mask (Vector a, Vector b, Lane<std::int32_t>) {
+				return movemask (_mm256_cmpeq_epi32 (a, b));
+			}
+			static std::uint32_t equal_mask (Vector a, Vector b, Lane<std::int64_t>) {
+				return movemask (_mm256_cmpeq_epi64 (a, b));
+			}
+			static std::uint32_t equal_mask (Vector a, Vector b, Lane<float>) {
+				auto eq = _mm256_cmp_ps (_mm256_castsi256_ps (a), _mm256_castsi256_ps (b), _CMP_EQ_OQ);
+				return movemask (_mm256_castps_si256 (eq));
+			}
+			static std::uint32_t equal_mask (Vector a, Vector b, Lane<double>) {
+				auto eq = _mm256_cmp_pd (_mm256_castsi256_pd (a), _mm256_castsi256_pd (b), _CMP_EQ_OQ);
+				return movemask (_mm256_castpd_si256 (eq));
+			}
+
+			static Vector add (Vector a, Vector b, Lane<std::int8_t>) { return _mm256_add_epi8 (a, b); }
+			static Vector add (Vector a, Vector b, Lane<std::int16_t>) {
+				return _mm256_add_epi16 (a, b);
+			}
+			static Vector add (Vector a, Vector b, Lane<std::int32_t>) {
+				return _mm256_add_epi32 (a, b);
+			}
+			static Vector add (Vector a, Vector b, Lane<std::int64_t>) {
+				return _mm256_add_epi64 (a, b);
+			}
+			static Vector add (Vector a, Vector b, Lane<float>) {
+				return _mm256_castps_si256 (
+				    _mm256_add_ps (_mm256_castsi256_ps (a), _mm256_castsi256_ps (b)));
+			}
+			static Vector add (Vector a, Vector b, Lane<double>) {
+				return _mm256_castpd_si256 (
+				    _mm256_add_pd (_mm256_castsi256_pd (a), _mm256_castsi256_pd (b)));
+			}
+
+			static Vector greater (Vector a, Vector b, Lane<std::int8_t>) {
+				return _mm256_cmpgt_epi8 (a, b);
+			}
+			static Vector greater (Vector a, Vector b, Lane<std::int16_t>) {
+				return _mm256_cmpgt_epi16 (a, b);
+			}
+			static Vector greater (Vector a, Vector b, Lane<std::int32_t>) {
+				return _mm256_cmpgt_epi32 (a, b);
+			}
+			static Vector greater (Vector a, Vector b, Lane<std::int64_t>) {
+				return _mm256_cmpgt_epi64 (a, b);
+			}
+			template <typename U> static Vector greater (Vector a, Vector b, Lane<U>) {
+				using S = typename std::make_signed<U>::type;
+				auto bias = set1 (std::numeric_limits<S>::min ());
+				return greater (_mm256_xor_si256 (a, bias), _mm256_xor_si256 (b, bias), Lane<S>{});
+			}
+
+			template <typename L> static Vector min (Vector acc, Vector x, Lane<L> lane) {
+				return select (greater (acc, x, lane), x, acc);
+			}
+			template <typename L> static Vector max (Vector acc, Vector x, Lane<L> lane) {
+				return select (greater (x, acc, lane), x, acc);
+			}
+			static Vector min (Vector acc, Vector x, Lane<float>) {
+				return _mm256_castps_si256 (
+				    _mm256_min_ps (_mm256_castsi256_ps (x), _mm256_castsi256_ps (acc)));
+			}
+			static Vector max (Vector acc, Vector x, Lane<float>) {
+				return _mm256_castps_si256 (
+				    _mm256_max_ps (_mm256_castsi256_ps (x), _mm256_castsi256_ps (acc)));
+			}
+			static Vector min (Vector acc, Vector x, Lane<double>) {
+				return _mm256_castpd_si256 (
+				    _mm256_min_pd (_mm256_castsi256_pd (x), _mm256_castsi256_pd (acc)));
+			}
+			static Vector max (Vector acc, Vector x, Lane<double>) {
+				return _mm256_castpd_si256 (
+				    _mm256_max_pd (_mm256_castsi256_pd (x), _mm256_castsi256_pd (acc)));
+			}
+
+			// Byte shifts work inside 128 bit halves: the low half is moved to the high one first.
+			template <int Bytes> static Vector shift_up (Vector v) {
+				return shift_up<Bytes> (v, bool_constant<(Bytes < 16)>{});
+			}
+			template <int Bytes> static Vector shift_up (Vector v, std::true_type) {
+				return _mm256_alignr_epi8 (v, _mm256_permute2x128_si256 (v, v, 0x08), 16 - Bytes);
+			}
+			template <int Bytes> static Vector shift_up (Vector v, std::false_type) {
+				return _mm256_slli_si256 (_mm256_permute2x128_si256 (v, v, 0x08), Bytes - 16);
+			}
+
+			static Vector broadcast_last (Vector v, Lane<std::int8_t>) {
+				auto high = _mm256_permute2x128_si256 (v, v, 0x11);
+				return _mm256_shuffle_epi8 (high, _mm256_set1_epi8 (15));
+			}
+			static Vector broadcast_last (Vector v, Lane<std::int16_t>) {
+				auto high = _mm256_permute2x128_si256 (v, v, 0x11);
+				return _mm256_shuffle_epi8 (high, _mm256_set1_epi16 (0x0F0E));
+			}
+			static Vector broadcast_last (Vector v, Lane<std::int32_t>) {
+				return _mm256_permutevar8x32_epi32 (v, _mm256_set1_epi32 (7));
+			}
+			static Vector broadcast_last (Vector v, Lane<std::int64_t>) {
+				return _mm256_permute4x64_epi64 (v, _MM_SHUFFLE (3, 3, 3, 3));
+			}
+			static Vector broadcast_last (Vector v, Lane<float>) {
+				return broadcast_last (v, Lane<std::int32_t>{});
+			}
+			static Vector broadcast_last (Vector v, Lane<double>) {
+				return broadcast_last (v, Lane<std::int64_t>{});
+			}
+		};
+#include <duck/simd_kernels.h>
+	} // namespace avx2
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+	inline bool cpu_has_avx2 () {
+		static const bool has_avx2 = [] {
+			__builtin_cpu_init ();
+			return __builtin_cpu_supports ("avx2") != 0;
+		}();
+		return has_avx2;
+	}
+#define DUCK_SIMD_DISPATCH(call) (cpu_has_avx2 () ? avx2::call : sse2::call)
+#else
+	namespace scalar {
+		// Without vector instructions: plain loops
+		struct Ops {};
+		template <typename T> std::size_t find (const T * data, std::size_t n, T value) {
+			std::size_t i = 0;
+			while (i < n && !(data[i] == value))
+				++i;
+			return i;
+		}
+		template <typename T>
+		std::size_t find_any (const T * data, std::size_t n, const T * set, std::size_t set_size) {
+			for (std::size_t i = 0; i < n; ++i)
+				for (std::size_t k = 0; k < set_size; ++k)
+					if (data[i] == set[k])
+						return i;
+			return n;
+		}
+		template <typename T> std::size_t count (const T * data, std::size_t n, T value) {
+			std::size_t c = 0;
+			for (std::size_t i = 0; i < n; ++i)
+				c += data[i] == value;
+			return c;
+		}
+		template <typename T> std::size_t mismatch (const T * a, const T * b, std::size_t n) {
+			std::size_t i = 0;
+			while (i < n && a[i] == b[i])
+				++i;
+			return i;
+		}
+		template <typename T> std::size_t min_index (const T * data, std::size_t n) {
+			std::size_t m = 0;
+			for (std::size_t i = 1; i < n; ++i)
+				if (data[i] < data[m])
+					m = i;
+			return m;
+		}
+		template <typename T> std::size_t max_index (const T * data, std::size_t n) {
+			std::size_t m = 0;
+			for (std::size_t i = 1; i < n; ++i)
+				if (data[m] < data[i])
+					m = i;
+			return m;
+		}
+		template <typename T> T sum (const T * data, std::size_t n) {
+			T s = 0;
+			for (std::size_t i = 0; i < n; ++i)
+				s = wrapping_add (s, data[i]);
+			return s;
+		}
+		template <typename T> void inclusive_scan (const T * in, T * out, std::size_t n, T init) {
+			for (std::size_t i = 0; i < n; ++i)
+				out[i] = init = wrapping_add (init, in[i]);
+		}
+		template <typename T> void exclusive_scan (const T * in, T * out, std::size_t n, T init) {
+			for (std::size_t i = 0; i < n; ++i) {
+				auto x = in[i];
+				out[i] = init;
+				init = wrapping_add (init, x);
+			}
+		}
+	} // namespace scalar
+#define DUCK_SIMD_DISPATCH(call) (scalar::call)
+#endif
+
+	/* Dispatched kernels, on arrays of n elements of a type satisfying is_simd_type.
+	 * Equality and ordering follow operator== and operator< on T (IEEE for floats).
+	 */
+
+	// Index of the first element equal to value, or n.
+	template <typename T> std::size_t simd_find (const T * data, std::size_t n, T value) {
+		return DUCK_SIMD_DISPATCH (find (data, n, value));
+	}
+	// Index of the first element equal to any of set[0 .. set_size[, or n.
+	// set_size <= simd_max_find_any_set: each value costs one comparison per vector.
+	template <typename T>
+	std::size_t simd_find_any (const T * data, std::size_t n, const T * set, std::size_t set_size) {
+		return DUCK_SIMD_DISPATCH (find_any (data, n, set, set_size));
+	}
+	// Number of elements equal to value.
+	template <typename T> std::size_t simd_count (const T * data, std::size_t n, T value) {
+		return DUCK_SIMD_DISPATCH (count (data, n, value));
+	}
+	// Index of the first element where a and b differ, or n.
+	template <typename T> std::size_t simd_mismatch (const T * a, const T * b, std::size_t n) {
+		return DUCK_SIMD_DISPATCH (mismatch (a, b, n));
+	}
+	// Index of the first smallest / largest element like std::min_element / max_element, or n.
+	template <typename T> std::size_t simd_min_index (const T * data, std::size_t n) {
+		if (n == 0 || !(data[0] == data[0]))
+			return 0; // Empty, or NaN first: std::min_element returns the first element
+		return DUCK_SIMD_DISPATCH (min_index (data, n));
+	}
+	template <typename T> std::size_t simd_max_index (const T * data, std::size_t n) {
+		if (n == 0 || !(data[0] == data[0]))
+			return 0;
+		return DUCK_SIMD_DISPATCH (max_index (data, n));
+	}
+	// Sum of elements, in unspecified order. Integers wrap around.
+	template <typename T> T simd_sum (const T * data, std::size_t n) {
+		return DUCK_SIMD_DISPATCH (sum (data, n));
+	}
+	/* Prefix sums of in [0, n), starting from init, in out [0, n) (in == out is allowed).
+	 * inclusive: out[i] = init + in[0] + ... + in[i] ; exclusive: out[i] = init + ... + in[i - 1].
+	 * Additions are done in unspecified order (float results can differ from a sequential loop).
+	 */
+	template <typename T> void simd_inclusive_scan (const T * in, T * out, std::size_t n, T init) {
+		DUCK_SIMD_DISPATCH (inclusive_scan (in, out, n, init));
+	}
+	template <typename T> void simd_exclusive_scan (const T * in, T * out, std::size_t n, T init) {
+		DUCK_SIMD_DISPATCH (exclusive_scan (in, out, n, init));
+	}
+	// std::all_of, for pure predicates only (see duck::pure_predicate): p is called on blocks of
+	// elements. Only vectorized with AVX2: blocks without early exit are slower with SSE2.
+	template <typename T, typename UnaryPredicate>
+	bool simd_all_of (const T * data, std::size_t n, UnaryPredicate & p) {
+#ifdef DUCK_SIMD_X86
+		if (cpu_has_avx2 ())
+			return avx2::all_of (data, n, p);
+#endif
+		for (std::size_t i = 0; i < n; ++i)
+			if (!p (data[i]))
+				return false;
+		return true;
+	}
+#undef DUCK_SIMD_DISPATCH
+
+	/* Convert value to T without changing the result of comparisons with T elements.
+	 * Returns false if not possible (different types that are not both integers, or value out of
+	 * range of T): the caller uses scalar code.
+	 */
+	template <typename T> bool simd_convert_value (const T & value, T & out, std::false_type) {
+		return out = value, true;
+	}
+	template <typename T, typename V>
+	bool simd_convert_value (const V & value, T & out, std::true_type /*integers*/) {
+		out = static_cast<T> (value);
+		return static_cast<V> (out) == value;
+	}
+	template <typename T, typename V> bool simd_convert_value (const V &, T &, std::false_type) {
+		return false;
+	}
+	template <typename T, typename V> bool simd_convert_value (const V & value, T & out) {
+		return simd_convert_value (value, out,
+		                           bool_constant<std::is_integral<T>::value &&
+		                                         std::is_integral<V>::value>{});
+	}
+
+} // namespace Detail
+} // namespace duck
@@ -0,0 +1,206 @@
+// SIMD kernels, written once for all instruction sets.
+// Included by duck/simd.h in each instruction set namespace (no include guard), with an Ops struct
+// in scope providing the vector type and operations, and the matching target options enabled.
+// STATUS: prototype
+
+template <typename T> std::size_t find (const T * data, std::size_t n, T value) {
+	constexpr std::size_t step = Ops::width / sizeof (T);
+	auto lane = Lane<simd_bits_t<T>>{};
+	auto v = Ops::set1 (static_cast<simd_bits_t<T>> (value));
+	std::size_t i = 0;
+	for (; i + step <= n; i += step) {
+		auto mask = Ops::equal_mask (Ops::load (data + i), v, lane);
+		if (mask != 0)
+			return i + static_cast<std::size_t> (__builtin_ctz (mask)) / sizeof (T);
+	}
+	for (; i < n; ++i)
+		if (data[i] == value)
+			return i;
+	return n;
+}
+
+// First element equal to any of set[0 .. set_size[, with set_size <= simd_max_find_any_set.
+template <typename T>
+std::size_t find_any (const T * data, std::size_t n, const T * set, std::size_t set_size) {
+	constexpr std::size_t step = Ops::width / sizeof (T);
+	auto lane = Lane<simd_bits_t<T>>{};
+	typename Ops::Vector values[simd_max_find_any_set];
+	for (std::size_t k = 0; k < set_size; ++k)
+		values[k] = Ops::set1 (static_cast<simd_bits_t<T>> (set[k]));
+	std::size_t i = 0;
+	for (; i + step <= n; i += step) {
+		auto block = Ops::load (data + i);
+		std::uint32_t mask = 0;
+		for (std::size_t k = 0; k < set_size; ++k)
+			mask |= Ops::equal_mask (block, values[k], lane);
+		if (mask != 0)
+			return i + static_cast<std::size_t> (__builtin_ctz (mask)) / sizeof (T);
+	}
+	for (; i < n; ++i)
+		for (std::size_t k = 0; k < set_size; ++k)
+			if (data[i] == set[k])
+				return i;
+	return n;
+}
+
+template <typename T> std::size_t count (const T * data, std::size_t n, T value) {
+	constexpr std::size_t step = Ops::width / sizeof (T);
+	auto lane = Lane<simd_bits_t<T>>{};
+	auto v = Ops::set1 (static_cast<simd_bits_t<T>> (value));
+	std::size_t bytes = 0; // sizeof (T) mask bits per equal element
+	std::size_t i = 0;
+	for (; i + step <= n; i += step)
+		bytes += static_cast<std::size_t> (
+		    __builtin_popcount (Ops::equal_mask (Ops::load (data + i), v, lane)));
+	auto c = bytes / sizeof (T);
+	for (; i < n; ++i)
+		c += data[i] == value;
+	return c;
+}
+
+template <typename T> std::size_t mismatch (const T * a, const T * b, std::size_t n) {
+	constexpr std::size_t step = Ops::width / sizeof (T);
+	auto lane = Lane<simd_bits_t<T>>{};
+	std::size_t i = 0;
+	for (; i + step <= n; i += step) {
+		auto mask = Ops::equal_mask (Ops::load (a + i), Ops::load (b + i), lane);
+		if (mask != Ops::full_mask)
+			return i + static_cast<std::size_t> (__builtin_ctz (~mask)) / sizeof (T);
+	}
+	for (; i < n; ++i)
+		if (!(a[i] == b[i]))
+			return i;
+	return n;
+}
+
+// Reductions: vector accumulator, then scalar reduction of its lanes and of the remaining elements.
+// min / max: n > 0 and data[0] is not NaN, so that NaN elements are ignored by Ops::min / max.
+template <typename T> T min_value (const T * data, std::size_t n) {
+	constexpr std::size_t step = Ops::width / sizeof (T);
+	auto lane = Lane<simd_lane_t<T>>{};
+	auto acc = Ops::set1 (static_cast<simd_bits_t<T>> (data[0]));
+	std::size_t i = 0;
+	for (; i + step <= n; i += step)
+		acc = Ops::min (acc, Ops::load (data + i), lane);
+	T lanes[step];
+	Ops::store (lanes, acc);
+	T m = data[0];
+	for (auto x : lanes)
+		if (x < m)
+			m = x;
+	for (; i < n; ++i)
+		if (data[i] < m)
+			m = data[i];
+	return m;
+}
+template <typename T> T max_value (const T * data, std::size_t n) {
+	constexpr std::size_t step = Ops::width / sizeof (T);
+	auto lane = Lane<simd_lane_t<T>>{};
+	auto acc = Ops::set1 (static_cast<simd_bits_t<T>> (data[0]));
+	std::size_t i = 0;
+	for (; i + step <= n; i += step)
+		acc = Ops::max (acc, Ops::load (data + i), lane);
+	T lanes[step];
+	Ops::store (lanes, acc);
+	T m = data[0];
+	for (auto x : lanes)
+		if (m < x)
+			m = x;
+	for (; i < n; ++i)
+		if (m < data[i])
+			m = data[i];
+	return m;
+}
+// First element equal to the min / max value is the one chosen by std::min_element / max_element.
+template <typename T> std::size_t min_index (const T * data, std::size_t n) {
+	return find (data, n, min_value (data, n));
+}
+template <typename T> std::size_t max_index (const T * data, std::size_t n) {
+	return find (data, n, max_value (data, n));
+}
+
+template <typename T> T sum (const T * data, std::size_t n) {
+	constexpr std::size_t step = Ops::width / sizeof (T);
+	auto lane = Lane<simd_bits_t<T>>{};
+	auto acc = Ops::zero ();
+	std::size_t i = 0;
+	for (; i + step <= n; i += step)
+		acc = Ops::add (acc, Ops::load (data + i), lane);
+	T lanes[step];
+	Ops::store (lanes, acc);
+	T s = 0;
+	for (auto x : lanes)
+		s = wrapping_add (s, x);
+	for (; i < n; ++i)
+		s = wrapping_add (s, data[i]);
+	return s;
+}
+
+// Prefix sums inside a vector: log2 (elements) shifted additions.
+template <std::size_t Bytes, typename L>
+typename Ops::Vector prefix_sum (typename Ops::Vector v, Lane<L>, std::false_type /*continue*/) {
+	return v;
+}
+template <std::size_t Bytes, typename L>
+typename Ops::Vector prefix_sum (typename Ops::Vector v, Lane<L> lane,
+                                 std::true_type /*continue*/ = {}) {
+	v = Ops::add (v, Ops::template shift_up<Bytes> (v), lane);
+	return prefix_sum<2 * Bytes> (v, lane, bool_constant<(2 * Bytes < Ops::width)>{});
+}
+
+// Scans: the running total (carry) stays in a vector, with all elements equal.
+template <typename T> void inclusive_scan (const T * in, T * out, std::size_t n, T init) {
+	constexpr std::size_t step = Ops::width / sizeof (T);
+	auto lane = Lane<simd_bits_t<T>>{};
+	auto carry = Ops::set1 (static_cast<simd_bits_t<T>> (init));
+	std::size_t i = 0;
+	for (; i + step <= n; i += step) {
+		auto v = Ops::add (prefix_sum<sizeof (T)> (Ops::load (in + i), lane), carry, lane);
+		Ops::store (out + i, v);
+		carry = Ops::broadcast_last (v, lane);
+	}
+	T lanes[step];
+	Ops::store (lanes, carry);
+	auto s = lanes[0];
+	for (; i < n; ++i)
+		out[i] = s = wrapping_add (s, in[i]);
+}
+template <typename T> void exclusive_scan (const T * in, T * out, std::size_t n, T init) {
+	constexpr std::size_t step = Ops::width / sizeof (T);
+	auto lane = Lane<simd_bits_t<T>>{};
+	auto carry = Ops::set1 (static_cast<simd_bits_t<T>> (init));
+	std::size_t i = 0;
+	for (; i + step <= n; i += step) {
+		auto prefix = prefix_sum<sizeof (T)> (Ops::load (in + i), lane);
+		Ops::store (out + i, Ops::add (Ops::template shift_up<sizeof (T)> (prefix), carry, lane));
+		carry = Ops::broadcast_last (Ops::add (prefix, carry, lane), lane);
+	}
+	T lanes[step];
+	Ops::store (lanes, carry);
+	auto s = lanes[0];
+	for (; i < n; ++i) {
+		auto x = in[i];
+		out[i] = s;
+		s = wrapping_add (s, x);
+	}
+}
+
+// all_of with a pure predicate: count failures on blocks without early exit inside a block, so
+// that the compiler vectorizes the block loop with the instruction set of this namespace.
+// p is called on up to a block of elements after the first failure.
+template <typename T, typename UnaryPredicate>
+bool all_of (const T * data, std::size_t n, UnaryPredicate & p) {
+	constexpr std::size_t block = 64;
+	std::size_t i = 0;
+	for (; i + block <= n; i += block) {
+		std::size_t failures = 0;
+		for (std::size_t j = 0; j < block; ++j)
+			failures += !p (data[i + j]);
+		if (failures > 0)
+			return false;
+	}
+	for (; i < n; ++i)
+		if (!p (data[i]))
+			return false;
+	return true;
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+// Analog to std::function, move only, with a local storage to avoid new() for small closures.
+// STATUS: prototype
+
+#include <cstddef>
+#include <duck/type_traits.h>
+#include <new>
+#include <utility>
+
+namespace duck {
+
+template <typename Signature, std::size_t StorageSize = 6 * sizeof (void *)> class SmallFunction;
+
+template <typename R, typename... Args, std::size_t StorageSize>
+class SmallFunction<R(Args...), StorageSize> {
+	/* Type erased callable, like std::function<R(Args...)>, but:
+	 * - move only: callables do not need to be copyable (unique_ptr captures are ok).
+	 * - callables of size <= StorageSize (nothrow movable, not over-aligned) are stored inline.
+	 *   Bigger ones are allocated on the heap.
+	 * An empty SmallFunction must not be called.
+	 */
+private:
+	using StorageType = aligned_storage_t<StorageSize, alignof (std::max_align_t)>;
+
+	// Operations of the stored callable type, one static table per type.
+	struct Operations {
+		R (*invoke) (void * storage, Args &&... args);
+		void (*move) (void * from, void * to) noexcept; // Move construct at to, destroy from
+		void (*destroy) (void * storage) noexcept;
+	};
+
+	template <typename F> struct InlineOperations {
+		static F & get (void * storage) noexcept { return *static_cast<F *> (storage); }
+		static R invoke (void * storage, Args &&... args) {
+			return get (storage) (std::forward<Args> (args)...);
+		}
+		static void move (void * from, void * to) noexcept {
+			::new (to) F (std::move (get (from)));
+			get (from).~F ();
+		}
+		static void destroy (void * storage) noexcept { get (storage).~F (); }
+		static constexpr Operations table{invoke, move, destroy};
+	};
+	template <typename F> struct HeapOperations {
+		// Storage contains a F*
+		static F *& get (void * storage) noexcept { return *static_cast<F **> (storage); }
+		static R invoke (void * storage, Args &&... args) {
+			return (*get (storage)) (std::forward<Args> (args)...);
+		}
+		static void move (void * from, void * to) noexcept {
+			::new (to) F * (get (from));
+			get (from) = nullptr;
+		}
+		static void destroy (void * storage) noexcept { delete get (storage); }
+		static constexpr Operations table{invoke, move, destroy};
+	};
+
+public:
+	template <typename F>
+	using is_stored_inline =
+	    bool_constant<sizeof (F) <= StorageSize && alignof (F) <= alignof (std::max_align_t) &&
+	                  std::is_nothrow_move_constructible<F>::value>;
+
+	SmallFunction () = default;
+	SmallFunction (std::nullptr_t) noexcept {}
+
+	template <typename F, typename = enable_if_t<!std::is_same<decay_t<F>, SmallFunction>::value &&
+	                                             !std::is_same<decay_t<F>, std::nullptr_t>::value>>
+	SmallFunction (F && f) {
+		construct<decay_t<F>> (std::forward<F> (f), is_stored_inline<decay_t<F>>{});
+	}
+
+	SmallFunction (SmallFunction && other) noexcept : operations_ (other.operations_) {
+		if (operations_ != nullptr) {
+			operations_->move (&other.storage_, &storage_);
+			other.operations_ = nullptr;
+		}
+	}
+	SmallFunction & operator= (SmallFunction && other) noexcept {
+		if (this != &other) {
+			reset ();
+			if (other.operations_ != nullptr) {
+				other.operations_->move (&other.storage_, &storage_);
+				operations_ = other.operations_;
+				other.operations_ = nullptr;
+			}
+		}
+		return *this;
+	}
+	SmallFunction & operator= (std::nullptr_t) noexcept {
+		reset ();
+		return *this;
+	}
+	SmallFunction (const SmallFunction &) = delete;
+	SmallFunction & operator= (const SmallFunction &) = delete;
+	~SmallFunction () { reset (); }
+
+	explicit operator bool () const noexcept { return operations_ != nullptr; }
+
+	R operator() (Args... args) {
+		return operations_->invoke (&storage_, std::forward<Args> (args)...);
+	}
+
+	void reset () noexcept {
+		if (operations_ != nullptr) {
+			operations_->destroy (&storage_);
+			operations_ = nullptr;
+		}
+	}
+
+private:
+	template <typename F, typename Arg> void construct (Arg && f, std::true_type /*inline*/) {
+		::new (&storage_) F (std::forward<Arg> (f));
+		operations_ = &InlineOperations<F>::table;
+	}
+	template <typename F, typename Arg> void construct (Arg && f, std::false_type /*inline*/) {
+		::new (&storage_) F * (new F (std::forward<Arg> (f)));
+		operations_ = &HeapOperations<F>::table;
+	}
+
+	const Operations * operations_{nullptr};
+	StorageType storage_;
+};
+
+template <typename R, typename... Args, std::size_t StorageSize>
+template <typename F>
+constexpr typename SmallFunction<R(Args...), StorageSize>::Operations
+    SmallFunction<R(Args...), StorageSize>::InlineOperations<F>::table;
+template <typename R, typename... Args, std::size_t StorageSize>
+template <typename F>
+constexpr typename SmallFunction<R(Args...), StorageSize>::Operations
+    SmallFunction<R(Args...), StorageSize>::HeapOperations<F>::table;
+} // namespace duck
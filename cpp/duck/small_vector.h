@@ -4,6 +4,7 @@
 // STATUS: prototype
 
 #include <cstdint>
+#include <duck/type_traits.h>
 #include <initializer_list>
 #include <iterator>
 #include <limits>
@@ -222,6 +223,13 @@ protected:
 			emplace_back (*first);
 	}
 	template <typename It>
+	void append_sequence_impl (It first, It last, std::forward_iterator_tag) {
+		// Multi pass: count first to reserve once, like std::vector
+		reserve (size () + static_cast<size_type> (std::distance (first, last)));
+		for (; first != last; ++first)
+			unchecked_emplace_back (*first);
+	}
+	template <typename It>
 	void append_sequence_impl (It first, It last, std::random_access_iterator_tag) {
 		// More efficient if we can compute the size
 		reserve (size () + (last - first));
@@ -234,6 +242,12 @@ protected:
 			emplace_back (std::move (*first));
 	}
 	template <typename It>
+	void append_sequence_by_move_impl (It first, It last, std::forward_iterator_tag) {
+		reserve (size () + static_cast<size_type> (std::distance (first, last)));
+		for (; first != last; ++first)
+			unchecked_emplace_back (std::move (*first));
+	}
+	template <typename It>
 	void append_sequence_by_move_impl (It first, It last, std::random_access_iterator_tag) {
 		// More efficient if we can compute the size
 		reserve (size () + (last - first));
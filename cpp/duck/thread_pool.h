@@ -0,0 +1,529 @@
+#pragma once
+
+// Work stealing thread pool, with fork/join task groups and parallel_for.
+// STATUS: prototype
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <duck/range/range.h>
+#include <duck/small_function.h>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace duck {
+
+// Placement of pool worker threads.
+enum class ThreadAffinity {
+	none,        // Let the OS schedule workers
+	pin_to_cpus, // Worker i is pinned to the i-th allowed CPU (modulo) ; Linux only
+};
+
+namespace Detail {
+	struct PoolWorker;
+
+	// Task node: the closure is stored inline, nodes are recycled by their owner worker.
+	struct PoolTask {
+		SmallFunction<void(), 8 * sizeof (void *)> function;
+		PoolTask * next{nullptr};    // Free list or injection queue link
+		PoolWorker * owner{nullptr}; // Recycled by this worker, or the shared list if null
+	};
+
+	class WorkStealingDeque {
+		/* Chase-Lev deque of tasks (Lê et al. 2013, "Correct and efficient work-stealing for weak
+		 * memory models"). The owner pushes and pops at the bottom (LIFO), other threads steal at
+		 * the top (FIFO). Standalone fences are replaced by seq_cst operations on top / bottom.
+		 * Replaced arrays are kept until destruction, as thieves may still read them.
+		 */
+	public:
+		WorkStealingDeque () {
+			arrays_.emplace_back (new Array (64));
+			array_ = arrays_.back ().get ();
+		}
+		WorkStealingDeque (const WorkStealingDeque &) = delete;
+		WorkStealingDeque & operator= (const WorkStealingDeque &) = delete;
+
+		// Owner only
+		void push (PoolTask * task) {
+			auto b = bottom_.load (std::memory_order_relaxed);
+			auto t = top_.load (std::memory_order_acquire);
+			auto a = array_.load (std::memory_order_relaxed);
+			if (b - t > a->mask)
+				a = grow (a, t, b);
+			a->put (b, task);
+			bottom_.store (b + 1, std::memory_order_seq_cst);
+		}
+		PoolTask * pop () {
+			auto b = bottom_.load (std::memory_order_relaxed) - 1;
+			auto a = array_.load (std::memory_order_relaxed);
+			bottom_.store (b, std::memory_order_seq_cst);
+			auto t = top_.load (std::memory_order_seq_cst);
+			if (t > b) {
+				bottom_.store (b + 1, std::memory_order_relaxed); // Empty
+				return nullptr;
+			}
+			auto task = a->get (b);
+			if (t == b) {
+				// Last element: race with thieves
+				if (!top_.compare_exchange_strong (t, t + 1, std::memory_order_seq_cst,
+				                                   std::memory_order_relaxed))
+					task = nullptr;
+				bottom_.store (b + 1, std::memory_order_relaxed);
+			}
+			return task;
+		}
+
+		// Any thread
+		PoolTask * steal () {
+			auto t = top_.load (std::memory_order_seq_cst);
+			auto b = bottom_.load (std::memory_order_seq_cst);
+			if (t >= b)
+				return nullptr;
+			auto task = array_.load (std::memory_order_acquire)->get (t);
+			if (!top_.compare_exchange_strong (t, t + 1, std::memory_order_seq_cst,
+			                                   std::memory_order_relaxed))
+				return nullptr; // Lost the race, caller may retry elsewhere
+			return task;
+		}
+		bool maybe_empty () const {
+			return top_.load (std::memory_order_seq_cst) >= bottom_.load (std::memory_order_seq_cst);
+		}
+
+	private:
+		struct Array {
+			explicit Array (std::int64_t size)
+			    : mask (size - 1), slots (new std::atomic<PoolTask *>[size]) {}
+			PoolTask * get (std::int64_t i) const {
+				return slots[i & mask].load (std::memory_order_relaxed);
+			}
+			void put (std::int64_t i, PoolTask * task) {
+				slots[i & mask].store (task, std::memory_order_relaxed);
+			}
+			const std::int64_t mask;
+			std::unique_ptr<std::atomic<PoolTask *>[]> slots;
+		};
+
+		Array * grow (Array * a, std::int64_t t, std::int64_t b) {
+			arrays_.emplace_back (new Array (2 * (a->mask + 1)));
+			auto bigger = arrays_.back ().get ();
+			for (auto i = t; i < b; ++i)
+				bigger->put (i, a->get (i));
+			array_.store (bigger, std::memory_order_release);
+			return bigger;
+		}
+
+		std::atomic<std::int64_t> top_{0};
+		std::atomic<std::int64_t> bottom_{0};
+		std::atomic<Array *> array_{nullptr};
+		std::vector<std::unique_ptr<Array>> arrays_; // Owner only
+	};
+
+	struct PoolWorker {
+		WorkStealingDeque deque;
+		PoolTask * free_tasks{nullptr};                  // Owner only
+		std::atomic<PoolTask *> returned_tasks{nullptr}; // Pushed by other threads after execution
+		std::vector<std::unique_ptr<PoolTask>> tasks;    // All nodes allocated by this worker
+		std::minstd_rand random;
+		std::thread thread;
+	};
+} // namespace Detail
+
+class ThreadPool {
+	/* Work stealing thread pool.
+	 *
+	 * Each worker has a Chase-Lev deque: tasks spawned from a worker go to its own deque, and are
+	 * run LIFO by it (cache friendly for fork/join), while idle workers steal the oldest tasks of
+	 * others (biggest work units for recursive splitting). Tasks spawned from outside the pool go to
+	 * a shared queue. Idle workers sleep on a condition variable.
+	 *
+	 * Task closures are stored inline in recycled task nodes (SmallFunction storage, 64 bytes),
+	 * so spawning from workers does not allocate once nodes have been created. Closures bigger than
+	 * that are allocated.
+	 *
+	 * spawn() is fire and forget: tasks must not throw. Use TaskGroup to wait for tasks and get
+	 * their exceptions. The destructor runs all remaining tasks, then joins workers.
+	 */
+public:
+	explicit ThreadPool (std::size_t nb_threads = default_nb_threads (),
+	                     ThreadAffinity affinity = ThreadAffinity::none) {
+		if (nb_threads == 0)
+			nb_threads = 1;
+		workers_.reserve (nb_threads);
+		for (std::size_t i = 0; i < nb_threads; ++i) {
+			workers_.emplace_back (new Detail::PoolWorker);
+			workers_.back ()->random.seed (static_cast<unsigned> (i + 1));
+		}
+		auto cpus = affinity == ThreadAffinity::pin_to_cpus ? allowed_cpus () : std::vector<int>{};
+		for (std::size_t i = 0; i < nb_threads; ++i) {
+			auto & w = *workers_[i];
+			w.thread = std::thread ([this, &w] { worker_loop (w); });
+			if (!cpus.empty ())
+				pin_thread (w.thread, cpus[i % cpus.size ()]);
+		}
+	}
+	~ThreadPool () {
+		{
+			std::lock_guard<std::mutex> lock (mutex_);
+			stopping_ = true;
+		}
+		sleep_cv_.notify_all ();
+		for (auto & w : workers_)
+			w->thread.join ();
+	}
+	ThreadPool (const ThreadPool &) = delete;
+	ThreadPool & operator= (const ThreadPool &) = delete;
+
+	std::size_t size () const noexcept { return workers_.size (); }
+
+	// Run f () on the pool.
+	template <typename F> void spawn (F && f) {
+		auto w = current_worker ();
+		auto task = allocate_task (w);
+		task->function = std::forward<F> (f);
+		if (w != nullptr) {
+			w->deque.push (task);
+			if (nb_sleeping_.load (std::memory_order_seq_cst) > 0) {
+				std::lock_guard<std::mutex> lock (mutex_);
+				sleep_cv_.notify_one ();
+			}
+		} else {
+			std::lock_guard<std::mutex> lock (mutex_);
+			task->next = nullptr;
+			if (injected_tail_ != nullptr)
+				injected_tail_->next = task;
+			else
+				injected_head_ = task;
+			injected_tail_ = task;
+			injected_.store (true, std::memory_order_seq_cst);
+			if (nb_sleeping_.load (std::memory_order_seq_cst) > 0)
+				sleep_cv_.notify_one ();
+		}
+	}
+
+	/* Call f on each element of random access range r, in parallel.
+	 * The range is recursively split in halves (stealable tasks) down to grain elements.
+	 * Returns when all calls are done ; the first exception is rethrown.
+	 */
+	template <typename R, typename F> void parallel_for (const R & r, std::size_t grain, F f);
+
+	/* Run one pending task if any (own deque, shared queue, or stolen), returns false otherwise.
+	 * Used to help while waiting: can be called from any thread.
+	 * Helping nests tasks on the stack. Stolen tasks are unrelated to the waiting one, so after
+	 * max_help_depth nested helps only tasks of the worker own deque are run (they are spawned by
+	 * the stack above, so depth stays bounded by the spawn tree depth).
+	 */
+	bool try_run_one () {
+		static constexpr unsigned max_help_depth = 16;
+		static thread_local unsigned help_depth = 0;
+		auto w = current_worker ();
+		Detail::PoolTask * task = nullptr;
+		if (help_depth < max_help_depth)
+			task = w != nullptr ? find_task (*w) : find_task_external ();
+		else if (w != nullptr)
+			task = w->deque.pop ();
+		if (task == nullptr)
+			return false;
+		++help_depth;
+		run (task, w);
+		--help_depth;
+		return true;
+	}
+
+	// True if called from one of the pool workers.
+	bool in_worker () const noexcept { return current_worker () != nullptr; }
+
+	static std::size_t default_nb_threads () {
+		auto threads = static_cast<std::size_t> (std::thread::hardware_concurrency ());
+		return threads > 0 ? threads : 1;
+	}
+	// Process wide pool with default_nb_threads() workers, created on first use.
+	static ThreadPool & default_pool () {
+		static ThreadPool pool;
+		return pool;
+	}
+
+private:
+	struct CurrentWorker {
+		const ThreadPool * pool{nullptr};
+		Detail::PoolWorker * worker{nullptr};
+	};
+	static CurrentWorker & current () noexcept {
+		static thread_local CurrentWorker current;
+		return current;
+	}
+	Detail::PoolWorker * current_worker () const noexcept {
+		auto & c = current ();
+		return c.pool == this ? c.worker : nullptr;
+	}
+
+	// Task nodes
+
+	Detail::PoolTask * allocate_task (Detail::PoolWorker * w) {
+		if (w != nullptr) {
+			if (w->free_tasks == nullptr)
+				w->free_tasks = w->returned_tasks.exchange (nullptr, std::memory_order_acquire);
+			if (w->free_tasks == nullptr) {
+				w->tasks.emplace_back (new Detail::PoolTask);
+				w->tasks.back ()->owner = w;
+				return w->tasks.back ().get ();
+			}
+			auto task = w->free_tasks;
+			w->free_tasks = task->next;
+			return task;
+		} else {
+			std::lock_guard<std::mutex> lock (mutex_);
+			if (shared_free_tasks_ == nullptr) {
+				shared_tasks_.emplace_back (new Detail::PoolTask);
+				return shared_tasks_.back ().get ();
+			}
+			auto task = shared_free_tasks_;
+			shared_free_tasks_ = task->next;
+			return task;
+		}
+	}
+	void release_task (Detail::PoolTask * task, Detail::PoolWorker * w) {
+		task->function = nullptr; // Destroy captures now
+		auto owner = task->owner;
+		if (owner != nullptr && owner == w) {
+			task->next = w->free_tasks;
+			w->free_tasks = task;
+		} else if (owner != nullptr) {
+			task->next = owner->returned_tasks.load (std::memory_order_relaxed);
+			while (!owner->returned_tasks.compare_exchange_weak (
+			    task->next, task, std::memory_order_release, std::memory_order_relaxed))
+				;
+		} else {
+			std::lock_guard<std::mutex> lock (mutex_);
+			task->next = shared_free_tasks_;
+			shared_free_tasks_ = task;
+		}
+	}
+	void run (Detail::PoolTask * task, Detail::PoolWorker * w) {
+		task->function ();
+		release_task (task, w);
+	}
+
+	// Task search
+
+	Detail::PoolTask * pop_injected () {
+		if (!injected_.load (std::memory_order_seq_cst))
+			return nullptr;
+		std::lock_guard<std::mutex> lock (mutex_);
+		auto task = injected_head_;
+		if (task != nullptr) {
+			injected_head_ = task->next;
+			if (injected_head_ == nullptr) {
+				injected_tail_ = nullptr;
+				injected_.store (false, std::memory_order_relaxed);
+			}
+		}
+		return task;
+	}
+	Detail::PoolTask * steal (std::size_t start) {
+		auto n = workers_.size ();
+		for (std::size_t i = 0; i < n; ++i) {
+			if (auto task = workers_[(start + i) % n]->deque.steal ())
+				return task;
+		}
+		return nullptr;
+	}
+	Detail::PoolTask * find_task (Detail::PoolWorker & w) {
+		if (auto task = w.deque.pop ())
+			return task;
+		if (auto task = pop_injected ())
+			return task;
+		return steal (w.random ());
+	}
+	Detail::PoolTask * find_task_external () {
+		if (auto task = pop_injected ())
+			return task;
+		thread_local std::minstd_rand random (
+		    static_cast<unsigned> (std::hash<std::thread::id>{}(std::this_thread::get_id ())));
+		return steal (random ());
+	}
+	bool has_work () const {
+		if (injected_.load (std::memory_order_seq_cst))
+			return true;
+		for (const auto & w : workers_)
+			if (!w->deque.maybe_empty ())
+				return true;
+		return false;
+	}
+
+	void worker_loop (Detail::PoolWorker & w) {
+		current () = CurrentWorker{this, &w};
+		for (;;) {
+			if (auto task = find_task (w)) {
+				run (task, &w);
+				continue;
+			}
+			// Sleep, unless work appeared. Spawners check nb_sleeping_ after publishing work.
+			std::unique_lock<std::mutex> lock (mutex_);
+			nb_sleeping_.fetch_add (1, std::memory_order_seq_cst);
+			if (!has_work ()) {
+				if (stopping_) {
+					nb_sleeping_.fetch_sub (1, std::memory_order_relaxed);
+					break;
+				}
+				sleep_cv_.wait (lock);
+			}
+			nb_sleeping_.fetch_sub (1, std::memory_order_relaxed);
+		}
+		current () = CurrentWorker{};
+	}
+
+	static std::vector<int> allowed_cpus () {
+		std::vector<int> cpus;
+#if defined(__linux__)
+		cpu_set_t set;
+		CPU_ZERO (&set);
+		if (sched_getaffinity (0, sizeof (set), &set) == 0) {
+			for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+				if (CPU_ISSET (cpu, &set))
+					cpus.push_back (cpu);
+		}
+#endif
+		return cpus;
+	}
+	static void pin_thread (std::thread & t, int cpu) {
+#if defined(__linux__)
+		cpu_set_t set;
+		CPU_ZERO (&set);
+		CPU_SET (cpu, &set);
+		pthread_setaffinity_np (t.native_handle (), sizeof (set), &set);
+#else
+		(void) t;
+		(void) cpu;
+#endif
+	}
+
+	std::vector<std::unique_ptr<Detail::PoolWorker>> workers_;
+
+	// Protected by mutex_ (injected_ and nb_sleeping_ are also read without it)
+	std::mutex mutex_;
+	std::condition_variable sleep_cv_;
+	std::atomic<std::size_t> nb_sleeping_{0};
+	bool stopping_{false};
+	Detail::PoolTask * injected_head_{nullptr};
+	Detail::PoolTask * injected_tail_{nullptr};
+	std::atomic<bool> injected_{false};
+	Detail::PoolTask * shared_free_tasks_{nullptr};
+	std::vector<std::unique_ptr<Detail::PoolTask>> shared_tasks_;
+};
+
+class TaskGroup {
+	/* Fork / join on a ThreadPool: spawn tasks, then wait () for all of them.
+	 * Tasks can spawn more tasks in the same group.
+	 * wait () runs pending pool tasks while waiting, so it can be called from pool tasks.
+	 * The first exception thrown by a task is rethrown by wait ().
+	 * The destructor waits (but does not rethrow).
+	 */
+public:
+	explicit TaskGroup (ThreadPool & pool = ThreadPool::default_pool ()) : pool_ (pool) {}
+	~TaskGroup () { join (); }
+	TaskGroup (const TaskGroup &) = delete;
+	TaskGroup & operator= (const TaskGroup &) = delete;
+
+	ThreadPool & pool () const noexcept { return pool_; }
+
+	template <typename F> void spawn (F && f) {
+		pending_.fetch_add (1, std::memory_order_relaxed);
+		pool_.spawn ([this, f = std::forward<F> (f)]() mutable {
+			if (!failed_.load (std::memory_order_relaxed)) {
+				try {
+					f ();
+				} catch (...) {
+					std::lock_guard<std::mutex> lock (error_mutex_);
+					if (!error_)
+						error_ = std::current_exception ();
+					failed_.store (true, std::memory_order_relaxed);
+				}
+			}
+			// Last access to the group: the waiter may destroy it right after.
+			pending_.fetch_sub (1, std::memory_order_release);
+		});
+	}
+
+	// Wait for all tasks (helping the pool meanwhile), rethrow the first exception.
+	void wait () {
+		join ();
+		if (failed_.load (std::memory_order_relaxed)) {
+			failed_.store (false, std::memory_order_relaxed);
+			std::exception_ptr error;
+			std::swap (error, error_);
+			std::rethrow_exception (error);
+		}
+	}
+
+private:
+	void join () noexcept {
+		unsigned idle_rounds = 0;
+		while (pending_.load (std::memory_order_acquire) > 0) {
+			if (pool_.try_run_one ()) {
+				idle_rounds = 0;
+			} else if (++idle_rounds < 64) {
+				std::this_thread::yield ();
+			} else {
+				// Remaining tasks are running elsewhere
+				std::this_thread::sleep_for (std::chrono::microseconds (50));
+			}
+		}
+	}
+
+	ThreadPool & pool_;
+	std::atomic<std::size_t> pending_{0};
+	std::atomic<bool> failed_{false};
+	std::mutex error_mutex_;
+	std::exception_ptr error_;
+};
+
+namespace Detail {
+	template <typename It, typename F> struct ParallelForSplitter {
+		F & f;
+		std::size_t grain;
+
+		void operator() (TaskGroup & group, It first, std::size_t n) const {
+			// Give away the upper halves, keep the lower one
+			while (n > grain) {
+				auto half = n / 2;
+				auto splitter = this;
+				auto task_group = &group;
+				auto upper = first + static_cast<iterator_difference_t<It>> (half);
+				auto upper_n = n - half;
+				group.spawn ([splitter, task_group, upper, upper_n] {
+					(*splitter) (*task_group, upper, upper_n);
+				});
+				n = half;
+			}
+			for (std::size_t i = 0; i < n; ++i, ++first)
+				f (*first);
+		}
+	};
+} // namespace Detail
+
+template <typename R, typename F>
+void ThreadPool::parallel_for (const R & r, std::size_t grain, F f) {
+	using It = range_iterator_t<const R &>;
+	static_assert (std::is_base_of<std::random_access_iterator_tag, iterator_category_t<It>>::value,
+	               "parallel_for: range must be random access");
+	auto first = adl_begin (r);
+	auto n = static_cast<std::size_t> (adl_end (r) - first);
+	// Declared before group: if f throws, ~TaskGroup joins the tasks while splitter is alive
+	Detail::ParallelForSplitter<It, F> splitter{f, grain > 0 ? grain : 1};
+	TaskGroup group (*this);
+	splitter (group, first, n);
+	group.wait ();
+}
+} // namespace duck
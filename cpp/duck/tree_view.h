@@ -1,14 +1,19 @@
 #pragma once
 
-// Tree topology view
+// Tree topology view, and walks over tree topologies (dfs, bfs, post-order, levels, reductions).
 // STATUS: WIP
 
+#include <algorithm>
 #include <cassert>
+#include <cstddef>
 #include <cstdint>
-#include <deque>
 #include <duck/range/algorithm.h>
 #include <duck/range/combinator.h>
+#include <duck/view.h>
 #include <iterator>
+#include <limits>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace duck {
@@ -20,66 +25,300 @@ namespace duck {
  * Indexes are represented by a struct, which prevents implicit conversions (error prone).
  */
 struct topology_node_id {
-	std::intptr_t value;
+	std::intptr_t value{0};
+	topology_node_id () = default;
 	explicit topology_node_id (std::intptr_t v) : value (v) {}
 	bool operator== (const topology_node_id & o) const { return value == o.value; }
 	bool operator!= (const topology_node_id & o) const { return value != o.value; }
 };
 struct topology_edge_id {
-	std::intptr_t value;
+	std::intptr_t value{0};
+	topology_edge_id () = default;
 	explicit topology_edge_id (std::intptr_t v) : value (v) {}
 	bool operator== (const topology_edge_id & o) const { return value == o.value; }
 	bool operator!= (const topology_edge_id & o) const { return value != o.value; }
 };
 
+/* Tree topology concept.
+ * Tree walks (dfs ranges, LinearizedTree) are templates over a Topology type providing:
+ * - typedefs node_id and edge_id: default constructible, copyable, equality comparable ;
+ * - node_id invalid_node () const, edge_id invalid_edge () const, node_id root_node () const ;
+ * - node_id child_node (edge_id) const ;
+ * - children of a node, as child_edges (node_id) const: forward range of edge_id (vector, span,
+ *   lazy range...), and / or as sibling links: edge_id first_child_edge (node_id) const and
+ *   edge_id next_sibling_edge (edge_id) const, returning invalid_edge () if there is none.
+ * A bidirectional topology also provides:
+ * - node_id father_node (edge_id) const, edge_id father_edge (node_id) const.
+ * Walks over a concrete non virtual topology are fully inlined, with its own id types.
+ * Sibling links make walks allocation free: forward dfs is O(1) amortized per step with them, but
+ * must search the position of each node in its father child_edges without.
+ *
+ * downward_tree_topology and bidirectional_tree_topology are abstract classes satisfying the
+ * concept, with topology_node_id / topology_edge_id: walks instantiated on them use virtual calls.
+ * A class implementing them with final overrides can be walked either way.
+ */
+template <typename T> using tree_node_id_t = typename T::node_id;
+template <typename T> using tree_edge_id_t = typename T::edge_id;
+
+namespace Detail {
+	template <typename T>
+	using child_edges_t = decltype (std::declval<const T &> ().child_edges (
+	    std::declval<const tree_node_id_t<T> &> ()));
+
+	template <typename T>
+	using first_child_edge_t = decltype (std::declval<const T &> ().first_child_edge (
+	    std::declval<const tree_node_id_t<T> &> ()));
+	template <typename T>
+	using next_sibling_edge_t = decltype (std::declval<const T &> ().next_sibling_edge (
+	    std::declval<const tree_edge_id_t<T> &> ()));
+
+	template <typename T>
+	using has_child_edges_range_impl =
+	    bool_constant<is_range<child_edges_t<T>>::value &&
+	                  std::is_convertible<iterator_reference_t<range_iterator_t<child_edges_t<T>>>,
+	                                      tree_edge_id_t<T>>::value>;
+	template <typename T, typename = void> struct has_child_edges_range : std::false_type {};
+	template <typename T>
+	struct has_child_edges_range<T, void_t<has_child_edges_range_impl<T>>>
+	    : has_child_edges_range_impl<T> {};
+
+	template <typename T>
+	using has_sibling_links_impl =
+	    bool_constant<std::is_same<first_child_edge_t<T>, tree_edge_id_t<T>>::value &&
+	                  std::is_same<next_sibling_edge_t<T>, tree_edge_id_t<T>>::value>;
+	template <typename T, typename = void> struct has_sibling_links : std::false_type {};
+	template <typename T>
+	struct has_sibling_links<T, void_t<has_sibling_links_impl<T>>> : has_sibling_links_impl<T> {};
+
+	template <typename T>
+	using is_downward_tree_topology_impl = bool_constant<
+	    std::is_same<decltype (std::declval<const T &> ().invalid_node ()),
+	                 tree_node_id_t<T>>::value &&
+	    std::is_same<decltype (std::declval<const T &> ().invalid_edge ()),
+	                 tree_edge_id_t<T>>::value &&
+	    std::is_same<decltype (std::declval<const T &> ().root_node ()), tree_node_id_t<T>>::value &&
+	    std::is_same<decltype (std::declval<const T &> ().child_node (
+	                     std::declval<const tree_edge_id_t<T> &> ())),
+	                 tree_node_id_t<T>>::value &&
+	    (has_child_edges_range<T>::value || has_sibling_links<T>::value)>;
+
+	template <typename T>
+	using is_bidirectional_tree_topology_impl =
+	    bool_constant<std::is_same<decltype (std::declval<const T &> ().father_node (
+	                                   std::declval<const tree_edge_id_t<T> &> ())),
+	                               tree_node_id_t<T>>::value &&
+	                  std::is_same<decltype (std::declval<const T &> ().father_edge (
+	                                   std::declval<const tree_node_id_t<T> &> ())),
+	                               tree_edge_id_t<T>>::value>;
+} // namespace Detail
+
+template <typename T, typename = void> struct is_downward_tree_topology : std::false_type {};
+template <typename T>
+struct is_downward_tree_topology<T, void_t<Detail::is_downward_tree_topology_impl<T>>>
+    : Detail::is_downward_tree_topology_impl<T> {};
+
+template <typename T, typename = void>
+struct is_bidirectional_tree_topology : std::false_type {};
+template <typename T>
+struct is_bidirectional_tree_topology<T, void_t<Detail::is_bidirectional_tree_topology_impl<T>>>
+    : bool_constant<is_downward_tree_topology<T>::value &&
+                    Detail::is_bidirectional_tree_topology_impl<T>::value> {};
+
 /* Tree like structure, only for consultation.
+ * Virtual interface: adapter of any tree to the topology concept, with type erased ids.
  */
 class downward_tree_topology {
 	// Can navigate from root to leaves
 public:
+	using node_id = topology_node_id;
+	using edge_id = topology_edge_id;
+
 	virtual ~downward_tree_topology () = default;
 	virtual topology_node_id invalid_node () const = 0;
 	virtual topology_edge_id invalid_edge () const = 0;
 	virtual topology_node_id root_node () const = 0;
 	virtual topology_node_id child_node (topology_edge_id id) const = 0;
 	virtual std::vector<topology_edge_id> child_edges (topology_node_id id) const = 0;
+
+	// Default uses child_edges: override it with next_sibling_edge for allocation free walks.
+	virtual topology_edge_id first_child_edge (topology_node_id id) const {
+		auto edges = child_edges (id);
+		return edges.empty () ? invalid_edge () : edges.front ();
+	}
 };
 class bidirectional_tree_topology : public downward_tree_topology {
 	// Can navigate up too
 public:
 	virtual topology_node_id father_node (topology_edge_id id) const = 0;
 	virtual topology_edge_id father_edge (topology_node_id id) const = 0;
+
+	// Default searches the edge in the father child_edges (allocation, O(nb children)).
+	virtual topology_edge_id next_sibling_edge (topology_edge_id id) const {
+		auto edges = child_edges (father_node (id));
+		auto it = std::find (edges.begin (), edges.end (), id);
+		assert (it != edges.end ());
+		return ++it != edges.end () ? *it : invalid_edge ();
+	}
 };
 
+namespace Detail {
+	/* Sibling links of the virtual classes default to child_edges searches. Walks instantiated on
+	 * a class which does not override them use child_edges directly.
+	 */
+	using default_first_child_edge_t = decltype (&downward_tree_topology::first_child_edge);
+	using default_next_sibling_edge_t = decltype (&bidirectional_tree_topology::next_sibling_edge);
+	template <typename T, typename = void> struct has_default_sibling_links : std::false_type {};
+	template <typename T>
+	struct has_default_sibling_links<
+	    T, void_t<decltype (&T::first_child_edge), decltype (&T::next_sibling_edge)>>
+	    : bool_constant<
+	          std::is_same<decltype (&T::first_child_edge), default_first_child_edge_t>::value ||
+	          std::is_same<decltype (&T::next_sibling_edge), default_next_sibling_edge_t>::value> {};
+
+	/* Walks visiting all children of a node (input dfs, LinearizedTree) prefer a child_edges range:
+	 * it is contiguous for most trees, when links need one node access per child. Links are used
+	 * if there is no child_edges range, or if it is an allocated vector (virtual interface).
+	 */
+	template <typename T, typename = void> struct has_vector_child_edges : std::false_type {};
+	template <typename T>
+	struct has_vector_child_edges<T, void_t<child_edges_t<T>>>
+	    : std::is_same<child_edges_t<T>, std::vector<tree_edge_id_t<T>>> {};
+	template <typename T>
+	using use_sibling_links = bool_constant<
+	    has_sibling_links<T>::value &&
+	    (!has_child_edges_range<T>::value ||
+	     (has_vector_child_edges<T>::value && !has_default_sibling_links<T>::value))>;
+
+	template <typename Topology>
+	tree_edge_id_t<Topology> first_child_edge (std::true_type /*has_sibling_links*/,
+	                                           const Topology & tree,
+	                                           const tree_node_id_t<Topology> & node) {
+		return tree.first_child_edge (node);
+	}
+	template <typename Topology>
+	tree_edge_id_t<Topology> first_child_edge (std::false_type, const Topology & tree,
+	                                           const tree_node_id_t<Topology> & node) {
+		const auto & edges = tree.child_edges (node);
+		auto it = duck::adl_begin (edges);
+		return it != duck::adl_end (edges) ? tree_edge_id_t<Topology> (*it) : tree.invalid_edge ();
+	}
+
+	template <typename Topology>
+	tree_edge_id_t<Topology> next_sibling_edge (std::true_type /*has_sibling_links*/,
+	                                            const Topology & tree,
+	                                            const tree_edge_id_t<Topology> & edge) {
+		return tree.next_sibling_edge (edge);
+	}
+	template <typename Topology>
+	tree_edge_id_t<Topology> next_sibling_edge (std::false_type, const Topology & tree,
+	                                            const tree_edge_id_t<Topology> & edge) {
+		static_assert (is_bidirectional_tree_topology<Topology>::value,
+		               "next_sibling_edge: Topology must provide sibling links or be bidirectional");
+		const auto & edges = tree.child_edges (tree.father_node (edge));
+		auto it = duck::find (edges, edge);
+		assert (it != duck::adl_end (edges));
+		return ++it != duck::adl_end (edges) ? tree_edge_id_t<Topology> (*it) : tree.invalid_edge ();
+	}
+
+	// Call f (edge) for each child edge of node, in order, without allocation if possible.
+	template <typename Topology, typename F>
+	void for_each_child_edge (std::true_type /*use_sibling_links*/, const Topology & tree,
+	                          const tree_node_id_t<Topology> & node, F && f) {
+		auto invalid_edge = tree.invalid_edge ();
+		for (auto edge = tree.first_child_edge (node); edge != invalid_edge;
+		     edge = tree.next_sibling_edge (edge))
+			f (edge);
+	}
+	template <typename Topology, typename F>
+	void for_each_child_edge (std::false_type, const Topology & tree,
+	                          const tree_node_id_t<Topology> & node, F && f) {
+		for (auto && edge : tree.child_edges (node))
+			f (tree_edge_id_t<Topology> (edge));
+	}
+	template <typename Topology, typename F>
+	void for_each_child_edge (const Topology & tree, const tree_node_id_t<Topology> & node, F && f) {
+		for_each_child_edge (use_sibling_links<Topology>{}, tree, node, std::forward<F> (f));
+	}
+
+	// Call f (child node) for each valid child of node (invalid edges and nodes are skipped).
+	template <typename Topology, typename F>
+	void for_each_child_node (const Topology & tree, const tree_node_id_t<Topology> & node, F && f) {
+		auto invalid_edge = tree.invalid_edge ();
+		auto invalid_node = tree.invalid_node ();
+		for_each_child_edge (tree, node, [&](const tree_edge_id_t<Topology> & child_edge) {
+			if (child_edge != invalid_edge) {
+				auto child_node = tree.child_node (child_edge);
+				if (child_node != invalid_node)
+					f (child_node);
+			}
+		});
+	}
+
+	/* Push make_entry (child) on a DFS stack for each child of node, so that the first child is on
+	 * top (visited first). Returns the number of children pushed.
+	 * node is taken by copy, as it may be an element of stack.
+	 */
+	template <typename Topology, typename Stack, typename MakeEntry>
+	std::size_t push_children_in_visit_order (const Topology & tree, tree_node_id_t<Topology> node,
+	                                          Stack & stack, MakeEntry make_entry) {
+		auto nb_pending = stack.size ();
+		for_each_child_node (tree, node, [&](const tree_node_id_t<Topology> & child) {
+			stack.push_back (make_entry (child));
+		});
+		std::reverse (stack.begin () + static_cast<std::ptrdiff_t> (nb_pending), stack.end ());
+		return stack.size () - nb_pending;
+	}
+} // namespace Detail
+
+/* First child edge of node, next sibling of a child edge ; invalid_edge () if there is none.
+ * Use the sibling links of the topology if it has them, else child_edges (next_sibling_edge then
+ * requires a bidirectional topology, and is O(nb children)).
+ */
+template <typename Topology>
+tree_edge_id_t<Topology> first_child_edge (const Topology & tree,
+                                           const tree_node_id_t<Topology> & node) {
+	return Detail::first_child_edge (Detail::has_sibling_links<Topology>{}, tree, node);
+}
+template <typename Topology>
+tree_edge_id_t<Topology> next_sibling_edge (const Topology & tree,
+                                            const tree_edge_id_t<Topology> & edge) {
+	return Detail::next_sibling_edge (Detail::has_sibling_links<Topology>{}, tree, edge);
+}
+
 /* Fixed state DFS walk of the tree.
  * Does not use a stack to store nodes to be visited later.
  * Only relies on local rules.
  * Lower performance, as it needs to query the tree structure often.
  * Provides a forward iterator (can resume from anywhere).
  */
-class forward_tree_dfs_range {
+template <typename Topology> class basic_forward_tree_dfs_range {
+	static_assert (is_bidirectional_tree_topology<Topology>::value,
+	               "basic_forward_tree_dfs_range<Topology>: Topology must be a bidirectional tree "
+	               "topology");
+
 public:
+	using node_id = tree_node_id_t<Topology>;
+
 	class iterator {
 	public:
 		using iterator_category = std::forward_iterator_tag;
-		using value_type = topology_node_id;
+		using value_type = node_id;
 		using difference_type = std::ptrdiff_t;
 		using pointer = const value_type *;
 		using reference = value_type;
 
 		iterator () = default;
-		iterator (const bidirectional_tree_topology & tree, const topology_node_id & id)
-		    : tree_ (&tree), node_ (id) {}
+		iterator (const Topology & tree, const node_id & id) : tree_ (&tree), node_ (id) {}
 
 		// input / output
 		iterator & operator++ () {
-			auto child_edges = tree_->child_edges (node_);
-			if (!child_edges.empty ()) {
+			auto invalid_edge = tree_->invalid_edge ();
+			auto first_child = duck::first_child_edge (*tree_, node_);
+			if (first_child != invalid_edge) {
 				// Go to first child
-				node_ = tree_->child_node (child_edges.front ());
+				node_ = tree_->child_node (first_child);
 			} else {
 				// Go to "next sibling"
-				auto invalid_edge = tree_->invalid_edge ();
 				auto invalid_node = tree_->invalid_node ();
 				while (true) {
 					// First go up to father ; stop if we reach root (invalid_sth)
@@ -88,19 +327,18 @@ public:
 						node_ = invalid_node;
 						break;
 					}
-					node_ = tree_->father_node (edge);
-					if (node_ == invalid_node) {
+					auto father = tree_->father_node (edge);
+					if (father == invalid_node) {
+						node_ = invalid_node;
 						break;
 					}
-					// Go to next sibling. If no next sibling, just loop again.
-					auto father_child_edges = tree_->child_edges (node_);
-					auto previous_child_position = duck::find (father_child_edges, edge);
-					assert (previous_child_position != father_child_edges.end ()); // should be found
-					auto next_sibling_edge = ++previous_child_position;
-					if (next_sibling_edge != father_child_edges.end ()) {
-						node_ = tree_->child_node (*next_sibling_edge);
+					// Go to next sibling. If no next sibling, go up and loop again.
+					auto next_sibling = duck::next_sibling_edge (*tree_, edge);
+					if (next_sibling != invalid_edge) {
+						node_ = tree_->child_node (next_sibling);
 						break;
 					}
+					node_ = father;
 				}
 			}
 			return *this;
@@ -118,19 +356,22 @@ public:
 		}
 
 	private:
-		const bidirectional_tree_topology * tree_{nullptr};
-		topology_node_id node_{0};
+		const Topology * tree_{nullptr};
+		node_id node_{};
 	};
 
-	forward_tree_dfs_range (const bidirectional_tree_topology & tree) : tree_ (tree) {}
+	basic_forward_tree_dfs_range (const Topology & tree) : tree_ (tree) {}
 
 	iterator begin () const { return {tree_, tree_.root_node ()}; }
 	iterator end () const { return {tree_, tree_.invalid_node ()}; }
 
 private:
-	const bidirectional_tree_topology & tree_;
+	const Topology & tree_;
 };
-inline forward_tree_dfs_range forward_dfs_range (const bidirectional_tree_topology & tree) {
+using forward_tree_dfs_range = basic_forward_tree_dfs_range<bidirectional_tree_topology>;
+
+template <typename Topology>
+basic_forward_tree_dfs_range<Topology> forward_dfs_range (const Topology & tree) {
 	return {tree};
 }
 
@@ -138,38 +379,33 @@ inline forward_tree_dfs_range forward_dfs_range (const bidirectional_tree_topolo
  * Provide an input iterator only.
  * Calling begin() resets the walk : it can walked only once at a time, but multiple times.
  */
-class input_tree_dfs_range {
+template <typename Topology> class basic_input_tree_dfs_range {
+	static_assert (is_downward_tree_topology<Topology>::value,
+	               "basic_input_tree_dfs_range<Topology>: Topology must be a tree topology");
+
 public:
+	using node_id = tree_node_id_t<Topology>;
+
 	class iterator {
 		// end() is an iterator with range_ == nullptr
 		// comparisons just test if == end (), not internal position in the walk
 	public:
 		using iterator_category = std::input_iterator_tag;
-		using value_type = topology_node_id;
+		using value_type = node_id;
 		using difference_type = std::ptrdiff_t;
 		using pointer = void;
 		using reference = value_type;
 
 		iterator () = default;
-		iterator (const input_tree_dfs_range & r) : range_ (&r) {}
+		iterator (const basic_input_tree_dfs_range & r) : range_ (&r) {}
 
 		// input / output
 		iterator & operator++ () {
 			auto & stack = range_->nodes_to_visit_;
-			const auto & tree = range_->tree_;
-			auto invalid_node = tree.invalid_node ();
-			auto invalid_edge = tree.invalid_edge ();
-
 			auto node = stack.back ();
 			stack.pop_back ();
-			for (auto child_edge : tree.child_edges (node) | duck::reverse ()) {
-				if (child_edge != invalid_edge) {
-					auto child_node = tree.child_node (child_edge);
-					if (child_node != invalid_node) {
-						stack.push_back (child_node);
-					}
-				}
-			}
+			Detail::push_children_in_visit_order (range_->tree_, node, stack,
+			                                      [](const node_id & child) { return child; });
 			if (stack.empty ()) {
 				range_ = nullptr;
 			}
@@ -180,10 +416,10 @@ public:
 		bool operator!= (const iterator & o) const { return range_ != o.range_; }
 
 	private:
-		const input_tree_dfs_range * range_{nullptr};
+		const basic_input_tree_dfs_range * range_{nullptr};
 	};
 
-	input_tree_dfs_range (const downward_tree_topology & tree) : tree_ (tree) {}
+	basic_input_tree_dfs_range (const Topology & tree) : tree_ (tree) {}
 
 	iterator begin () const {
 		nodes_to_visit_.clear ();
@@ -198,13 +434,498 @@ public:
 	iterator end () const { return {}; }
 
 private:
-	const downward_tree_topology & tree_;
-	mutable std::deque<topology_node_id> nodes_to_visit_; // not a std::stack, we need clear()
+	const Topology & tree_;
+	mutable std::vector<node_id> nodes_to_visit_; // not a std::stack, we need clear()
 };
-inline input_tree_dfs_range input_dfs_range (const downward_tree_topology & tree) {
+using input_tree_dfs_range = basic_input_tree_dfs_range<downward_tree_topology>;
+
+template <typename Topology>
+basic_input_tree_dfs_range<Topology> input_dfs_range (const Topology & tree) {
 	return {tree};
 }
 
-// TODO input_bfs with queue
+/* Pre-order snapshot of a tree, in structure of arrays layout.
+ * Built once from a topology (one traversal), then walks are scans of contiguous arrays.
+ * Nodes are designated by their pre-order position (index) ; the root is at index 0.
+ * For each index, the arrays store the node id in the topology, the index of the parent
+ * (invalid_index for the root), the depth (0 for the root), and the size of the subtree (>= 1).
+ *
+ * The subtree of node i is the index interval [i, subtree_end (i)): subtree walks and ancestor
+ * checks are O(1) to set up, without querying the topology.
+ * The snapshot is not updated if the tree changes.
+ *
+ * NodeId is the node id type of the topologies it is built from (linearize (tree) deduces it).
+ * Building it from a concrete topology does not use virtual calls (see tree topology concept).
+ */
+template <typename NodeId> class BasicLinearizedTree {
+public:
+	using node_id = NodeId;
+	using index_type = std::int32_t;
+	static constexpr index_type invalid_index = -1;
+	using index_range = iterator_pair<integer_iterator<index_type>>;
+
+	// Children of a node: next sibling of child c is at c + subtree_size (c).
+	class child_range {
+	public:
+		class iterator {
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = index_type;
+			using difference_type = std::ptrdiff_t;
+			using pointer = const value_type *;
+			using reference = value_type;
+
+			iterator () = default;
+			iterator (index_type child, const index_type * subtree_sizes)
+			    : child_ (child), subtree_sizes_ (subtree_sizes) {}
+
+			// input / output
+			iterator & operator++ () { return child_ += subtree_sizes_[child_], *this; }
+			reference operator* () const { return child_; }
+			pointer operator-> () const { return &child_; }
+			bool operator== (const iterator & o) const { return child_ == o.child_; }
+			bool operator!= (const iterator & o) const { return child_ != o.child_; }
+
+			// forward
+			iterator operator++ (int) {
+				auto tmp = *this;
+				++*this;
+				return tmp;
+			}
+
+		private:
+			index_type child_{0};
+			const index_type * subtree_sizes_{nullptr};
+		};
+
+		child_range (index_type first, index_type last, const index_type * subtree_sizes)
+		    : first_ (first), last_ (last), subtree_sizes_ (subtree_sizes) {}
+
+		iterator begin () const { return {first_, subtree_sizes_}; }
+		iterator end () const { return {last_, subtree_sizes_}; }
+
+	private:
+		index_type first_;
+		index_type last_;
+		const index_type * subtree_sizes_;
+	};
+
+	BasicLinearizedTree () = default;
+	template <typename Topology> explicit BasicLinearizedTree (const Topology & tree) {
+		static_assert (is_downward_tree_topology<Topology>::value,
+		               "BasicLinearizedTree (Topology): Topology must be a tree topology");
+		static_assert (std::is_convertible<tree_node_id_t<Topology>, node_id>::value,
+		               "BasicLinearizedTree (Topology): incompatible node ids");
+		struct Pending {
+			tree_node_id_t<Topology> node;
+			index_type parent;
+			index_type depth;
+		};
+		std::vector<Pending> stack;
+		auto root = tree.root_node ();
+		if (root != tree.invalid_node ())
+			stack.push_back ({root, invalid_index, 0});
+		while (!stack.empty ()) {
+			auto pending = stack.back ();
+			stack.pop_back ();
+			assert (nodes_.size () < std::size_t (std::numeric_limits<index_type>::max ()));
+			auto index = static_cast<index_type> (nodes_.size ());
+			nodes_.push_back (pending.node);
+			parents_.push_back (pending.parent);
+			depths_.push_back (pending.depth);
+			Detail::push_children_in_visit_order (
+			    tree, pending.node, stack, [&](const tree_node_id_t<Topology> & child) {
+				    return Pending{child, index, pending.depth + 1};
+			    });
+		}
+		// Children are after their parent in pre-order: accumulate sizes from the end
+		subtree_sizes_.assign (nodes_.size (), 1);
+		for (auto i = size () - 1; i > 0; --i)
+			subtree_sizes_[std::size_t (parents_[std::size_t (i)])] += subtree_sizes_[std::size_t (i)];
+	}
+
+	index_type size () const noexcept { return static_cast<index_type> (nodes_.size ()); }
+	bool empty () const noexcept { return nodes_.empty (); }
+
+	// Arrays indexed by pre-order position
+	span<const node_id> nodes () const noexcept { return nodes_; }
+	span<const index_type> parents () const noexcept { return parents_; }
+	span<const index_type> depths () const noexcept { return depths_; }
+	span<const index_type> subtree_sizes () const noexcept { return subtree_sizes_; }
+
+	node_id node (index_type i) const { return nodes_[at (i)]; }
+	index_type parent (index_type i) const { return parents_[at (i)]; }
+	index_type depth (index_type i) const { return depths_[at (i)]; }
+	index_type subtree_size (index_type i) const { return subtree_sizes_[at (i)]; }
+	bool is_leaf (index_type i) const { return subtree_size (i) == 1; }
+
+	// Subtree of i (including i), in pre-order
+	index_type subtree_end (index_type i) const { return i + subtree_size (i); }
+	index_range subtree (index_type i) const { return range (i, subtree_end (i)); }
+	span<const node_id> subtree_nodes (index_type i) const {
+		return nodes ().subspan (i, subtree_size (i));
+	}
+	child_range children (index_type i) const {
+		return {i + 1, subtree_end (i), subtree_sizes_.data ()};
+	}
+
+	// True if descendant is in the subtree of ancestor (a node is its own ancestor)
+	bool is_ancestor (index_type ancestor, index_type descendant) const {
+		assert (0 <= descendant && descendant < size ());
+		return ancestor <= descendant && descendant < subtree_end (ancestor);
+	}
+
+private:
+	std::size_t at (index_type i) const {
+		assert (0 <= i && i < size ());
+		return static_cast<std::size_t> (i);
+	}
+
+	std::vector<node_id> nodes_;
+	std::vector<index_type> parents_;
+	std::vector<index_type> depths_;
+	std::vector<index_type> subtree_sizes_;
+};
+
+template <typename NodeId>
+constexpr typename BasicLinearizedTree<NodeId>::index_type
+    BasicLinearizedTree<NodeId>::invalid_index;
+
+using LinearizedTree = BasicLinearizedTree<topology_node_id>;
+
+template <typename Topology>
+BasicLinearizedTree<tree_node_id_t<Topology>> linearize (const Topology & tree) {
+	return BasicLinearizedTree<tree_node_id_t<Topology>> (tree);
+}
+
+/* BFS walk of the tree (level order), using a queue.
+ * Provide an input iterator only ; calling begin() resets the walk, like input dfs.
+ * The queue is made of two buffers reused between walks: the level being visited, and the
+ * children of its visited nodes (next level). The iterator depth () is the level of the node.
+ */
+template <typename Topology> class basic_input_tree_bfs_range {
+	static_assert (is_downward_tree_topology<Topology>::value,
+	               "basic_input_tree_bfs_range<Topology>: Topology must be a tree topology");
+
+public:
+	using node_id = tree_node_id_t<Topology>;
+
+	class iterator {
+		// end() is an iterator with range_ == nullptr
+	public:
+		using iterator_category = std::input_iterator_tag;
+		using value_type = node_id;
+		using difference_type = std::ptrdiff_t;
+		using pointer = void;
+		using reference = value_type;
 
+		iterator () = default;
+		iterator (const basic_input_tree_bfs_range & r) : range_ (&r) {}
+
+		// input / output
+		iterator & operator++ () {
+			auto & r = *range_;
+			auto & next_level = r.next_level_;
+			Detail::for_each_child_node (r.tree_, r.level_[r.position_], [&next_level](
+			                                                                 const node_id & child) {
+				next_level.push_back (child);
+			});
+			if (++r.position_ == r.level_.size ()) {
+				r.level_.swap (next_level);
+				next_level.clear ();
+				r.position_ = 0;
+				++r.depth_;
+				if (r.level_.empty ()) {
+					range_ = nullptr;
+				}
+			}
+			return *this;
+		}
+		reference operator* () const { return range_->level_[range_->position_]; }
+		bool operator== (const iterator & o) const { return range_ == o.range_; }
+		bool operator!= (const iterator & o) const { return range_ != o.range_; }
+
+		std::size_t depth () const { return range_->depth_; }
+
+	private:
+		const basic_input_tree_bfs_range * range_{nullptr};
+	};
+
+	basic_input_tree_bfs_range (const Topology & tree) : tree_ (tree) {}
+
+	iterator begin () const {
+		level_.clear ();
+		next_level_.clear ();
+		position_ = 0;
+		depth_ = 0;
+		auto root = tree_.root_node ();
+		if (root != tree_.invalid_node ()) {
+			level_.push_back (root);
+			return {*this};
+		} else {
+			return end ();
+		}
+	}
+	iterator end () const { return {}; }
+
+private:
+	const Topology & tree_;
+	mutable std::vector<node_id> level_;
+	mutable std::vector<node_id> next_level_;
+	mutable std::size_t position_{0};
+	mutable std::size_t depth_{0};
+};
+using input_tree_bfs_range = basic_input_tree_bfs_range<downward_tree_topology>;
+
+template <typename Topology>
+basic_input_tree_bfs_range<Topology> input_bfs_range (const Topology & tree) {
+	return {tree};
+}
+
+/* Levels of the tree: input range of the spans of nodes at depth 0, 1, 2... (BFS order).
+ * A span is valid until the next increment. Level buffers are reused between levels and walks.
+ */
+template <typename Topology> class basic_input_tree_levels_range {
+	static_assert (is_downward_tree_topology<Topology>::value,
+	               "basic_input_tree_levels_range<Topology>: Topology must be a tree topology");
+
+public:
+	using node_id = tree_node_id_t<Topology>;
+
+	class iterator {
+		// end() is an iterator with range_ == nullptr
+	public:
+		using iterator_category = std::input_iterator_tag;
+		using value_type = span<const node_id>;
+		using difference_type = std::ptrdiff_t;
+		using pointer = void;
+		using reference = value_type;
+
+		iterator () = default;
+		iterator (const basic_input_tree_levels_range & r) : range_ (&r) {}
+
+		// input / output
+		iterator & operator++ () {
+			auto & r = *range_;
+			auto & next_level = r.next_level_;
+			next_level.clear ();
+			for (const auto & node : r.level_)
+				Detail::for_each_child_node (
+				    r.tree_, node, [&next_level](const node_id & child) { next_level.push_back (child); });
+			r.level_.swap (next_level);
+			++r.depth_;
+			if (r.level_.empty ()) {
+				range_ = nullptr;
+			}
+			return *this;
+		}
+		reference operator* () const { return range_->level_; }
+		bool operator== (const iterator & o) const { return range_ == o.range_; }
+		bool operator!= (const iterator & o) const { return range_ != o.range_; }
+
+		std::size_t depth () const { return range_->depth_; }
+
+	private:
+		const basic_input_tree_levels_range * range_{nullptr};
+	};
+
+	basic_input_tree_levels_range (const Topology & tree) : tree_ (tree) {}
+
+	iterator begin () const {
+		level_.clear ();
+		depth_ = 0;
+		auto root = tree_.root_node ();
+		if (root != tree_.invalid_node ()) {
+			level_.push_back (root);
+			return {*this};
+		} else {
+			return end ();
+		}
+	}
+	iterator end () const { return {}; }
+
+private:
+	const Topology & tree_;
+	mutable std::vector<node_id> level_;
+	mutable std::vector<node_id> next_level_;
+	mutable std::size_t depth_{0};
+};
+using input_tree_levels_range = basic_input_tree_levels_range<downward_tree_topology>;
+
+template <typename Topology>
+basic_input_tree_levels_range<Topology> input_levels_range (const Topology & tree) {
+	return {tree};
+}
+
+/* Post-order DFS walk of the tree (children before their father), using a stack.
+ * Provide an input iterator only ; calling begin() resets the walk, like input dfs.
+ * The stack (reused between walks) stores the pending siblings of the nodes of the current path,
+ * and whether their children were already pushed.
+ */
+template <typename Topology> class basic_input_tree_post_order_range {
+	static_assert (is_downward_tree_topology<Topology>::value,
+	               "basic_input_tree_post_order_range<Topology>: Topology must be a tree topology");
+
+public:
+	using node_id = tree_node_id_t<Topology>;
+
+	class iterator {
+		// end() is an iterator with range_ == nullptr
+	public:
+		using iterator_category = std::input_iterator_tag;
+		using value_type = node_id;
+		using difference_type = std::ptrdiff_t;
+		using pointer = void;
+		using reference = value_type;
+
+		iterator () = default;
+		iterator (const basic_input_tree_post_order_range & r) : range_ (&r) {}
+
+		// input / output
+		iterator & operator++ () {
+			auto & stack = range_->stack_;
+			stack.pop_back ();
+			if (stack.empty ()) {
+				range_ = nullptr;
+			} else {
+				range_->descend ();
+			}
+			return *this;
+		}
+		reference operator* () const { return range_->stack_.back ().node; }
+		bool operator== (const iterator & o) const { return range_ == o.range_; }
+		bool operator!= (const iterator & o) const { return range_ != o.range_; }
+
+	private:
+		const basic_input_tree_post_order_range * range_{nullptr};
+	};
+
+	basic_input_tree_post_order_range (const Topology & tree) : tree_ (tree) {}
+
+	iterator begin () const {
+		stack_.clear ();
+		auto root = tree_.root_node ();
+		if (root != tree_.invalid_node ()) {
+			stack_.push_back ({root, false});
+			descend ();
+			return {*this};
+		} else {
+			return end ();
+		}
+	}
+	iterator end () const { return {}; }
+
+private:
+	struct Pending {
+		node_id node;
+		bool children_pushed;
+	};
+
+	// Push children of the top node until it is a node with its children already visited
+	void descend () const {
+		while (!stack_.back ().children_pushed) {
+			stack_.back ().children_pushed = true;
+			Detail::push_children_in_visit_order (
+			    tree_, stack_.back ().node, stack_,
+			    [](const node_id & child) { return Pending{child, false}; });
+		}
+	}
+
+	const Topology & tree_;
+	mutable std::vector<Pending> stack_;
+};
+using input_tree_post_order_range = basic_input_tree_post_order_range<downward_tree_topology>;
+
+template <typename Topology>
+basic_input_tree_post_order_range<Topology> input_post_order_range (const Topology & tree) {
+	return {tree};
+}
+
+namespace Detail {
+	template <typename Topology, typename LeafFn>
+	using tree_reduce_result_t = decay_t<decltype (
+	    std::declval<LeafFn &> () (std::declval<const tree_node_id_t<Topology> &> ()))>;
+
+	// Stacks of a post-order reduction walk, reused between walks.
+	template <typename Topology, typename T> struct TreeReduceScratch {
+		struct Entry {
+			tree_node_id_t<Topology> node;
+			std::size_t nb_children;  // If expanded
+			std::size_t results_base; // If expanded: position of the first child result
+			bool expanded;
+		};
+		std::vector<Entry> stack;
+		std::vector<T> results; // Results of the done children of expanded entries, in order
+	};
+
+	/* Post-order reduction of the subtree of root, without recursion (chains of any depth).
+	 * Returns true when done, with the result in scratch.results.back ().
+	 * Returns false when budget nodes have been expanded and at least two nodes are pending (not
+	 * expanded): the walk can then be split (see ParallelTreeReduce).
+	 */
+	template <typename Topology, typename T, typename LeafFn, typename CombineFn>
+	bool tree_reduce_walk (const Topology & tree, const tree_node_id_t<Topology> & root,
+	                       LeafFn & leaf_fn, CombineFn & combine_fn,
+	                       TreeReduceScratch<Topology, T> & scratch, std::size_t budget) {
+		auto & stack = scratch.stack;
+		auto & results = scratch.results;
+		stack.clear ();
+		results.clear ();
+		stack.push_back ({root, 0, 0, false});
+		std::size_t nb_pending = 1;
+		std::size_t nb_expanded = 0;
+		while (!stack.empty ()) {
+			auto top = stack.size () - 1;
+			if (!stack[top].expanded) {
+				if (nb_expanded >= budget && nb_pending >= 2)
+					return false;
+				auto nb_children = push_children_in_visit_order (
+				    tree, stack[top].node, stack, [](const tree_node_id_t<Topology> & child) {
+					    using Entry = typename TreeReduceScratch<Topology, T>::Entry;
+					    return Entry{child, 0, 0, false};
+				    });
+				auto & entry = stack[top];
+				entry.expanded = true;
+				entry.nb_children = nb_children;
+				entry.results_base = results.size ();
+				nb_pending += entry.nb_children - 1;
+				++nb_expanded;
+			} else {
+				// All children are done
+				auto first_child_result = results.begin () +
+				                          static_cast<std::ptrdiff_t> (stack[top].results_base);
+				T acc = leaf_fn (stack[top].node);
+				for (auto it = first_child_result; it != results.end (); ++it)
+					acc = combine_fn (std::move (acc), std::move (*it));
+				results.erase (first_child_result, results.end ());
+				results.push_back (std::move (acc));
+				stack.pop_back ();
+			}
+		}
+		return true;
+	}
+} // namespace Detail
+
+/* Bottom-up reduction of a tree (subtree sizes, sums, hashes...). The result of a node is
+ *   combine_fn (... combine_fn (leaf_fn (node), result (child_1)) ..., result (child_k))
+ * with its children in order: leaf_fn (node) for a leaf. Returns the result of the root, or T{}
+ * for an empty tree. T (type of leaf_fn (node)) must be default constructible and movable.
+ * > auto nb_nodes = duck::tree_reduce (tree, [](node_id) { return 1; }, std::plus<int> ());
+ * The walk is a post-order with an explicit stack: it does not recurse, chains of any depth are
+ * supported.
+ */
+template <typename Topology, typename LeafFn, typename CombineFn>
+Detail::tree_reduce_result_t<Topology, LeafFn> tree_reduce (const Topology & tree, LeafFn leaf_fn,
+                                                             CombineFn combine_fn) {
+	static_assert (is_downward_tree_topology<Topology>::value,
+	               "tree_reduce: Topology must be a tree topology");
+	using T = Detail::tree_reduce_result_t<Topology, LeafFn>;
+	auto root = tree.root_node ();
+	if (root == tree.invalid_node ())
+		return T{};
+	Detail::TreeReduceScratch<Topology, T> scratch;
+	Detail::tree_reduce_walk (tree, root, leaf_fn, combine_fn, scratch,
+	                          std::numeric_limits<std::size_t>::max ());
+	return std::move (scratch.results.back ());
+}
 } // namespace duck
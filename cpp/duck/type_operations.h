@@ -4,6 +4,7 @@
 
 #include <cassert>
 #include <type_traits>
+#include <utility>
 
 namespace duck {
 namespace Type {
@@ -17,9 +17,11 @@ using std::add_const_t;
 using std::add_lvalue_reference_t;
 using std::aligned_storage_t;
 using std::common_type_t;
+using std::conditional_t;
 using std::decay_t;
 using std::enable_if_t;
 using std::remove_cv_t;
+using std::remove_pointer_t;
 using std::remove_reference_t;
 #else
 template <typename T> using add_const_t = typename std::add_const<T>::type;
@@ -27,10 +29,13 @@ template <typename T> using add_lvalue_reference_t = typename std::add_lvalue_re
 template <std::size_t Len, std::size_t Align>
 using aligned_storage_t = typename std::aligned_storage<Len, Align>::type;
 template <typename... Types> using common_type_t = typename std::common_type<Types...>::type;
+template <bool B, typename T, typename F>
+using conditional_t = typename std::conditional<B, T, F>::type;
 template <typename T> using decay_t = typename std::decay<T>::type;
 template <bool B> using enable_if_t = typename std::enable_if<B>::type;
 template <typename T> using remove_reference_t = typename std::remove_reference<T>::type;
 template <typename T> using remove_cv_t = typename std::remove_cv<T>::type;
+template <typename T> using remove_pointer_t = typename std::remove_pointer<T>::type;
 #endif
 
 #if __cplusplus >= 201703L
@@ -24,24 +24,44 @@ namespace Variant {
 	};
 
 	namespace Detail {
+		/* Map from index to type for a pack: IndexedTypes<Args...> derives from IndexedType<i, Ti>.
+		 * Overload resolution on the bases selects a type by index, or an index by type, with one
+		 * class instantiation per pack instead of a recursion on the pack for each request.
+		 */
+		template <int n, typename T> struct IndexedType {};
+		template <typename Indexes, typename... Args> struct IndexedTypesImpl;
+		template <int... Indexes, typename... Args>
+		struct IndexedTypesImpl<std::integer_sequence<int, Indexes...>, Args...>
+		    : IndexedType<Indexes, Args>... {};
+		template <typename... Args>
+		using IndexedTypes =
+		    IndexedTypesImpl<std::make_integer_sequence<int, sizeof...(Args)>, Args...>;
+
+		// Wrapped in a tag so that cv-qualified and array types are returned unchanged
+		template <typename T> struct TypeTag { using Type = T; };
+		template <int n, typename T> TypeTag<T> select_type_for_index (IndexedType<n, T>);
+		template <typename T, int n>
+		std::integral_constant<int, n> select_index_for_type (IndexedType<n, T>);
+
 		// Get nth type in a pack (SFINAE fails if bad index)
-		template <int n, typename... Args> struct GetNthType;
-		template <typename First, typename... Others> struct GetNthType<0, First, Others...> {
-			using Type = First;
-		};
-		template <int n, typename First, typename... Others> struct GetNthType<n, First, Others...> {
-			using Type = typename GetNthType<n - 1, Others...>::Type;
+		template <typename Void, int n, typename... Args> struct GetNthTypeImpl {};
+		template <int n, typename... Args>
+		struct GetNthTypeImpl<void_t<decltype (select_type_for_index<n> (IndexedTypes<Args...>{}))>,
+		                      n, Args...> {
+			using Type = typename decltype (select_type_for_index<n> (IndexedTypes<Args...>{}))::Type;
 		};
+		template <int n, typename... Args> struct GetNthType : GetNthTypeImpl<void, n, Args...> {};
 
-		// Get index of a type in a pack (SFINAE fails if not found)
-		template <typename T, typename... Args> struct GetTypePos;
-		template <typename T, typename... Others> struct GetTypePos<T, T, Others...> {
-			enum { value = 0 };
-		};
-		template <typename T, typename First, typename... Others>
-		struct GetTypePos<T, First, Others...> {
-			enum { value = GetTypePos<T, Others...>::value + 1 };
+		// Get index of a type in a pack (SFINAE fails if not found, or found multiple times)
+		template <typename Void, typename T, typename... Args> struct GetTypePosImpl {};
+		template <typename T, typename... Args>
+		struct GetTypePosImpl<void_t<decltype (select_index_for_type<T> (IndexedTypes<Args...>{}))>,
+		                      T, Args...> {
+			enum {
+				value = decltype (select_index_for_type<T> (IndexedTypes<Args...>{}))::value
+			};
 		};
+		template <typename T, typename... Args> struct GetTypePos : GetTypePosImpl<void, T, Args...> {};
 
 		// Wrap operator ()
 		template <typename Visitor, typename ReturnType, typename T>
@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <cstdlib>
+#include <duck/simd.h>
 
 namespace duck {
 // string_view
@@ -32,4 +33,25 @@ std::vector<string_view> split (char separator, string_view text) {
 	}
 	return r;
 }
+
+static_assert (Detail::CharSetDelimiter::max_simd_separators == Detail::simd_max_find_any_set,
+               "CharSetDelimiter must store the sets searched by simd_find_any");
+Detail::CharSetDelimiter::CharSetDelimiter (string_view separators_arg)
+    : use_table (static_cast<std::size_t> (separators_arg.size ()) > max_simd_separators) {
+	if (use_table) {
+		for (char c : separators_arg)
+			is_separator[static_cast<unsigned char> (c)] = true;
+	} else {
+		nb_separators = static_cast<std::size_t> (separators_arg.size ());
+		std::copy (separators_arg.begin (), separators_arg.end (), separators);
+	}
+}
+const char * Detail::CharSetDelimiter::find (const char * begin, const char * end) const {
+	if (!use_table) {
+		auto n = static_cast<std::size_t> (end - begin);
+		return begin + simd_find_any (begin, n, separators, nb_separators);
+	}
+	return std::find_if (begin, end,
+	                     [this](char c) { return is_separator[static_cast<unsigned char> (c)]; });
+}
 } // namespace duck
@@ -3,6 +3,10 @@
 // View structures
 // STATUS: prototype, NSC
 
+#include <cstddef>
+#include <cstring>
+#include <duck/range/range.h>
+#include <iterator>
 #include <vector>
 
 #include <gsl.h>
@@ -28,4 +32,117 @@ bool is_prefix_of (char prefix, string_view str);
 
 // Split at separator. Does not remove empty parts, does not trim whitespace.
 std::vector<string_view> split (char separator, string_view text);
+
+/* Lazy split: range of the parts of text, the same as split () but without allocation.
+ * Parts are string_view into text, found one at a time during iteration.
+ * The text must outlive the range (separators are copied). Iterators are forward iterators.
+ *
+ * split_range (sep, text): parts separated by the char sep (memchr search).
+ * split_range_any (separators, text): parts separated by any char of separators.
+ * Up to 16 separators are searched with SSE2 / AVX2, more with a lookup table.
+ */
+namespace Detail {
+	// Delimiter search policies: find (begin, end) returns the first delimiter, or end.
+	struct CharDelimiter {
+		char separator;
+		const char * find (const char * begin, const char * end) const {
+			auto p = begin != end ? std::memchr (begin, separator, static_cast<std::size_t> (end - begin))
+			                      : nullptr;
+			return p != nullptr ? static_cast<const char *> (p) : end;
+		}
+	};
+	struct CharSetDelimiter {
+		// Sets too large for the SIMD search get their lookup table here, once per range.
+		// Small sets are copied, so separators need not outlive the range.
+		explicit CharSetDelimiter (string_view separators);
+		const char * find (const char * begin, const char * end) const;
+
+		static constexpr std::size_t max_simd_separators = 16; // simd_max_find_any_set
+		char separators[max_simd_separators] = {};
+		std::size_t nb_separators{0};
+		bool use_table{false};
+		bool is_separator[256] = {};
+	};
+} // namespace Detail
+
+template <typename Delimiter> class lazy_split_range {
+public:
+	class iterator {
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = string_view;
+		using difference_type = std::ptrdiff_t;
+		using pointer = const string_view *;
+		using reference = string_view;
+
+		iterator () = default;
+		// Iterator on the part starting at part_begin
+		iterator (const char * part_begin, const char * text_end, const Delimiter & delimiter)
+		    : part_begin_ (part_begin),
+		      part_end_ (delimiter.find (part_begin, text_end)),
+		      text_end_ (text_end),
+		      delimiter_ (&delimiter),
+		      done_ (false) {}
+
+		// Input / output
+		iterator & operator++ () {
+			if (part_end_ == text_end_) {
+				done_ = true;
+			} else {
+				part_begin_ = part_end_ + 1; // Skip separator
+				part_end_ = delimiter_->find (part_begin_, text_end_);
+			}
+			return *this;
+		}
+		reference operator* () const { return {part_begin_, part_end_}; }
+		bool operator== (const iterator & o) const {
+			return done_ == o.done_ && (done_ || part_begin_ == o.part_begin_);
+		}
+		bool operator!= (const iterator & o) const { return !(*this == o); }
+
+		// Forward
+		iterator operator++ (int) {
+			iterator tmp (*this);
+			++*this;
+			return tmp;
+		}
+
+	private:
+		const char * part_begin_{nullptr};
+		const char * part_end_{nullptr};
+		const char * text_end_{nullptr};
+		const Delimiter * delimiter_{nullptr};
+		bool done_{true};
+	};
+
+	// If has_parts is false, the range is empty (not even an empty part).
+	lazy_split_range (const Delimiter & delimiter, string_view text, bool has_parts = true)
+	    : delimiter_ (delimiter), text_ (text), has_parts_ (has_parts) {}
+
+	iterator begin () const {
+		if (has_parts_)
+			return {text_.data (), text_.data () + text_.size (), delimiter_};
+		else
+			return {};
+	}
+	iterator end () const { return {}; }
+	SizeHint size_hint () const {
+		// Parts are separated by at least one char
+		auto size = static_cast<std::ptrdiff_t> (text_.size ());
+		return {SizeHint::upper_bound, has_parts_ ? size + 1 : 0};
+	}
+
+private:
+	Delimiter delimiter_;
+	string_view text_;
+	bool has_parts_;
+};
+
+inline lazy_split_range<Detail::CharDelimiter> split_range (char separator, string_view text) {
+	return {Detail::CharDelimiter{separator}, text};
+}
+inline lazy_split_range<Detail::CharSetDelimiter> split_range_any (string_view separators,
+                                                                   string_view text) {
+	return {Detail::CharSetDelimiter{separators}, text};
+}
 } // namespace duck
@@ -0,0 +1,106 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+
+#include <cstdlib>
+#include <new>
+#include <string>
+
+#include <duck/frozen_compact.h>
+
+// Count heap allocations to check that compaction uses a single one.
+static int nb_allocations = 0;
+static int nb_deallocations = 0;
+// Not inlined: GCC reports false mismatched new / delete pairs otherwise.
+[[gnu::noinline]] void * operator new (std::size_t size) {
+	++nb_allocations;
+	if (auto p = std::malloc (size > 0 ? size : 1))
+		return p;
+	throw std::bad_alloc ();
+}
+[[gnu::noinline]] void operator delete (void * p) noexcept {
+	if (p != nullptr)
+		++nb_deallocations;
+	std::free (p);
+}
+[[gnu::noinline]] void operator delete (void * p, std::size_t) noexcept {
+	::operator delete (p);
+}
+
+struct Index {
+	duck::CompactVector<int> keys;
+	duck::CompactVector<duck::CompactString> names;
+	int version{0};
+};
+namespace duck {
+template <> struct CompactTraits<Index> {
+	static std::size_t compact_size (const Index & i) {
+		return duck::compact_size (i.keys) + duck::compact_size (i.names);
+	}
+	static void compact (void * where, const Index & i, CompactArena & arena) {
+		::new (where) Index{arena.copy (i.keys), arena.copy (i.names), i.version};
+	}
+};
+} // namespace duck
+
+static bool in_block (const void * p, const void * object, std::size_t block_size) {
+	auto c = static_cast<const char *> (p);
+	auto o = static_cast<const char *> (object);
+	return o - 256 <= c && c < o + block_size;
+}
+
+TEST_CASE ("freeze_compact") {
+	auto builder = duck::make_freezable<Index> ();
+	for (int i = 0; i < 100; ++i) {
+		builder->keys.push_back (i);
+		auto name = "a name long enough to not be a small string #" + std::to_string (i);
+		builder->names.emplace_back (name.c_str ());
+	}
+	builder->version = 3;
+	const auto size = duck::compact_size (*builder);
+	CHECK (size >= 100 * sizeof (int) + 100 * sizeof (duck::CompactString));
+
+	nb_allocations = 0;
+	nb_deallocations = 0;
+	auto frozen = duck::freeze_compact (std::move (builder));
+	CHECK (nb_allocations == 1);
+	CHECK (!builder);
+
+	// Content is the same, and lives in the block
+	CHECK (frozen->version == 3);
+	REQUIRE (frozen->keys.size () == 100);
+	REQUIRE (frozen->names.size () == 100);
+	for (int i = 0; i < 100; ++i) {
+		CHECK (frozen->keys[i] == i);
+		auto name = "a name long enough to not be a small string #" + std::to_string (i);
+		CHECK (frozen->names[i].c_str () == name);
+		CHECK (in_block (frozen->names[i].data (), frozen.get (), size + 1024));
+	}
+	CHECK (in_block (frozen->keys.data (), frozen.get (), size + 1024));
+	CHECK (in_block (frozen->names.data (), frozen.get (), size + 1024));
+
+	// Copies are heap containers, independent of the block
+	nb_allocations = 0;
+	auto copy = frozen->keys;
+	CHECK (nb_allocations == 1);
+	CHECK (copy.get_allocator ().arena () == nullptr);
+
+	nb_deallocations = 0;
+	frozen = duck::FrozenPtr<Index> ();
+	CHECK (nb_deallocations == 1);
+	CHECK (copy[99] == 99);
+}
+
+TEST_CASE ("make_frozen_compact") {
+	duck::CompactVector<duck::CompactVector<int>> v{{1, 2, 3}, {}, {4, 5}};
+	nb_allocations = 0;
+	auto frozen = duck::make_frozen_compact (v);
+	CHECK (nb_allocations == 1);
+	CHECK (*frozen == v);
+	CHECK ((*frozen)[0].get_allocator ().arena () != nullptr);
+
+	// Allocations not fitting in the arena spill to the heap
+	duck::CompactArena arena;
+	auto spilled = arena.copy (v);
+	CHECK (spilled == v);
+	CHECK (arena.spilled () > 0);
+}
@@ -40,6 +40,8 @@ TEST_CASE ("FrozenSharedPtr") {
 	CHECK (*sp == 44);
 	CHECK (*spcpy == 44);
 	CHECK (sp.get () == spcpy.get ());
+	CHECK (sp == spcpy);
+	CHECK (sp != duck::make_frozen<int> (44)); // Identity, not value
 
 	duck::FrozenPtr<Base> basep{duck::make_freezable<Derived> ().freeze ()};
 }
@@ -0,0 +1,92 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+
+#include <duck/frozen_ref.h>
+#include <string>
+#include <vector>
+
+TEST_CASE ("FreezableRef") {
+	auto empty = duck::FreezableRef<int>{};
+	CHECK (!empty);
+	CHECK (empty.get () == nullptr);
+
+	auto p = duck::make_freezable_ref<int> (42);
+	CHECK (p);
+	CHECK (*p == 42);
+	*p = 3;
+	CHECK (*p == 3);
+
+	auto p2 = std::move (p);
+	CHECK (p2);
+	CHECK (!p);
+	CHECK (*p2 == 3);
+}
+
+TEST_CASE ("FrozenRef") {
+	static_assert (sizeof (duck::FrozenRef<std::string>) == sizeof (void *), "one pointer");
+
+	auto p = duck::make_freezable_ref<std::string> ("hello");
+	p->append (" world");
+	auto sp = std::move (p).freeze ();
+	CHECK (!p);
+	CHECK (sp);
+	CHECK (*sp == "hello world");
+	CHECK (sp.use_count () == 1);
+
+	{
+		auto spcpy = sp;
+		CHECK (sp.get () == spcpy.get ());
+		CHECK (sp.use_count () == 2);
+
+		auto spmoved = std::move (spcpy);
+		CHECK (!spcpy);
+		CHECK (spcpy.use_count () == 0);
+		CHECK (sp.use_count () == 2);
+	}
+	CHECK (sp.use_count () == 1);
+
+	auto other = duck::make_frozen_ref<std::string> (3, 'a');
+	CHECK (*other == "aaa");
+	other = sp;
+	CHECK (other.get () == sp.get ());
+	CHECK (sp.use_count () == 2);
+	other.reset ();
+	CHECK (!other);
+	CHECK (sp.use_count () == 1);
+}
+
+struct CountDestructions {
+	int & counter;
+	CountDestructions (int & c) : counter (c) {}
+	~CountDestructions () { ++counter; }
+};
+
+TEST_CASE ("LocalFrozenRef") {
+	int destructions = 0;
+	{
+		auto p = duck::LocalFrozenRef<CountDestructions>::make (destructions);
+		auto copies = std::vector<duck::LocalFrozenRef<CountDestructions>> (10, p);
+		CHECK (p.use_count () == 11);
+		copies.clear ();
+		CHECK (p.use_count () == 1);
+		CHECK (destructions == 0);
+	}
+	CHECK (destructions == 1);
+
+	{
+		// Destroying an unfrozen ref destroys the object
+		auto p = duck::LocalFreezableRef<CountDestructions>::make (destructions);
+	}
+	CHECK (destructions == 2);
+
+	{
+		// Move assignment destroys the previous object, and leaves the source null
+		auto p = duck::LocalFreezableRef<CountDestructions>::make (destructions);
+		auto q = duck::LocalFreezableRef<CountDestructions>::make (destructions);
+		p = std::move (q);
+		CHECK (destructions == 3);
+		CHECK (p);
+		CHECK (!q);
+	}
+	CHECK (destructions == 4);
+}
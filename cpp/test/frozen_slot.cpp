@@ -0,0 +1,85 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <duck/frozen_slot.h>
+
+TEST_CASE ("store / load") {
+	duck::FrozenSlot<int> slot;
+	CHECK (!slot.load ());
+
+	slot.store (duck::make_frozen<int> (42));
+	CHECK (*slot.load () == 42);
+	CHECK (slot.retired_count () == 0); // No reader, reclaimed immediately
+
+	auto reader = slot.reader ();
+	auto snapshot = reader.load ();
+	CHECK (*snapshot == 42);
+
+	slot.store (duck::make_freezable<int> (3).freeze ());
+	CHECK (*reader.load () == 3);
+	CHECK (*snapshot == 42); // Old snapshot kept alive by reference
+}
+
+TEST_CASE ("reader limit") {
+	duck::FrozenSlot<int> slot (duck::make_frozen<int> (1), 2);
+	{
+		auto r1 = slot.reader ();
+		auto r2 = slot.reader ();
+		CHECK_THROWS_AS (slot.reader (), std::length_error);
+		CHECK_THROWS_AS (slot.load (), std::length_error);
+	}
+	// Released
+	auto r3 = slot.reader ();
+	CHECK (*r3.load () == 1);
+}
+
+struct CountDestructions {
+	int value;
+	std::atomic<int> * counter;
+	CountDestructions (int v, std::atomic<int> & c) : value (v), counter (&c) {}
+	~CountDestructions () { ++*counter; }
+};
+
+TEST_CASE ("concurrent readers") {
+	std::atomic<int> destructions{0};
+	constexpr int nb_publications = 1000;
+	{
+		duck::FrozenSlot<CountDestructions> slot (
+		    duck::make_frozen<CountDestructions> (0, destructions), 4);
+
+		std::atomic<bool> done{false};
+		std::atomic<bool> readers_ok{true};
+		std::vector<std::thread> readers;
+		for (int t = 0; t < 4; ++t) {
+			readers.emplace_back ([&] {
+				auto reader = slot.reader ();
+				int last = 0;
+				while (!done.load ()) {
+					auto snapshot = reader.load ();
+					// Published values are increasing
+					if (!snapshot || snapshot->value < last) {
+						readers_ok = false;
+						break;
+					}
+					last = snapshot->value;
+				}
+			});
+		}
+		for (int i = 1; i <= nb_publications; ++i)
+			slot.store (duck::make_frozen<CountDestructions> (i, destructions));
+		done = true;
+		for (auto & t : readers)
+			t.join ();
+		CHECK (readers_ok);
+
+		slot.reclaim ();
+		CHECK (slot.retired_count () == 0);
+		CHECK (destructions == nb_publications); // All but the current one
+	}
+	CHECK (destructions == nb_publications + 1);
+}
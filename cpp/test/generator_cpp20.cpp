@@ -0,0 +1,164 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <duck/generator.h>
+#include <duck/range/algorithm.h>
+#include <duck/range/combinator.h>
+
+static duck::generator<int> iota (int from, int to) {
+	for (int i = from; i < to; ++i)
+		co_yield i;
+}
+
+TEST_CASE ("generator basics") {
+	CHECK (duck::is_range<duck::generator<int>>::value);
+	CHECK (duck::is_range<duck::generator<int> &>::value);
+	CHECK ((std::is_same<duck::iterator_category_t<duck::generator<int>::iterator>,
+	                     std::input_iterator_tag>::value));
+
+	std::vector<int> values;
+	for (int i : iota (0, 5))
+		values.push_back (i);
+	CHECK (values == (std::vector<int>{0, 1, 2, 3, 4}));
+	CHECK (duck::empty (iota (0, 0)));
+	CHECK (duck::empty (duck::generator<int>{}));
+
+	// Lazy: nothing runs before begin, begin is idempotent
+	int nb_started = 0;
+	auto counted = [&nb_started]() -> duck::generator<int> {
+		++nb_started;
+		co_yield 42;
+	};
+	auto g = counted ();
+	CHECK (nb_started == 0);
+	CHECK (*g.begin () == 42);
+	CHECK (*g.begin () == 42);
+	CHECK (nb_started == 1);
+
+	// Move
+	auto moved = std::move (g);
+	CHECK (g.begin () == g.end ());
+	CHECK (*moved.begin () == 42);
+}
+
+TEST_CASE ("generator yields references") {
+	std::vector<std::unique_ptr<int>> owned;
+	for (int i = 0; i < 3; ++i)
+		owned.push_back (std::make_unique<int> (i));
+
+	// Lvalue references to the source
+	auto refs = [&owned]() -> duck::generator<std::unique_ptr<int> &> {
+		for (auto & p : owned)
+			co_yield p;
+	};
+	for (auto & p : refs ())
+		*p += 10;
+	CHECK (*owned[2] == 12);
+
+	// No copy for generator<T> lvalues and temporaries, moving out is possible
+	auto values = []() -> duck::generator<std::unique_ptr<int>> {
+		auto p = std::make_unique<int> (1);
+		co_yield p;
+		co_yield std::make_unique<int> (2);
+	};
+	std::vector<std::unique_ptr<int>> taken;
+	for (auto & p : values ())
+		taken.push_back (std::move (p));
+	REQUIRE (taken.size () == 2);
+	CHECK (*taken[0] == 1);
+	CHECK (*taken[1] == 2);
+
+	// Const values and convertible values are copied in the frame
+	auto strings = []() -> duck::generator<std::string> {
+		const std::string s = "const";
+		co_yield s;
+		co_yield "literal";
+	};
+	CHECK (duck::to_container<std::vector<std::string>> (strings ()) ==
+	       (std::vector<std::string>{"const", "literal"}));
+
+	// generator<const T &> accepts temporaries
+	auto temporaries = []() -> duck::generator<const std::string &> {
+		for (int i = 0; i < 3; ++i)
+			co_yield std::to_string (i);
+	};
+	CHECK (duck::to_container<std::vector<std::string>> (temporaries ()) ==
+	       (std::vector<std::string>{"0", "1", "2"}));
+}
+
+struct Node {
+	int value;
+	std::vector<Node> children;
+};
+static duck::generator<const Node &> pre_order (const Node & node) {
+	co_yield node;
+	for (auto & child : node.children)
+		for (auto & n : pre_order (child))
+			co_yield n;
+}
+
+TEST_CASE ("generator with combinators") {
+	// Rvalue and lvalue generators in pipelines
+	auto squares = iota (0, 10) | duck::filter ([](int i) { return i % 2 == 0; }) |
+	               duck::map ([](int i) { return i * i; });
+	CHECK (duck::to_container<std::vector<int>> (squares) == (std::vector<int>{0, 4, 16, 36, 64}));
+	auto g = iota (0, 100);
+	CHECK (duck::count_if (g, [](int i) { return i % 10 == 0; }) == 10);
+	CHECK (duck::find (iota (0, 10), 7) != duck::generator<int>::iterator{});
+
+	// Tree walk
+	Node tree{0, {{1, {{2, {}}, {3, {}}}}, {4, {}}, {5, {{6, {}}}}}};
+	CHECK (duck::to_container<std::vector<int>> (
+	           pre_order (tree) | duck::map ([](const Node & n) { return n.value; })) ==
+	       (std::vector<int>{0, 1, 2, 3, 4, 5, 6}));
+	auto leaves = pre_order (tree) | duck::filter ([](const Node & n) {
+		              return n.children.empty ();
+	              });
+	int nb_leaves = 0;
+	for (const Node & n : leaves) {
+		CHECK (n.children.empty ());
+		++nb_leaves;
+	}
+	CHECK (nb_leaves == 4);
+}
+
+TEST_CASE ("generator exceptions and frames") {
+	auto throwing = []() -> duck::generator<int> {
+		co_yield 1;
+		throw std::runtime_error ("generator");
+	};
+	auto g = throwing ();
+	auto it = g.begin ();
+	CHECK (*it == 1);
+	CHECK_THROWS_AS (++it, std::runtime_error);
+	CHECK (it == g.end ());
+
+	auto throwing_first = []() -> duck::generator<int> {
+		throw std::runtime_error ("generator");
+		co_return;
+	};
+	CHECK_THROWS_AS (throwing_first ().begin (), std::runtime_error);
+
+	// Frames are recycled: successive generators of the same size reuse the same frame
+	auto local_address = []() -> duck::generator<const void *> {
+		int local = 0;
+		co_yield &local;
+	};
+	const void * first = *local_address ().begin (); // Only compared, never dereferenced
+	for (int k = 0; k < 3; ++k)
+		CHECK (*local_address ().begin () == first);
+
+	duck::Detail::GeneratorFrameCache cache;
+	void * p = cache.allocate (100);
+	cache.deallocate (p, 100);
+	CHECK (cache.allocate (128) == p); // Same size class
+	cache.deallocate (p, 128);
+	void * big = cache.allocate (1 << 20); // Not cached
+	cache.deallocate (big, 1 << 20);
+}
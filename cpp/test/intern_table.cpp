@@ -0,0 +1,78 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <duck/intern_table.h>
+
+TEST_CASE ("intern") {
+	duck::InternTable<std::string> table;
+	CHECK (table.size () == 0);
+
+	auto a = table.intern (std::string ("hello"));
+	auto b = table.intern (std::string ("hello"));
+	auto c = table.intern (std::string ("world"));
+	CHECK (*a == "hello");
+	CHECK (a == b);
+	CHECK (a != c);
+	CHECK (table.size () == 2);
+
+	// Interning a FrozenPtr with an already known value gives the canonical one
+	auto d = table.intern (duck::make_frozen<std::string> ("world"));
+	CHECK (d == c);
+	// New value: the given pointer becomes canonical
+	auto e_ptr = duck::make_frozen<std::string> ("new");
+	auto e = table.intern (e_ptr);
+	CHECK (e == e_ptr);
+	CHECK (table.intern (std::string ("new")) == e_ptr);
+	// Null pointers are not interned
+	CHECK (!table.intern (duck::FrozenPtr<std::string>{}));
+	CHECK (table.size () == 3);
+}
+
+TEST_CASE ("weak entries") {
+	duck::InternTable<int> table (1);
+	{
+		auto kept = table.intern (1);
+		for (int i = 2; i < 1000; ++i)
+			table.intern (i); // Expires immediately
+		CHECK (table.intern (1) == kept);
+	}
+	table.purge ();
+	CHECK (table.size () == 0);
+
+	// Expired entries are replaced
+	auto v = table.intern (42);
+	CHECK (*v == 42);
+	CHECK (table.size () == 1);
+}
+
+TEST_CASE ("concurrent") {
+	duck::InternTable<int> table (4);
+	constexpr int nb_threads = 4;
+	constexpr int nb_values = 1000;
+	std::vector<std::vector<duck::FrozenPtr<int>>> results (nb_threads);
+	std::vector<std::thread> threads;
+	for (int t = 0; t < nb_threads; ++t) {
+		threads.emplace_back ([&table, &results, t] {
+			for (int i = 0; i < nb_values; ++i)
+				results[t].push_back (table.intern ((i * 7 + t) % nb_values));
+		});
+	}
+	for (auto & t : threads)
+		t.join ();
+
+	// All threads got the same canonical pointer for each value
+	std::vector<duck::FrozenPtr<int>> canonical (nb_values);
+	for (const auto & thread_results : results) {
+		for (const auto & p : thread_results) {
+			auto & c = canonical[*p];
+			if (!c)
+				c = p;
+			CHECK (c == p);
+		}
+	}
+	CHECK (table.size () == nb_values);
+}
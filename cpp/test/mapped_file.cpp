@@ -0,0 +1,114 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <system_error>
+#include <unistd.h>
+#include <vector>
+
+#include <duck/mapped_file.h>
+#include <duck/range/combinator.h>
+
+using duck::string_view;
+
+namespace doctest {
+template <> struct StringMaker<std::vector<std::string>> {
+	static String convert (const std::vector<std::string> & v) {
+		String s = "Vec{";
+		for (auto & str : v)
+			s += toString ("\"") + toString (str) + toString ("\",");
+		return s + toString ("}");
+	}
+};
+} // namespace doctest
+
+// Copy parts to compare with expected values
+template <typename R> std::vector<std::string> strings (const R & r) {
+	std::vector<std::string> v;
+	for (string_view part : r)
+		v.emplace_back (duck::to_string (part));
+	return v;
+}
+using Strings = std::vector<std::string>;
+
+// Temporary file, removed at destruction
+struct TemporaryFile {
+	std::string path;
+	TemporaryFile (const std::string & content) {
+		char name[] = "/tmp/duck_mapped_file_XXXXXX";
+		int fd = ::mkstemp (name);
+		REQUIRE (fd >= 0);
+		REQUIRE (::write (fd, content.data (), content.size ()) == ssize_t (content.size ()));
+		::close (fd);
+		path = name;
+	}
+	~TemporaryFile () { std::remove (path.c_str ()); }
+};
+
+TEST_CASE ("MappedFile") {
+	TemporaryFile file ("first line\nsecond,line\n\nlast");
+	duck::MappedFile mapped (file.path);
+	CHECK (mapped.size () == 28);
+	CHECK (duck::to_string (mapped.text ()) == "first line\nsecond,line\n\nlast");
+	CHECK (mapped.bytes ().size () == 28);
+	mapped.advise (duck::MappedFile::Access::random);
+
+	CHECK (strings (duck::lines (mapped.text ())) ==
+	       (Strings{"first line", "second,line", "", "last"}));
+
+	// Move
+	duck::MappedFile other (std::move (mapped));
+	CHECK (mapped.empty ());
+	CHECK (other.size () == 28);
+	mapped = std::move (other);
+	CHECK (other.data () == nullptr);
+	CHECK (*mapped.begin () == 'f');
+
+	// Empty file
+	TemporaryFile empty_file ("");
+	duck::MappedFile empty (empty_file.path);
+	CHECK (empty.empty ());
+	CHECK (duck::empty (duck::lines (empty.text ())));
+
+	CHECK_THROWS_AS (duck::MappedFile ("/nonexistent/duck"), std::system_error);
+}
+
+TEST_CASE ("lines") {
+	CHECK (strings (duck::lines ("")) == Strings{});
+	CHECK (strings (duck::lines ("\n")) == Strings{""});
+	CHECK (strings (duck::lines ("a")) == Strings{"a"});
+	CHECK (strings (duck::lines ("a\n")) == Strings{"a"});
+	CHECK (strings (duck::lines ("a\n\nb")) == (Strings{"a", "", "b"}));
+	CHECK (strings (duck::lines ("a\r\nb\n\n")) == (Strings{"a\r", "b", ""}));
+}
+
+TEST_CASE ("fields") {
+	// Same results as split
+	for (auto text : {"", ",", ",,", "a,b,c", "a,", ",b", " ,b "}) {
+		std::vector<std::string> expected;
+		for (auto part : duck::split (',', text))
+			expected.emplace_back (duck::to_string (part));
+		CHECK (strings (duck::fields (',', text)) == expected);
+	}
+	CHECK (duck::size (duck::fields (';', "a;b;c")) == 3);
+	CHECK (duck::size_hint (duck::fields (';', "a;b;c")).value == 6);
+
+	// Composition: second field of each line
+	auto second_field = [](string_view line) { return duck::nth (duck::fields (',', line), 1); };
+	auto column = duck::lines ("a,1\nb,2\nc,3\n") | duck::map (second_field);
+	CHECK (strings (column) == (Strings{"1", "2", "3"}));
+}
+
+TEST_CASE ("records") {
+	const char bytes[] = "aaabbbcccd"; // Incomplete record "d" and null terminator ignored
+	auto recs = duck::records (duck::span<const char> (bytes, 10), 3);
+	CHECK (recs.size () == 3);
+	CHECK (strings (recs) == (Strings{"aaa", "bbb", "ccc"}));
+	CHECK (duck::to_string (recs[1]) == "bbb");
+	CHECK (duck::to_string (*(recs.end () - 1)) == "ccc");
+	CHECK (recs.end () - recs.begin () == 3);
+	CHECK (strings (recs | duck::reverse ()) == (Strings{"ccc", "bbb", "aaa"}));
+	CHECK (duck::empty (duck::records (duck::span<const char> (), 4)));
+}
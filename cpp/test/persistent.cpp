@@ -0,0 +1,218 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+
+#include <algorithm>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <duck/persistent.h>
+
+TEST_CASE ("push_back / access") {
+	duck::PersistentVector<int> empty;
+	CHECK (empty.empty ());
+	CHECK (empty.begin () == empty.end ());
+
+	auto one = empty.push_back (42);
+	CHECK (empty.empty ());
+	CHECK (one.size () == 1);
+	CHECK (one[0] == 42);
+	CHECK (one.front () == 42);
+	CHECK (one.back () == 42);
+	CHECK_THROWS_AS (one.at (1), std::out_of_range);
+
+	// Cover several trie levels
+	constexpr int n = 40000;
+	std::vector<duck::PersistentVector<int>> versions;
+	duck::PersistentVector<int> v;
+	for (int i = 0; i < n; ++i) {
+		v = v.push_back (i);
+		if (i % 1000 == 0)
+			versions.push_back (v);
+	}
+	CHECK (v.size () == n);
+	bool all_ok = true;
+	for (int i = 0; i < n; ++i)
+		all_ok = all_ok && v[i] == i;
+	CHECK (all_ok);
+	// Old versions are unchanged
+	for (std::size_t k = 0; k < versions.size (); ++k) {
+		CHECK (versions[k].size () == k * 1000 + 1);
+		CHECK (versions[k].back () == int(k * 1000));
+	}
+
+	// Iteration
+	int expected = 0;
+	for (int x : v)
+		all_ok = all_ok && x == expected++;
+	CHECK (all_ok);
+	CHECK (expected == n);
+	CHECK (v.end () - v.begin () == n);
+	CHECK (*(v.begin () + 1234) == 1234);
+}
+
+TEST_CASE ("set / pop_back") {
+	auto v = duck::PersistentVector<std::string>{"a", "b", "c"};
+	auto v2 = v.set (1, "B");
+	CHECK (v[1] == "b");
+	CHECK (v2[1] == "B");
+	CHECK (v2[0] == "a");
+
+	auto v3 = v2.pop_back ();
+	CHECK (v3.size () == 2);
+	CHECK (v2.size () == 3);
+	CHECK (v3.pop_back ().pop_back ().empty ());
+
+	// pop_back across leaf and level boundaries
+	constexpr int n = 2000;
+	duck::PersistentVector<int> big;
+	for (int i = 0; i < n; ++i)
+		big = big.push_back (i);
+	auto shrinking = big;
+	bool all_ok = true;
+	for (int i = n - 1; i >= 0; --i) {
+		all_ok = all_ok && shrinking.back () == i && shrinking.size () == std::size_t (i + 1);
+		shrinking = shrinking.pop_back ();
+	}
+	CHECK (all_ok);
+	CHECK (shrinking.empty ());
+	// Push again after shrinking
+	shrinking = shrinking.push_back (1).push_back (2);
+	CHECK (shrinking[1] == 2);
+
+	auto modified = big;
+	for (int i = 0; i < n; i += 7)
+		modified = modified.set (i, -i);
+	for (int i = 0; i < n; ++i) {
+		all_ok = all_ok && big[i] == i;
+		all_ok = all_ok && modified[i] == (i % 7 == 0 ? -i : i);
+	}
+	CHECK (all_ok);
+}
+
+TEST_CASE ("transient") {
+	duck::PersistentVector<std::string> empty;
+	auto t = empty.transient ();
+	for (int i = 0; i < 1000; ++i)
+		t.push_back (std::to_string (i));
+	auto v = std::move (t).persistent ();
+	CHECK (v.size () == 1000);
+	CHECK (v[999] == "999");
+	CHECK (empty.empty ());
+
+	duck::PersistentVector<int> base;
+	for (int i = 0; i < 100; ++i)
+		base = base.push_back (i);
+	auto t2 = base.transient ();
+	for (int i = 0; i < 100; ++i)
+		t2.set (i, i * 2);
+	t2.pop_back ().push_back (-1);
+	auto v2 = std::move (t2).persistent ();
+	bool all_ok = true;
+	for (int i = 0; i < 100; ++i) {
+		all_ok = all_ok && base[i] == i; // Untouched
+		all_ok = all_ok && v2[i] == (i == 99 ? -1 : i * 2);
+	}
+	CHECK (all_ok);
+
+	// A new transient from v2 does not modify v2
+	auto t3 = v2.transient ();
+	t3.set (0, 1000);
+	auto v3 = std::move (t3).persistent ();
+	CHECK (v2[0] == 0);
+	CHECK (v3[0] == 1000);
+}
+
+// Bad hash to test collisions
+struct ModuloHash {
+	std::size_t operator() (int i) const { return std::size_t (i % 4); }
+};
+TYPE_TO_STRING (std::hash<int>);
+TYPE_TO_STRING (ModuloHash);
+using hash_types = doctest::Types<std::hash<int>, ModuloHash>;
+
+TEST_CASE ("map") {
+	duck::PersistentMap<std::string, int> empty;
+	CHECK (empty.empty ());
+	CHECK (empty.begin () == empty.end ());
+	CHECK (empty.find ("a") == nullptr);
+
+	auto m = empty.set ("a", 1).set ("b", 2);
+	CHECK (m.size () == 2);
+	CHECK (*m.find ("a") == 1);
+	CHECK (m.at ("b") == 2);
+	CHECK (m.count ("c") == 0);
+	CHECK_THROWS_AS (m.at ("c"), std::out_of_range);
+
+	auto m2 = m.set ("a", 10);
+	CHECK (m2.size () == 2);
+	CHECK (m2.at ("a") == 10);
+	CHECK (m.at ("a") == 1);
+
+	auto m3 = m2.erase ("a").erase ("z");
+	CHECK (m3.size () == 1);
+	CHECK (m3.find ("a") == nullptr);
+	CHECK (m2.size () == 2);
+
+	auto ilist = duck::PersistentMap<int, int>{{1, 2}, {3, 4}};
+	CHECK (ilist.size () == 2);
+	CHECK (ilist.at (3) == 4);
+}
+
+TEST_CASE_TEMPLATE ("map many entries", Hash, hash_types) {
+	constexpr int n = 3000;
+	duck::PersistentMap<int, int, Hash> m;
+	for (int i = 0; i < n; ++i)
+		m = m.set (i, i * 2);
+	CHECK (m.size () == n);
+	bool all_ok = true;
+	for (int i = 0; i < n; ++i)
+		all_ok = all_ok && m.find (i) != nullptr && *m.find (i) == i * 2;
+	CHECK (all_ok);
+
+	// Iteration sees every entry once
+	std::vector<int> seen (n, 0);
+	for (const auto & kv : m)
+		seen[kv.first]++;
+	CHECK (std::count (seen.begin (), seen.end (), 1) == n);
+
+	// Erase half, old version is unchanged
+	auto half = m;
+	for (int i = 0; i < n; i += 2)
+		half = half.erase (i);
+	CHECK (half.size () == n / 2);
+	for (int i = 0; i < n; ++i) {
+		all_ok = all_ok && (half.find (i) != nullptr) == (i % 2 == 1);
+		all_ok = all_ok && m.find (i) != nullptr;
+	}
+	CHECK (all_ok);
+	CHECK (std::distance (half.begin (), half.end ()) == n / 2);
+
+	// Erase all
+	for (int i = 1; i < n; i += 2)
+		half = half.erase (i);
+	CHECK (half.empty ());
+	CHECK (half.begin () == half.end ());
+}
+
+TEST_CASE ("map transient") {
+	duck::PersistentMap<int, std::string> base;
+	auto t = base.transient ();
+	for (int i = 0; i < 1000; ++i)
+		t.set (i, std::to_string (i));
+	t.erase (500);
+	CHECK (t.find (500) == nullptr);
+	auto m = std::move (t).persistent ();
+	CHECK (m.size () == 999);
+	CHECK (base.empty ());
+	CHECK (m.at (999) == "999");
+
+	auto t2 = m.transient ();
+	for (int i = 0; i < 1000; i += 3)
+		t2.set (i, "x");
+	auto m2 = std::move (t2).persistent ();
+	CHECK (m.at (0) == "0");
+	CHECK (m2.at (0) == "x");
+	CHECK (m2.at (1) == "1");
+	CHECK (m2.size () == 999);
+}
@@ -1,9 +1,22 @@
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 #include <doctest.h>
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
 #include <vector>
 
 #include <duck/range/algorithm.h>
+#include <duck/range/combinator.h>
+#include <duck/range/parallel_algorithm.h>
+#include <duck/small_vector.h>
 
 using duck::range;
 
@@ -32,6 +45,20 @@ TEST_CASE ("all / any / none") {
 	CHECK_FALSE (duck::none_of (all0, is_zero));
 	CHECK (duck::none_of (all1, is_zero));
 	CHECK_FALSE (duck::none_of (ladder0_4, is_zero));
+
+	// Predicates are not called after the result is known, unless pure
+	std::vector<int> values (1000, 0);
+	values[10] = 1;
+	int nb_calls = 0;
+	auto counted_is_zero = [&nb_calls](int i) { return ++nb_calls, i == 0; };
+	CHECK_FALSE (duck::all_of (values, counted_is_zero));
+	CHECK (nb_calls == 11);
+	nb_calls = 0;
+	CHECK (duck::any_of (values, [&nb_calls](int i) { return ++nb_calls, i != 0; }));
+	CHECK (nb_calls == 11);
+	CHECK_FALSE (duck::all_of (values, duck::pure_predicate (is_zero)));
+	CHECK (duck::any_of (values, duck::pure_predicate ([](int i) { return i != 0; })));
+	CHECK_FALSE (duck::none_of (values, duck::pure_predicate ([](int i) { return i != 0; })));
 }
 
 TEST_CASE ("count") {
@@ -59,7 +86,7 @@ TEST_CASE ("equal") {
 	CHECK (duck::equal (all0, duck::begin (all0), is_equal));
 	CHECK_FALSE (duck::equal (all0, duck::begin (ladder0_4), is_equal));
 
-#if HAS_CPP14
+#if __cplusplus >= 201402L
 	CHECK (duck::equal (empty, empty));
 	CHECK_FALSE (duck::equal (empty, all0));
 	CHECK (duck::equal (all0, all0));
@@ -109,6 +136,320 @@ TEST_CASE ("find end/first_of") {
 	CHECK (duck::find_end (all1, few0, is_equal) == duck::end (all1));
 }
 
+// SIMD paths on contiguous arithmetic ranges: compare with <algorithm> on all sizes around the
+// vector widths, and with matches at all positions.
+using simd_types = doctest::Types<char, std::int8_t, std::uint8_t, std::int16_t, std::uint16_t,
+                                  std::int32_t, std::uint32_t, std::int64_t, std::uint64_t, float,
+                                  double>;
+
+TEST_CASE_TEMPLATE ("simd", T, simd_types) {
+	std::mt19937 gen (42);
+	std::uniform_int_distribution<int> small_values (-3, 3);
+	for (std::size_t n = 0; n < 100; ++n) {
+		std::vector<T> v (n);
+		for (auto & x : v)
+			x = static_cast<T> (small_values (gen));
+		// Extremes of the type, for signed / unsigned ordering
+		if (n > 40) {
+			v[n / 2] = std::numeric_limits<T>::max ();
+			v[n / 3] = std::numeric_limits<T>::lowest ();
+		}
+		for (int value = -4; value <= 4; ++value) {
+			auto t = static_cast<T> (value);
+			CHECK (duck::find (v, t) == std::find (v.begin (), v.end (), t));
+			CHECK (duck::count (v, t) == std::count (v.begin (), v.end (), t));
+		}
+#ifdef DUCK_SIMD_X86
+		// SSE2 kernels, even if AVX2 is selected at runtime
+		if (n > 0) {
+			auto t = static_cast<T> (2);
+			CHECK (duck::Detail::sse2::find (v.data (), n, t) ==
+			       duck::Detail::simd_find (v.data (), n, t));
+			CHECK (duck::Detail::sse2::count (v.data (), n, t) ==
+			       duck::Detail::simd_count (v.data (), n, t));
+			CHECK (duck::Detail::sse2::min_index (v.data (), n) ==
+			       duck::Detail::simd_min_index (v.data (), n));
+			CHECK (duck::Detail::sse2::max_index (v.data (), n) ==
+			       duck::Detail::simd_max_index (v.data (), n));
+			// Float sums depend on the order of additions
+			if (std::is_integral<T>::value)
+				CHECK (duck::Detail::sse2::sum (v.data (), n) == duck::Detail::simd_sum (v.data (), n));
+		}
+#endif
+		CHECK (duck::min_element (v) == std::min_element (v.begin (), v.end ()));
+		CHECK (duck::max_element (v) == std::max_element (v.begin (), v.end ()));
+		auto is_not_3 = duck::pure_predicate ([](T x) { return x != T (3); });
+		auto is_3 = duck::pure_predicate ([](T x) { return x == T (3); });
+		CHECK (duck::all_of (v, is_not_3) == std::all_of (v.begin (), v.end (), is_not_3));
+		CHECK (duck::any_of (v, is_3) == std::any_of (v.begin (), v.end (), is_3));
+		CHECK (duck::none_of (v, is_3) == std::none_of (v.begin (), v.end (), is_3));
+
+		auto copy = v;
+		CHECK (duck::equal (v, copy));
+		CHECK (duck::equal (v, copy.data ()));
+		for (std::size_t i = 0; i < n; ++i) {
+			copy[i] = copy[i] == T (0) ? T (1) : T (0);
+			CHECK (duck::mismatch (v, copy).first == v.begin () + static_cast<std::ptrdiff_t> (i));
+			CHECK (duck::mismatch (v, copy.data ()).second == copy.data () + i);
+			CHECK_FALSE (duck::equal (v, copy));
+			copy[i] = v[i];
+		}
+		copy.push_back (T (0));
+		CHECK_FALSE (duck::equal (v, copy));
+	}
+}
+
+TEST_CASE ("simd special values") {
+	// Values converted to the element type only if comparisons are unchanged
+	std::vector<std::uint8_t> bytes{1, 2, 44, 255};
+	CHECK (duck::find (bytes, 300) == bytes.end ());
+	CHECK (duck::find (bytes, 255) == bytes.begin () + 3);
+	CHECK (duck::find (bytes, -1) == bytes.end ());
+	std::vector<unsigned> words (40, 0);
+	words[35] = std::numeric_limits<unsigned>::max ();
+	CHECK (duck::find (words, -1) == words.begin () + 35);
+	CHECK (duck::count (words, 0L) == 39);
+	std::vector<int> ints (40, 1);
+	CHECK (duck::count (ints, 1.5) == 0);
+	CHECK (duck::count (ints, 1.0) == 40);
+
+	// NaN and signed zeros follow operator== and operator<
+	auto nan = std::numeric_limits<double>::quiet_NaN ();
+	std::vector<double> d (50, 1.0);
+	d[10] = nan;
+	d[20] = -0.0;
+	d[30] = 0.0;
+	d[40] = -2.0;
+	CHECK (duck::find (d, nan) == d.end ());
+	CHECK (duck::find (d, 0.0) == d.begin () + 20);
+	CHECK (duck::count (d, 0.0) == 2);
+	CHECK (duck::min_element (d) == d.begin () + 40);
+	CHECK (duck::max_element (d) == d.begin ());
+	CHECK_FALSE (duck::equal (d, d));
+	d[0] = nan;
+	CHECK (duck::min_element (d) == d.begin ());
+	CHECK (duck::max_element (d) == d.begin ());
+
+	// Other contiguous ranges
+	duck::SmallVector<short, 8> small (17, 1);
+	small[16] = 17;
+	CHECK (duck::find (small, 17) == small.end () - 1);
+	short array[20] = {};
+	array[19] = -1;
+	CHECK (duck::min_element (array) == array + 19);
+	CHECK (duck::count (duck::span<const short> (array), 0) == 19);
+}
+
 // TODO adjacent_find
 
 // TODO search
+
+TEST_CASE ("parallel") {
+	duck::ThreadPool pool (3);
+	auto policy = duck::par (pool, 100);
+	std::vector<int> v (100000);
+	std::iota (v.begin (), v.end (), 0);
+	auto is_negative = [](int i) { return i < 0; };
+	auto is_big = [](int i) { return i >= 99990; };
+
+	CHECK (duck::all_of (policy, v, [](int i) { return i >= 0; }));
+	CHECK_FALSE (duck::all_of (policy, v, is_big));
+	CHECK (duck::any_of (policy, v, is_big));
+	CHECK_FALSE (duck::any_of (policy, v, is_negative));
+	CHECK (duck::none_of (policy, v, is_negative));
+	CHECK (duck::count (policy, v, 42) == 1);
+	CHECK (duck::count_if (policy, v, is_big) == 10);
+
+	// find returns the first match, even if later chunks match first
+	CHECK (duck::find (policy, v, 77777) == v.begin () + 77777);
+	CHECK (duck::find_if (policy, v, [](int i) { return i % 5000 == 4999; }) == v.begin () + 4999);
+	CHECK (duck::find_if (policy, v, is_negative) == v.end ());
+	CHECK (duck::find_if_not (policy, v, [](int i) { return i < 60000; }) == v.begin () + 60000);
+
+	// Random access combinators
+	auto r = v | duck::reverse ();
+	CHECK (*duck::find_if (policy, r, [](int i) { return i < 50000; }) == 49999);
+	auto s = v | duck::slice (1000, 2000);
+	CHECK (duck::count_if (policy, s, [](int i) { return i % 2 == 0; }) == 500);
+	auto indexed = v | duck::indexed ();
+	using Indexed = decltype (*indexed.begin ());
+	CHECK (duck::all_of (policy, indexed, [](Indexed e) { return e.index == e.value (); }));
+	// Non random access range: serial
+	auto even = v | duck::filter ([](int i) { return i % 2 == 0; });
+	CHECK (duck::count_if (policy, even, is_big) == 5);
+
+	std::vector<int> copy (v);
+	CHECK (duck::equal (policy, v, copy.begin ()));
+	copy[65432] = -1;
+	CHECK_FALSE (duck::equal (policy, v, copy.begin ()));
+	CHECK (duck::mismatch (policy, v, copy.begin ()).first == v.begin () + 65432);
+	CHECK (duck::mismatch (policy, v, copy.begin (), is_equal).second == copy.begin () + 65432);
+
+	std::atomic<long> sum{0};
+	duck::for_each (policy, v, [&sum](int i) { sum += i; });
+	CHECK (sum == 99999L * 100000L / 2);
+
+	// Same results with par_unseq, on the default pool or a given one
+	CHECK (duck::count_if (duck::par_unseq (), v, is_big) == 10);
+	CHECK (duck::find (duck::par_unseq ().with_grain (10), v, 12345) == v.begin () + 12345);
+	CHECK (duck::count_if (duck::par_unseq (pool, 100), v, is_big) == 10);
+
+	// Exceptions are propagated to the caller
+	CHECK_THROWS_AS (duck::for_each (policy, v,
+	                                 [](int i) {
+		                                 if (i == 50000)
+			                                 throw std::runtime_error ("error");
+	                                 }),
+	                 std::runtime_error);
+
+	// Nested parallel calls from inside pool tasks do not deadlock
+	std::atomic<long> nested_count{0};
+	duck::for_each (duck::par (pool, 1), duck::range (8), [&](int) {
+		nested_count += duck::count_if (policy, v, is_big);
+	});
+	CHECK (nested_count == 80);
+}
+
+using SortTypes = doctest::Types<std::int8_t, std::uint16_t, std::int32_t, std::uint64_t, float,
+                                 double>;
+TEST_CASE_TEMPLATE ("sort arithmetic", T, SortTypes) {
+	// Sizes around the radix sort thresholds, with negative values for signed types
+	std::mt19937 gen (42);
+	std::uniform_int_distribution<int> dist (-100, 100);
+	for (std::size_t n : {0, 1, 2, 100, 255, 256, 1023, 1024, 2048, 5000}) {
+		std::vector<T> v (n);
+		for (auto & e : v)
+			e = static_cast<T> (std::is_signed<T>::value ? dist (gen) : dist (gen) + 100);
+		auto expected = v;
+		std::sort (expected.begin (), expected.end ());
+
+		auto sorted = v;
+		duck::sort (sorted);
+		CHECK (sorted == expected);
+		sorted = v;
+		duck::stable_sort (sorted);
+		CHECK (sorted == expected);
+		sorted = v;
+		duck::radix_sort (sorted);
+		CHECK (sorted == expected);
+	}
+}
+
+TEST_CASE ("radix_sort") {
+	// Floats: infinities, negative values and zeros
+	std::vector<double> d{3.5, -0.0, -std::numeric_limits<double>::infinity (), 1e-300, -2.25, 0.0,
+	                      std::numeric_limits<double>::infinity (), -1e300, 2.0};
+	duck::radix_sort (d);
+	CHECK (std::is_sorted (d.begin (), d.end ()));
+	CHECK (std::signbit (d[3])); // -0.0 before 0.0
+	CHECK_FALSE (std::signbit (d[4]));
+
+	// Integer limits
+	std::vector<std::int64_t> i{0, std::numeric_limits<std::int64_t>::max (), -1,
+	                            std::numeric_limits<std::int64_t>::min (), 1};
+	duck::radix_sort (i);
+	CHECK (std::is_sorted (i.begin (), i.end ()));
+
+	// Key projection, stable
+	struct Item {
+		int key;
+		int order;
+	};
+	std::vector<Item> items;
+	for (int k = 0; k < 1000; ++k)
+		items.push_back (Item{(k * 7919) % 13 - 6, k});
+	duck::radix_sort (items, [](const Item & item) { return item.key; });
+	CHECK (std::is_sorted (items.begin (), items.end (), [](const Item & a, const Item & b) {
+		return a.key < b.key || (a.key == b.key && a.order < b.order);
+	}));
+
+	// Views: only the viewed part is sorted
+	std::vector<int> v{5, 4, 3, 2, 1, 0};
+	duck::radix_sort (v | duck::slice (1, 5));
+	CHECK (v == (std::vector<int>{5, 1, 2, 3, 4, 0}));
+}
+
+TEST_CASE ("sort / partial_sort / nth_element") {
+	std::vector<std::string> words{"pear", "fig", "apple", "kiwi", "banana", "date"};
+	auto by_length = [](const std::string & a, const std::string & b) {
+		return a.size () < b.size ();
+	};
+	auto v = words;
+	duck::sort (v);
+	CHECK (v == (std::vector<std::string>{"apple", "banana", "date", "fig", "kiwi", "pear"}));
+	v = words;
+	duck::stable_sort (v, by_length);
+	CHECK (v == (std::vector<std::string>{"fig", "pear", "kiwi", "date", "apple", "banana"}));
+	duck::sort (v | duck::reverse ());
+	CHECK (v == (std::vector<std::string>{"pear", "kiwi", "fig", "date", "banana", "apple"}));
+
+	std::vector<int> numbers (100);
+	std::iota (numbers.begin (), numbers.end (), 0);
+	std::shuffle (numbers.begin (), numbers.end (), std::mt19937 (1));
+	duck::partial_sort (numbers, numbers.begin () + 5);
+	CHECK (std::vector<int> (numbers.begin (), numbers.begin () + 5) ==
+	       (std::vector<int>{0, 1, 2, 3, 4}));
+	duck::nth_element (numbers, numbers.begin () + 50, std::greater<int>{});
+	CHECK (numbers[50] == 49);
+	CHECK (std::all_of (numbers.begin (), numbers.begin () + 50, [](int i) { return i >= 49; }));
+}
+
+TEST_CASE ("top_k") {
+	std::vector<int> v (1000);
+	std::iota (v.begin (), v.end (), 0);
+	std::shuffle (v.begin (), v.end (), std::mt19937 (2));
+	CHECK (duck::top_k (v, 3) == (std::vector<int>{0, 1, 2}));
+	CHECK (duck::top_k (v, 3, std::greater<int>{}) == (std::vector<int>{999, 998, 997}));
+	CHECK (duck::top_k (v, 0).empty ());
+	CHECK (duck::top_k (v | duck::slice (0, 2), 5).size () == 2);
+
+	// Single pass on non random access ranges
+	auto odd = v | duck::filter ([](int i) { return i % 2 == 1; });
+	CHECK (duck::top_k (odd, 4) == (std::vector<int>{1, 3, 5, 7}));
+	CHECK (duck::top_k (duck::range (10), 20) == (std::vector<int>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9}));
+}
+
+TEST_CASE ("parallel sort") {
+	duck::ThreadPool pool (3);
+	auto policy = duck::par (pool, 100);
+	std::mt19937 gen (3);
+	std::uniform_int_distribution<int> dist (0, 1000);
+	std::vector<std::pair<int, int>> v (20000);
+	for (std::size_t i = 0; i < v.size (); ++i)
+		v[i] = {dist (gen), static_cast<int> (i)};
+	auto by_first = [](const std::pair<int, int> & a, const std::pair<int, int> & b) {
+		return a.first < b.first;
+	};
+
+	auto expected = v;
+	std::stable_sort (expected.begin (), expected.end (), by_first);
+	auto sorted = v;
+	duck::stable_sort (policy, sorted, by_first);
+	CHECK (sorted == expected);
+	sorted = v;
+	duck::sort (policy, sorted);
+	CHECK (std::is_sorted (sorted.begin (), sorted.end ()));
+
+	// Odd sizes, small inputs, views, default pool
+	std::vector<int> numbers (12345);
+	for (auto & i : numbers)
+		i = dist (gen);
+	auto expected_numbers = numbers;
+	std::sort (expected_numbers.begin (), expected_numbers.end ());
+	duck::sort (policy, numbers | duck::reverse (), std::greater<int>{});
+	CHECK (numbers == expected_numbers);
+	std::vector<int> small{3, 1, 2};
+	duck::stable_sort (duck::par (), small);
+	CHECK (small == (std::vector<int>{1, 2, 3}));
+
+	// Move only values
+	std::vector<std::unique_ptr<int>> pointers;
+	for (int i = 0; i < 1000; ++i)
+		pointers.emplace_back (new int ((i * 37) % 1000));
+	auto pointee_less = [](const std::unique_ptr<int> & a, const std::unique_ptr<int> & b) {
+		return *a < *b;
+	};
+	duck::sort (duck::par (pool, 10), pointers, pointee_less);
+	CHECK (std::is_sorted (pointers.begin (), pointers.end (), pointee_less));
+	CHECK (*pointers.front () == 0);
+}
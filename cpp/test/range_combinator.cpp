@@ -4,8 +4,13 @@
 #include <forward_list>
 #include <iterator>
 #include <list>
+#include <set>
+#include <sstream>
+#include <tuple>
+#include <type_traits>
 #include <vector>
 
+#include <duck/range/algorithm.h>
 #include <duck/range/combinator.h>
 
 // Lousy wrapper of std vector which is move only : test move construction of ranges
@@ -81,6 +86,41 @@ TEST_CASE_TEMPLATE ("filter", C, forward_container_types) {
 	CHECK (duck::empty (C{} | duck::filter ([](int) { return true; })));
 }
 
+TEST_CASE_TEMPLATE ("cache_begin", C, forward_container_types) {
+	int nb_calls = 0;
+	auto cached = C{values} | duck::filter ([&nb_calls](int i) { return ++nb_calls, i >= 3; }) |
+	              duck::cache_begin ();
+	CHECK (nb_calls == 0); // Lazy
+	CHECK (duck::front (cached) == 3);
+	CHECK (nb_calls == 4);
+	CHECK_FALSE (duck::empty (cached));
+	CHECK (duck::front (cached) == 3);
+	CHECK (nb_calls == 4); // First match not searched again
+	CHECK (cached == duck::range ({3, 4}));
+	CHECK (nb_calls == 5);
+
+	// Moves drop the cache, which refers to the moved-from filtered_range
+	auto moved = std::move (cached);
+	CHECK (moved == duck::range ({3, 4}));
+	CHECK (nb_calls == 10);
+	CHECK (duck::to_container<std::vector<int>> (moved) == (std::vector<int>{3, 4}));
+
+	// Assignments: not through a reference to the inner range, drop the cache otherwise
+	C container{values};
+	using ReferenceCached = decltype (container | duck::cache_begin ());
+	CHECK_FALSE (std::is_copy_assignable<ReferenceCached>::value);
+	CHECK_FALSE (std::is_move_assignable<ReferenceCached>::value);
+	auto owned = C{1, 2} | duck::cache_begin ();
+	auto other = C{7, 8} | duck::cache_begin ();
+	CHECK (duck::front (owned) == 1);
+	owned = std::move (other);
+	CHECK (duck::front (owned) == 7);
+	owned = C{5} | duck::cache_begin ();
+	CHECK (duck::front (owned) == 5);
+
+	CHECK (duck::empty (C{} | duck::cache_begin ()));
+}
+
 TEST_CASE_TEMPLATE ("map", C, forward_container_types) {
 	auto mapped_range = C{values} | duck::map ([](int i) { return i - 2; }) |
 	                    duck::filter ([](int i) { return i >= 0; });
@@ -90,4 +130,255 @@ TEST_CASE_TEMPLATE ("map", C, forward_container_types) {
 	CHECK (duck::empty (C{} | duck::map ([](int i) { return i; })));
 }
 
+TEST_CASE_TEMPLATE ("chunk", C, forward_container_types) {
+	auto range = C{values};
+	std::vector<std::vector<int>> chunks;
+	for (auto chunk : range | duck::chunk (2))
+		chunks.emplace_back (duck::begin (chunk), duck::end (chunk));
+	CHECK (chunks == (std::vector<std::vector<int>>{{0, 1}, {2, 3}, {4}}));
+	CHECK (duck::size (range | duck::chunk (2)) == 3);
+	CHECK (duck::size (range | duck::chunk (5)) == 1);
+	CHECK (duck::size (range | duck::chunk (10)) == 1);
+
+	CHECK (duck::empty (C{} | duck::chunk (3)));
+}
+
+TEST_CASE ("chunk contiguous") {
+	// Chunks are spans on the vector storage
+	std::vector<int> v (10);
+	auto chunks = v | duck::chunk (4);
+	CHECK (chunks.size () == 3);
+	using Chunk = decltype (*chunks.begin ());
+	CHECK ((std::is_same<Chunk, duck::span<int>>::value));
+	CHECK (chunks.begin ()[2].data () == v.data () + 8);
+	CHECK (chunks.begin ()[2].size () == 2);
+	CHECK (chunks.end () - chunks.begin () == 3);
+	for (auto chunk : chunks)
+		for (auto & i : chunk)
+			i = 1;
+	CHECK (v == std::vector<int> (10, 1));
+
+	// Owned: const chunks
+	auto owned = std::vector<int> (3) | duck::chunk (2);
+	CHECK ((std::is_same<decltype (*owned.begin ()), duck::span<const int>>::value));
+}
+
+TEST_CASE ("chunk input") {
+	// Single pass, unread elements of a chunk are skipped
+	std::istringstream stream ("0 1 2 3 4 5 6");
+	auto input = duck::range (std::istream_iterator<int> (stream), std::istream_iterator<int> ());
+	std::vector<int> firsts;
+	for (auto chunk : input | duck::chunk (3))
+		firsts.push_back (*chunk.begin ());
+	CHECK (firsts == (std::vector<int>{0, 3, 6}));
+
+	std::istringstream stream2 ("0 1 2 3 4");
+	std::vector<std::vector<int>> chunks;
+	for (auto chunk : duck::chunk (
+	         duck::range (std::istream_iterator<int> (stream2), std::istream_iterator<int> ()), 2))
+		chunks.emplace_back (chunk.begin (), chunk.end ());
+	CHECK (chunks == (std::vector<std::vector<int>>{{0, 1}, {2, 3}, {4}}));
+
+	// Moved before iteration: iterates its own inner range
+	std::istringstream stream3 ("0 1 2 3 4");
+	auto owned = duck::chunk (
+	    duck::range (std::istream_iterator<int> (stream3), std::istream_iterator<int> ()), 2);
+	auto moved = std::move (owned);
+	chunks.clear ();
+	for (auto chunk : moved)
+		chunks.emplace_back (chunk.begin (), chunk.end ());
+	CHECK (chunks == (std::vector<std::vector<int>>{{0, 1}, {2, 3}, {4}}));
+}
+
+TEST_CASE_TEMPLATE ("push", C, forward_container_types) {
+	auto chain = C{values} | duck::filter ([](int i) { return i % 2 == 0; }) |
+	             duck::map ([](int i) { return i * 10; }) |
+	             duck::filter ([](int i) { return i > 0; });
+	CHECK (duck::has_push_method<decltype (chain)>::value);
+	CHECK_FALSE (duck::has_push_method<C>::value);
+
+	// Same elements and order as iterators
+	std::vector<int> pushed;
+	CHECK (duck::push_each (chain, [&pushed](int i) { return pushed.push_back (i), true; }));
+	CHECK (pushed == (std::vector<int>{20, 40}));
+
+	// Early stop
+	pushed.clear ();
+	CHECK_FALSE (duck::push_each (chain, [&pushed](int i) { return pushed.push_back (i), false; }));
+	CHECK (pushed == (std::vector<int>{20}));
+
+	// Algorithms using internal iteration
+	CHECK (duck::to_container<std::vector<int>> (chain) == (std::vector<int>{20, 40}));
+	CHECK (duck::to_container<std::set<int>> (chain) == (std::set<int>{20, 40}));
+	// Without c.insert (c.end (), v): constructed from iterators
+	CHECK (duck::to_container<std::forward_list<int>> (chain) == (std::forward_list<int>{20, 40}));
+	CHECK (duck::count_if (chain, [](int i) { return i > 30; }) == 1);
+	CHECK (duck::count (chain, 20) == 1);
+	CHECK (duck::all_of (chain, [](int i) { return i % 20 == 0; }));
+	CHECK (duck::any_of (chain, [](int i) { return i == 40; }));
+	CHECK (duck::none_of (chain, [](int i) { return i == 0; }));
+	int sum = 0;
+	duck::for_each (chain, [&sum](int i) { sum += i; });
+	CHECK (sum == 60);
+}
+
+TEST_CASE ("size_hint") {
+	using duck::SizeHint;
+	auto is_exact = [](SizeHint h, std::ptrdiff_t n) {
+		return h.kind == SizeHint::exact && h.value == n;
+	};
+	std::vector<int> v{values};
+	std::list<int> l{values};
+	std::forward_list<int> fl{values};
+	auto is_even = [](int i) { return i % 2 == 0; };
+	auto times_2 = [](int i) { return i * 2; };
+
+	// Containers and random access ranges
+	CHECK (is_exact (duck::size_hint (v), 5));
+	CHECK (is_exact (duck::size_hint (l), 5));
+	CHECK (duck::size_hint (fl).kind == SizeHint::unknown);
+	CHECK (is_exact (duck::size_hint (duck::range (3, 10)), 7));
+
+	// Exact propagation
+	CHECK (is_exact (duck::size_hint (l | duck::map (times_2)), 5));
+	CHECK (is_exact (duck::size_hint (l | duck::reverse ()), 5));
+	CHECK (is_exact (duck::size_hint (l | duck::indexed ()), 5));
+	CHECK (is_exact (duck::size_hint (l | duck::chunk (2)), 3));
+	CHECK (is_exact (duck::size_hint (l | duck::pop_front (2) | duck::pop_back ()), 2));
+	CHECK (is_exact (duck::size_hint (l | duck::slice (1, -1)), 3));
+	CHECK (is_exact (duck::size_hint (fl | duck::slice (1, 3)), 2));
+	CHECK (duck::size_hint (fl | duck::map (times_2)).kind == SizeHint::unknown);
+
+	// Filter gives an upper bound, kept through other combinators
+	auto filtered = l | duck::filter (is_even) | duck::map (times_2) | duck::indexed ();
+	CHECK (duck::size_hint (filtered).kind == SizeHint::upper_bound);
+	CHECK (duck::size_hint (filtered).value == 5);
+	CHECK (duck::size (filtered) == 3);
+
+	// to_container reserves exact sizes only
+	int nb_calls = 0;
+	auto counted = l | duck::map ([&nb_calls](int i) { return ++nb_calls, i; });
+	auto result = duck::to_container<std::vector<int>> (counted);
+	CHECK (result.capacity () == 5);
+	CHECK (nb_calls == 5);
+	CHECK (duck::to_container<std::vector<int>> (l | duck::filter (is_even)).size () == 3);
+}
+
+TEST_CASE ("zip") {
+	std::vector<int> ints{0, 1, 2, 3, 4};
+	std::vector<double> doubles{0.5, 1.5, 2.5};
+	std::list<int> l{values};
+	std::forward_list<int> fl{values};
+
+	// Random access: size of the shortest input, tuples of references
+	auto zipped = duck::zip (ints, doubles);
+	using zip_iterator = decltype (zipped.begin ());
+	CHECK ((std::is_same<duck::iterator_category_t<zip_iterator>,
+	                     std::random_access_iterator_tag>::value));
+	CHECK ((std::is_same<duck::iterator_reference_t<zip_iterator>,
+	                     std::tuple<int &, double &>>::value));
+	CHECK (duck::size (zipped) == 3);
+	CHECK (duck::size_hint (zipped).kind == duck::SizeHint::exact);
+	CHECK (std::get<1> (zipped.begin ()[2]) == 2.5);
+	CHECK (zipped.end () - zipped.begin () == 3);
+	for (auto t : zipped)
+		std::get<0> (t) += 10;
+	CHECK (ints == (std::vector<int>{10, 11, 12, 3, 4}));
+
+	// Span and temporary inputs
+	std::vector<int> sums;
+	for (auto t : duck::zip (duck::span<const int> (ints), std::vector<int>{1, 2, 3, 4, 5, 6}))
+		sums.push_back (std::get<0> (t) + std::get<1> (t));
+	CHECK (sums == (std::vector<int>{11, 13, 15, 7, 9}));
+
+	// Forward only inputs
+	auto forward_zipped = duck::zip (fl, l, ints);
+	CHECK ((std::is_same<duck::iterator_category_t<decltype (forward_zipped.begin ())>,
+	                     std::forward_iterator_tag>::value));
+	CHECK (duck::size (forward_zipped) == 5);
+	CHECK (duck::size_hint (forward_zipped).kind == duck::SizeHint::upper_bound);
+	int n = 0;
+	for (auto t : forward_zipped) {
+		CHECK (std::get<0> (t) == n);
+		CHECK (std::get<1> (t) == n);
+		CHECK (std::get<2> (t) == (n < 3 ? n + 10 : n));
+		++n;
+	}
+	CHECK (n == 5);
+	CHECK (duck::size (duck::zip (l, std::list<int>{1, 2})) == 2);
+
+	// With other combinators
+	auto pipeline = duck::zip (ints, doubles) | duck::indexed () |
+	                duck::filter ([](auto e) { return e.index % 2 == 0; }) |
+	                duck::map ([](auto e) {
+		                return std::get<0> (e.value ()) * std::get<1> (e.value ());
+	                });
+	CHECK (duck::to_container<std::vector<double>> (pipeline) == (std::vector<double>{5., 30.}));
+}
+
+TEST_CASE ("join") {
+	std::vector<std::vector<int>> vv{{}, {0, 1, 2}, {}, {}, {3}, {4, 5}, {}};
+	auto joined = vv | duck::join ();
+	CHECK ((std::is_same<duck::iterator_category_t<decltype (joined.begin ())>,
+	                     std::forward_iterator_tag>::value));
+	CHECK (duck::is_segmented_range<decltype (joined)>::value);
+	CHECK (!duck::is_segmented_range<decltype (vv)>::value);
+
+	// Iteration, and internal iteration
+	int n = 0;
+	for (int & i : joined) {
+		CHECK (i == n);
+		i += 10;
+		++n;
+	}
+	CHECK (n == 6);
+	std::vector<int> expected{10, 11, 12, 13, 14, 15};
+	CHECK (duck::to_container<std::vector<int>> (joined) == expected);
+	CHECK (duck::to_container<std::vector<int>> (vv | duck::join () | duck::map ([](int i) {
+		                                             return i;
+	                                             })) == expected);
+	CHECK (duck::empty (std::vector<std::vector<int>>{} | duck::join ()));
+	std::vector<std::vector<int>> all_empty (3);
+	CHECK (duck::empty (all_empty | duck::join ()));
+	CHECK (duck::count (all_empty | duck::join (), 0) == 0);
+
+	// Segmented algorithms
+	CHECK (duck::count (joined, 13) == 1);
+	CHECK (duck::count_if (joined, [](int i) { return i % 2 == 0; }) == 3);
+	CHECK (duck::all_of (joined, [](int i) { return i >= 10; }));
+	CHECK (duck::any_of (joined, [](int i) { return i == 15; }));
+	CHECK (duck::none_of (joined, [](int i) { return i == 0; }));
+	int sum = 0;
+	duck::for_each (joined, [&sum](int i) { sum += i; });
+	CHECK (sum == 75);
+
+	// find returns an iterator of the joined range
+	auto found = duck::find (joined, 13);
+	REQUIRE (found != joined.end ());
+	CHECK (*found == 13);
+	CHECK (found.segment () == vv.begin () + 4);
+	CHECK (std::distance (joined.begin (), found) == 3);
+	++found;
+	CHECK (*found == 14); // Next segment
+	CHECK (duck::find (joined, 42) == joined.end ());
+	auto found_if = duck::find_if (joined, [](int i) { return i > 12; });
+	REQUIRE (found_if != joined.end ());
+	CHECK (*found_if == 13);
+
+	// Non contiguous segments, and segments of views
+	std::list<std::list<int>> ll{{1, 2}, {}, {3}};
+	CHECK (duck::to_container<std::vector<int>> (ll | duck::join ()) ==
+	       (std::vector<int>{1, 2, 3}));
+	CHECK (*duck::find (ll | duck::join (), 3) == 3);
+	std::vector<duck::span<const int>> spans{duck::span<const int> (expected).first (2),
+	                                         duck::span<const int> (expected).last (1)};
+	CHECK (duck::count_if (spans | duck::join (), [](int i) { return i > 10; }) == 2);
+
+	// Nested joins
+	std::vector<std::vector<std::vector<int>>> vvv{{{1}, {}}, {}, {{2, 3}}};
+	auto nested = vvv | duck::join () | duck::join ();
+	CHECK (duck::to_container<std::vector<int>> (nested) == (std::vector<int>{1, 2, 3}));
+	CHECK (duck::count_if (nested, [](int i) { return i > 1; }) == 2);
+}
+
 // TODO test with refs, and test typedefs
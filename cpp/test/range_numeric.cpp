@@ -0,0 +1,161 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+
+#include <cstdint>
+#include <list>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include <duck/range/combinator.h>
+#include <duck/range/numeric.h>
+#include <duck/range/parallel_numeric.h>
+#include <duck/thread_pool.h>
+
+TEST_CASE ("accumulate") {
+	std::vector<int> v{1, 2, 3, 4, 5};
+	CHECK (duck::accumulate (v, 0) == 15);
+	CHECK (duck::accumulate (std::list<int>{1, 2, 3, 4, 5}, 1, std::multiplies<int>{}) == 120);
+
+	// Fused map / filter chain
+	auto chain = v | duck::filter ([](int i) { return i % 2 == 1; }) |
+	             duck::map ([](int i) { return std::to_string (i); });
+	CHECK (duck::accumulate (chain, std::string ()) == "135");
+	CHECK (duck::accumulate (std::vector<int>{} | duck::map ([](int i) { return i; }), 42) == 42);
+}
+
+TEST_CASE ("sum") {
+	std::vector<int> v (1000);
+	std::iota (v.begin (), v.end (), 0);
+	CHECK (duck::sum (v) == 999 * 1000 / 2);
+	std::vector<double> d (1000, 0.5);
+	CHECK (duck::sum (d) == 500.0);
+	// Element type result, wraps around
+	std::vector<unsigned char> bytes (300, 1);
+	CHECK (duck::sum (bytes) == 300 % 256);
+	// Non contiguous
+	CHECK (duck::sum (std::list<int>{1, 2, 3}) == 6);
+	CHECK (duck::sum (std::vector<float> ()) == 0.f);
+}
+
+TEST_CASE ("reduce / transform_reduce") {
+	std::vector<int> v (1000);
+	std::iota (v.begin (), v.end (), 1);
+	CHECK (duck::reduce (v) == 1000 * 1001 / 2);
+	CHECK (duck::reduce (v, 10) == 1000 * 1001 / 2 + 10);
+	CHECK (duck::reduce (v, std::int64_t (0)) == 1000 * 1001 / 2); // Wider sum type: scalar
+	CHECK (duck::reduce (v | duck::slice (0, 5), 1, std::multiplies<>{}) == 120);
+	CHECK (duck::reduce (std::list<int>{1, 2, 3}) == 6);
+
+	auto square = [](int i) { return i * i; };
+	CHECK (duck::transform_reduce (v | duck::slice (0, 3), 0, std::plus<>{}, square) == 14);
+	auto chain = v | duck::filter ([](int i) { return i % 100 == 0; });
+	CHECK (duck::transform_reduce (chain, std::string (), std::plus<>{},
+	                               [](int i) { return std::to_string (i / 100); }) ==
+	       "12345678910");
+}
+
+using ScanTypes = doctest::Types<std::int8_t, std::uint16_t, std::int32_t, std::uint64_t, float,
+                                 double>;
+TEST_CASE_TEMPLATE ("scan arithmetic", T, ScanTypes) {
+	// Sizes around vector widths, wrapping integers
+	for (std::size_t n : {0, 1, 3, 4, 7, 8, 15, 16, 17, 31, 32, 33, 100, 1000}) {
+		std::vector<T> v (n);
+		for (std::size_t i = 0; i < n; ++i)
+			v[i] = static_cast<T> (i % 7 + 1);
+		std::vector<T> expected (n);
+		std::vector<T> out (n);
+
+		std::partial_sum (v.begin (), v.end (), expected.begin (),
+		                  [](T a, T b) { return static_cast<T> (a + b); });
+		CHECK (duck::inclusive_scan (v, out.begin ()) == out.end ());
+		CHECK (out == expected);
+		duck::inclusive_scan (v, out.data ());
+		CHECK (out == expected);
+
+		T sum = T (3);
+		for (std::size_t i = 0; i < n; ++i) {
+			expected[i] = sum;
+			sum = static_cast<T> (sum + v[i]);
+		}
+		CHECK (duck::exclusive_scan (v, out.begin (), T (3)) == out.end ());
+		CHECK (out == expected);
+		// In place
+		duck::exclusive_scan (v, v.data (), T (3));
+		CHECK (v == expected);
+	}
+}
+
+TEST_CASE ("scan") {
+	std::vector<int> v{1, 2, 3, 4};
+	std::vector<int> out;
+	duck::inclusive_scan (v, std::back_inserter (out), std::multiplies<>{});
+	CHECK (out == (std::vector<int>{1, 2, 6, 24}));
+	out.clear ();
+	duck::inclusive_scan (v, std::back_inserter (out), std::plus<>{}, 10);
+	CHECK (out == (std::vector<int>{11, 13, 16, 20}));
+	out.clear ();
+	duck::exclusive_scan (std::list<int>{1, 2, 3}, std::back_inserter (out), 0);
+	CHECK (out == (std::vector<int>{0, 1, 3}));
+
+	// Fused chain, and non arithmetic values
+	std::vector<std::string> strings;
+	duck::inclusive_scan (v | duck::map ([](int i) { return std::to_string (i); }),
+	                      std::back_inserter (strings));
+	CHECK (strings == (std::vector<std::string>{"1", "12", "123", "1234"}));
+	strings.clear ();
+	duck::exclusive_scan (v | duck::filter ([](int i) { return i % 2 == 0; }) |
+	                          duck::map ([](int i) { return std::to_string (i); }),
+	                      std::back_inserter (strings), std::string ("x"));
+	CHECK (strings == (std::vector<std::string>{"x", "x2"}));
+}
+
+TEST_CASE ("parallel reduce / scan") {
+	duck::ThreadPool pool (3);
+	auto policy = duck::par (pool, 100);
+	std::vector<std::uint32_t> v (12345);
+	for (std::size_t i = 0; i < v.size (); ++i)
+		v[i] = static_cast<std::uint32_t> (i * 7919 % 1000);
+	auto expected_sum = std::accumulate (v.begin (), v.end (), std::uint32_t (0));
+
+	CHECK (duck::reduce (policy, v) == expected_sum);
+	CHECK (duck::reduce (policy, v, std::uint64_t (1)) == expected_sum + 1);
+	CHECK (duck::reduce (policy, v, 0u, [](unsigned a, unsigned b) { return std::max (a, b); }) ==
+	       999);
+	CHECK (duck::transform_reduce (policy, v, std::uint64_t (0), std::plus<>{},
+	                               [](std::uint32_t i) { return std::uint64_t (i) * i; }) ==
+	       duck::transform_reduce (v, std::uint64_t (0), std::plus<>{},
+	                               [](std::uint32_t i) { return std::uint64_t (i) * i; }));
+	CHECK (duck::reduce (policy, std::list<int>{1, 2, 3}) == 6); // Serial
+
+	std::vector<std::uint32_t> expected (v.size ());
+	std::vector<std::uint32_t> out (v.size ());
+	std::partial_sum (v.begin (), v.end (), expected.begin ());
+	CHECK (duck::inclusive_scan (policy, v, out.begin ()) == out.end ());
+	CHECK (out == expected);
+	// Non SIMD operation, with init
+	std::vector<std::uint64_t> out64 (v.size ());
+	auto add64 = [](std::uint64_t a, std::uint64_t b) { return a + b; };
+	duck::inclusive_scan (policy, v, out64.begin (), add64, std::uint64_t (0));
+	CHECK (std::equal (out64.begin (), out64.end (), expected.begin ()));
+
+	expected[0] = 5;
+	for (std::size_t i = 1; i < v.size (); ++i)
+		expected[i] = expected[i - 1] + v[i - 1];
+	duck::exclusive_scan (policy, v, out.begin (), std::uint32_t (5));
+	CHECK (out == expected);
+	// In place, on a view
+	auto slice = v | duck::slice (1, 12345);
+	std::vector<std::uint32_t> values (slice.begin (), slice.end ());
+	expected[0] = 0;
+	for (std::size_t i = 1; i < values.size (); ++i)
+		expected[i] = expected[i - 1] + values[i - 1];
+	duck::exclusive_scan (policy, slice, slice.begin (), std::uint32_t (0), add64);
+	CHECK (std::equal (slice.begin (), slice.end (), expected.begin ()));
+
+	// Small inputs and the default pool
+	std::vector<int> small{1, 2, 3};
+	duck::inclusive_scan (duck::par (), small, small.begin ());
+	CHECK (small == (std::vector<int>{1, 3, 6}));
+	CHECK (duck::reduce (duck::par_unseq (), std::vector<int> ()) == 0);
+}
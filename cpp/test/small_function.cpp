@@ -0,0 +1,70 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+
+#include <array>
+#include <memory>
+#include <string>
+
+#include <duck/small_function.h>
+
+TEST_CASE ("call") {
+	duck::SmallFunction<int(int)> f;
+	CHECK (!f);
+	f = [](int i) { return i + 1; };
+	CHECK (f);
+	CHECK (f (41) == 42);
+
+	// Move only captures
+	auto p = std::unique_ptr<int> (new int (3));
+	duck::SmallFunction<int()> g ([q = std::move (p)] { return *q; });
+	CHECK (g () == 3);
+
+	// Reference arguments are forwarded
+	duck::SmallFunction<void(std::string &)> append ([](std::string & s) { s += "!"; });
+	std::string s = "hello";
+	append (s);
+	CHECK (s == "hello!");
+}
+
+struct CountInstances {
+	static int instances;
+	std::array<char, 128> big{};
+	CountInstances () { ++instances; }
+	CountInstances (const CountInstances &) { ++instances; }
+	~CountInstances () { --instances; }
+	int operator() () const { return 7; }
+};
+int CountInstances::instances = 0;
+
+TEST_CASE ("storage and lifetime") {
+	using F = duck::SmallFunction<int()>;
+	CHECK (F::is_stored_inline<int (*) ()>::value);
+	CHECK_FALSE (F::is_stored_inline<CountInstances>::value);
+	{
+		F big{CountInstances{}};
+		CHECK (CountInstances::instances == 1);
+		CHECK (big () == 7);
+
+		// Move keeps one instance
+		F moved (std::move (big));
+		CHECK (!big);
+		CHECK (CountInstances::instances == 1);
+		CHECK (moved () == 7);
+
+		moved = nullptr;
+		CHECK (CountInstances::instances == 0);
+		moved = CountInstances{};
+	}
+	CHECK (CountInstances::instances == 0);
+
+	// Inline storage
+	auto shared = std::make_shared<int> (1);
+	{
+		F small ([shared] { return *shared; });
+		F other;
+		other = std::move (small);
+		CHECK (shared.use_count () == 2);
+		CHECK (other () == 1);
+	}
+	CHECK (shared.use_count () == 1);
+}
@@ -151,6 +151,13 @@ TEST_CASE ("assign") {
 	CHECK (v.is_allocated ());
 	for (auto i : duck::range (4))
 		CHECK (v[i] == i + 1);
+
+	// Forward iterators: reserve once to the exact size
+	l.push_back (5);
+	duck::SmallVector<int, 2> w;
+	w.append_sequence (l.begin (), l.end ());
+	CHECK (w.size () == 5);
+	CHECK (w.capacity () == 5);
 }
 
 struct MoveConstrOnlyWithCount {
@@ -0,0 +1,138 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <duck/thread_pool.h>
+
+// Count heap allocations to check that task nodes are recycled.
+static std::atomic<long> nb_allocations{0};
+// Not inlined: GCC reports false mismatched new / delete pairs otherwise.
+[[gnu::noinline]] void * operator new (std::size_t size) {
+	++nb_allocations;
+	if (auto p = std::malloc (size > 0 ? size : 1))
+		return p;
+	throw std::bad_alloc ();
+}
+[[gnu::noinline]] void operator delete (void * p) noexcept {
+	std::free (p);
+}
+[[gnu::noinline]] void operator delete (void * p, std::size_t) noexcept {
+	::operator delete (p);
+}
+
+TEST_CASE ("spawn") {
+	std::atomic<int> counter{0};
+	{
+		duck::ThreadPool pool (3);
+		CHECK (pool.size () == 3);
+		CHECK_FALSE (pool.in_worker ());
+		for (int i = 0; i < 1000; ++i)
+			pool.spawn ([&counter] { ++counter; });
+	} // Destructor runs remaining tasks
+	CHECK (counter == 1000);
+}
+
+static long fib (duck::TaskGroup & parent, int n) {
+	if (n < 2)
+		return n;
+	long a = 0;
+	duck::TaskGroup group (parent.pool ());
+	group.spawn ([&] { a = fib (group, n - 1); });
+	auto b = fib (group, n - 2);
+	group.wait ();
+	return a + b;
+}
+
+TEST_CASE ("task group") {
+	duck::ThreadPool pool (4);
+	{
+		duck::TaskGroup group (pool);
+		CHECK (fib (group, 20) == 6765);
+	}
+
+	// Exceptions
+	duck::TaskGroup group (pool);
+	std::atomic<int> done{0};
+	for (int i = 0; i < 100; ++i) {
+		group.spawn ([i, &done] {
+			if (i == 50)
+				throw std::runtime_error ("task");
+			++done;
+		});
+	}
+	CHECK_THROWS_AS (group.wait (), std::runtime_error);
+	CHECK (done <= 99);
+	// Reusable after an error
+	group.spawn ([&done] { ++done; });
+	group.wait ();
+}
+
+TEST_CASE ("parallel_for") {
+	duck::ThreadPool pool (4, duck::ThreadAffinity::pin_to_cpus);
+	std::vector<int> v (100000);
+	pool.parallel_for (duck::range (std::size_t (0), v.size ()), 100,
+	                   [&v](std::size_t i) { v[i] = static_cast<int> (i); });
+	std::vector<int> expected (v.size ());
+	std::iota (expected.begin (), expected.end (), 0);
+	CHECK (v == expected);
+
+	// Nested
+	std::atomic<long> sum{0};
+	pool.parallel_for (duck::range (10), 1, [&](int) {
+		pool.parallel_for (v, 1000, [&sum](int i) { sum += i; });
+	});
+	CHECK (sum == 10 * (99999L * 100000L / 2));
+
+	CHECK_THROWS_AS (pool.parallel_for (v, 10,
+	                                    [](int i) {
+		                                    if (i == 500)
+			                                    throw std::runtime_error ("for");
+	                                    }),
+	                 std::runtime_error);
+
+	// Throw on the caller share while upper halves are running: they are joined before returning
+	std::atomic<bool> thrown{false};
+	std::atomic<int> running{0};
+	auto throw_first = [&](int i) {
+		if (i == 0) {
+			thrown = true;
+			throw std::runtime_error ("first");
+		}
+		++running;
+		while (!thrown)
+			std::this_thread::yield ();
+		--running;
+	};
+	CHECK_THROWS_AS (pool.parallel_for (duck::range (64), 1, throw_first), std::runtime_error);
+	CHECK (running == 0);
+}
+
+TEST_CASE ("task nodes are recycled") {
+	duck::ThreadPool pool (2);
+	constexpr int nb_rounds = 10;
+	constexpr int nb_tasks = 1000;
+	std::atomic<long> allocations{0};
+	std::atomic<int> counter{0};
+	duck::TaskGroup outer (pool);
+	outer.spawn ([&] {
+		// Spawn from a worker: nodes come from its recycled list
+		auto before = nb_allocations.load ();
+		for (int round = 0; round < nb_rounds; ++round) {
+			duck::TaskGroup group (pool);
+			for (int i = 0; i < nb_tasks; ++i)
+				group.spawn ([&counter] { ++counter; });
+			group.wait ();
+		}
+		allocations = nb_allocations.load () - before;
+	});
+	outer.wait ();
+	CHECK (counter == nb_rounds * nb_tasks);
+	CHECK (allocations < nb_rounds * nb_tasks / 2);
+}
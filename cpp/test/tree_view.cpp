@@ -1,10 +1,20 @@
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 #include <doctest.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#include <duck/parallel_tree_view.h>
 #include <duck/range/combinator.h>
+#include <duck/thread_pool.h>
 #include <duck/tree_view.h>
 
 struct node_t {
@@ -61,6 +71,173 @@ struct tree_view : duck::bidirectional_tree_topology {
 	}
 };
 
+// Non virtual topology, with pointers as ids
+struct static_tree_view {
+	const node_t * root;
+
+	using node_id = const node_t *;
+	using edge_id = const node_t *; // Child of the edge
+
+	node_id invalid_node () const { return nullptr; }
+	edge_id invalid_edge () const { return nullptr; }
+	node_id root_node () const { return root; }
+	node_id child_node (edge_id id) const { return id; }
+	node_id father_node (edge_id id) const { return id->parent; }
+	edge_id father_edge (node_id id) const { return id; }
+	auto child_edges (node_id id) const {
+		return id->childrens | duck::map ([](const std::unique_ptr<node_t> & child) -> edge_id {
+			       return child.get ();
+		       });
+	}
+};
+
+TEST_CASE ("topology concept") {
+	CHECK (duck::is_bidirectional_tree_topology<duck::bidirectional_tree_topology>::value);
+	CHECK (duck::is_downward_tree_topology<duck::downward_tree_topology>::value);
+	CHECK (!duck::is_bidirectional_tree_topology<duck::downward_tree_topology>::value);
+	CHECK (duck::is_bidirectional_tree_topology<tree_view>::value);
+	CHECK (duck::is_bidirectional_tree_topology<static_tree_view>::value);
+	CHECK (!duck::is_downward_tree_topology<node_t>::value);
+	CHECK (!duck::is_downward_tree_topology<int>::value);
+
+	auto tree = N (1, N (2, N (3), N (4)), N (5), N (6, N (7), N (8), N (9)));
+	static_tree_view view{tree.get ()};
+	auto value = [](const node_t * node) { return node->value; };
+	CHECK ((duck::forward_dfs_range (view) | duck::map (value)) == duck::range (1, 10));
+	CHECK ((duck::input_dfs_range (view) | duck::map (value)) == duck::range (1, 10));
+	CHECK (duck::empty (duck::forward_dfs_range (static_tree_view{nullptr})));
+	CHECK (duck::empty (duck::input_dfs_range (static_tree_view{nullptr})));
+
+	auto lin = duck::linearize (view);
+	CHECK ((std::is_same<decltype (lin), duck::BasicLinearizedTree<const node_t *>>::value));
+	CHECK ((lin.nodes () | duck::map (value)) == duck::range (1, 10));
+	CHECK (duck::equal (lin.subtree_sizes (), std::vector<int>{9, 3, 1, 1, 1, 4, 1, 1, 1}));
+
+	// Virtual interface used through the base class
+	tree_view virtual_view (tree);
+	const duck::bidirectional_tree_topology & base = virtual_view;
+	duck::forward_tree_dfs_range forward = duck::forward_dfs_range (base);
+	duck::input_tree_dfs_range input (base);
+	CHECK (duck::size (forward) == 9);
+	CHECK (duck::size (input) == 9);
+	CHECK (duck::LinearizedTree (base).size () == 9);
+}
+
+// Tree in arrays of sibling links, indexes as ids: node i is the child of edge i
+struct linked_tree {
+	std::vector<int> parent, first_child, next_sibling;
+
+	explicit linked_tree (std::vector<int> parents)
+	    : parent (std::move (parents)), first_child (parent.size (), -1),
+	      next_sibling (parent.size (), -1) {
+		for (int i = int (parent.size ()) - 1; i > 0; --i) {
+			auto p = std::size_t (parent[std::size_t (i)]);
+			next_sibling[std::size_t (i)] = first_child[p];
+			first_child[p] = i;
+		}
+	}
+};
+
+// Parents of a random recursive tree of n nodes: the parent of i > 0 is in [0, i)
+std::vector<int> random_parents (std::size_t n) {
+	std::vector<int> parents (n, -1);
+	unsigned state = 1;
+	for (std::size_t i = 1; i < n; ++i) {
+		state = state * 1103515245u + 12345u;
+		parents[i] = int ((state >> 8) % i);
+	}
+	return parents;
+}
+
+// Non virtual topology with sibling links only
+struct static_linked_tree_view {
+	const linked_tree * tree;
+
+	using node_id = int;
+	using edge_id = int;
+
+	node_id invalid_node () const { return -1; }
+	edge_id invalid_edge () const { return -1; }
+	node_id root_node () const { return tree->parent.empty () ? -1 : 0; }
+	node_id child_node (edge_id id) const { return id; }
+	edge_id first_child_edge (node_id id) const { return tree->first_child[std::size_t (id)]; }
+	edge_id next_sibling_edge (edge_id id) const { return tree->next_sibling[std::size_t (id)]; }
+};
+
+// Virtual topology overriding the sibling links, counting child_edges calls
+struct linked_tree_view final : duck::bidirectional_tree_topology {
+	const linked_tree * tree;
+	mutable int nb_child_edges_calls{0};
+
+	explicit linked_tree_view (const linked_tree & t) : tree (&t) {}
+
+	node_id invalid_node () const override { return node_id (-1); }
+	edge_id invalid_edge () const override { return edge_id (-1); }
+	node_id root_node () const override { return node_id (0); }
+	node_id father_node (edge_id id) const override {
+		return node_id (tree->parent[std::size_t (id.value)]);
+	}
+	node_id child_node (edge_id id) const override { return node_id (id.value); }
+	edge_id father_edge (node_id id) const override {
+		return edge_id (id.value == 0 ? -1 : id.value);
+	}
+	std::vector<edge_id> child_edges (node_id id) const override {
+		++nb_child_edges_calls;
+		std::vector<edge_id> edges;
+		for (auto e = first_child_edge (id); e != invalid_edge (); e = next_sibling_edge (e))
+			edges.push_back (e);
+		return edges;
+	}
+	edge_id first_child_edge (node_id id) const override {
+		return edge_id (tree->first_child[std::size_t (id.value)]);
+	}
+	edge_id next_sibling_edge (edge_id id) const override {
+		return edge_id (tree->next_sibling[std::size_t (id.value)]);
+	}
+};
+
+TEST_CASE ("sibling links") {
+	CHECK (duck::is_downward_tree_topology<static_linked_tree_view>::value);
+	CHECK (!duck::is_bidirectional_tree_topology<static_linked_tree_view>::value);
+	CHECK (duck::is_bidirectional_tree_topology<linked_tree_view>::value);
+
+	// Same tree as N (1, N (2, N (3), N (4)), N (5), N (6, N (7), N (8), N (9))), values - 1
+	linked_tree tree ({-1, 0, 1, 1, 0, 0, 5, 5, 5});
+	static_linked_tree_view links{&tree};
+	CHECK (duck::input_dfs_range (links) == duck::range (0, 9));
+	CHECK (duck::linearize (links).nodes () == duck::range (0, 9));
+	CHECK (duck::first_child_edge (links, 0) == 1);
+	CHECK (duck::next_sibling_edge (links, 4) == 5);
+	CHECK (duck::next_sibling_edge (links, 5) == -1);
+
+	// Walks on the final class only use the links ; through the base, only input walks use
+	// child_edges (the default links are not known to be overridden)
+	linked_tree_view view (tree);
+	auto value = [](duck::topology_node_id id) { return int (id.value); };
+	CHECK ((duck::forward_dfs_range (view) | duck::map (value)) == duck::range (0, 9));
+	CHECK ((duck::input_dfs_range (view) | duck::map (value)) == duck::range (0, 9));
+	CHECK (duck::LinearizedTree (view).size () == 9);
+	CHECK (view.nb_child_edges_calls == 0);
+	const duck::bidirectional_tree_topology & base = view;
+	CHECK ((duck::forward_dfs_range (base) | duck::map (value)) == duck::range (0, 9));
+	CHECK (view.nb_child_edges_calls == 0);
+	CHECK ((duck::input_tree_dfs_range (base) | duck::map (value)) == duck::range (0, 9));
+	CHECK (view.nb_child_edges_calls == 9);
+
+	// Default links of the virtual classes, and fallback on child_edges for concrete topologies
+	auto nodes = N (1, N (2, N (3), N (4)), N (5), N (6, N (7), N (8), N (9)));
+	tree_view defaults (nodes);
+	auto second = defaults.child_edges (defaults.root_node ())[1];
+	CHECK (defaults.first_child_edge (defaults.root_node ()) ==
+	       defaults.child_edges (defaults.root_node ())[0]);
+	CHECK (defaults.next_sibling_edge (second) == defaults.child_edges (defaults.root_node ())[2]);
+	static_tree_view pointers{nodes.get ()};
+	CHECK (duck::first_child_edge (pointers, nodes.get ()) == nodes->childrens[0].get ());
+	CHECK (duck::next_sibling_edge (pointers, nodes->childrens[1].get ()) ==
+	       nodes->childrens[2].get ());
+	CHECK (duck::next_sibling_edge (pointers, nodes->childrens[2].get ()) == nullptr);
+}
+
 TEST_CASE ("test") {
 	auto tree = N (1, N (2, N (3), N (4)), N (5), N (6, N (7), N (8), N (9)));
 	CHECK (tree != nullptr);
@@ -92,3 +269,166 @@ TEST_CASE ("test") {
 		CHECK (duck::empty (duck::input_dfs_range (tree_view (nullptr))));
 	}
 }
+
+TEST_CASE ("linearized tree") {
+	auto tree = N (1, N (2, N (3), N (4)), N (5), N (6, N (7), N (8), N (9)));
+	auto view = tree_view (tree);
+	auto value = [](tree_view::node_id id) { return tree_view::convert (id)->value; };
+
+	duck::LinearizedTree lin (view);
+	REQUIRE (lin.size () == 9);
+	CHECK ((lin.nodes () | duck::map (value)) == duck::range (1, 10));
+	CHECK (duck::equal (lin.parents (), std::vector<int>{-1, 0, 1, 1, 0, 0, 5, 5, 5}));
+	CHECK (duck::equal (lin.depths (), std::vector<int>{0, 1, 2, 2, 1, 1, 2, 2, 2}));
+	CHECK (duck::equal (lin.subtree_sizes (), std::vector<int>{9, 3, 1, 1, 1, 4, 1, 1, 1}));
+	CHECK ((lin.parent (0) == duck::LinearizedTree::invalid_index));
+	CHECK (lin.node (5) == tree_view::convert (tree->childrens[2].get ()));
+
+	// Subtrees and children
+	CHECK ((lin.subtree_nodes (5) | duck::map (value)) == (std::vector<int>{6, 7, 8, 9}));
+	CHECK (lin.subtree (1) == duck::range (1, 4));
+	CHECK (lin.children (0) == (std::vector<int>{1, 4, 5}));
+	CHECK (lin.children (5) == (std::vector<int>{6, 7, 8}));
+	CHECK (duck::empty (lin.children (4)));
+	CHECK (lin.is_leaf (4));
+	CHECK (!lin.is_leaf (1));
+
+	// Ancestors
+	CHECK (lin.is_ancestor (0, 8));
+	CHECK (lin.is_ancestor (5, 8));
+	CHECK (lin.is_ancestor (5, 5));
+	CHECK (!lin.is_ancestor (1, 5));
+	CHECK (!lin.is_ancestor (8, 5));
+
+	CHECK (duck::LinearizedTree (tree_view (nullptr)).empty ());
+}
+
+TEST_CASE ("bfs, post-order and levels") {
+	auto tree = N (1, N (2, N (3), N (4)), N (5), N (6, N (7), N (8), N (9)));
+	static_tree_view view{tree.get ()};
+	auto value = [](const node_t * node) { return node->value; };
+
+	auto bfs = duck::input_bfs_range (view);
+	CHECK ((bfs | duck::map (value)) == (std::vector<int>{1, 2, 5, 6, 3, 4, 7, 8, 9}));
+	std::vector<std::size_t> depths;
+	for (auto it = bfs.begin (); it != bfs.end (); ++it)
+		depths.push_back (it.depth ());
+	CHECK (depths == (std::vector<std::size_t>{0, 1, 1, 1, 2, 2, 2, 2, 2}));
+
+	CHECK ((duck::input_post_order_range (view) | duck::map (value)) ==
+	       (std::vector<int>{3, 4, 2, 5, 7, 8, 9, 6, 1}));
+
+	std::vector<std::vector<int>> levels;
+	for (auto level : duck::input_levels_range (view))
+		levels.push_back (duck::to_container<std::vector<int>> (level | duck::map (value)));
+	CHECK (levels == (std::vector<std::vector<int>>{{1}, {2, 5, 6}, {3, 4, 7, 8, 9}}));
+
+	CHECK (duck::empty (duck::input_bfs_range (static_tree_view{nullptr})));
+	CHECK (duck::empty (duck::input_post_order_range (static_tree_view{nullptr})));
+	CHECK (duck::empty (duck::input_levels_range (static_tree_view{nullptr})));
+
+	// Virtual interface, and topologies with sibling links only
+	tree_view virtual_view (tree);
+	const duck::downward_tree_topology & base = virtual_view;
+	CHECK (duck::size (duck::input_tree_bfs_range (base)) == 9);
+	CHECK (duck::size (duck::input_tree_post_order_range (base)) == 9);
+	CHECK (duck::size (duck::input_tree_levels_range (base)) == 3);
+	linked_tree linked ({-1, 0, 1, 1, 0, 0, 5, 5, 5});
+	static_linked_tree_view links{&linked};
+	CHECK (duck::input_bfs_range (links) == (std::vector<int>{0, 1, 4, 5, 2, 3, 6, 7, 8}));
+	CHECK (duck::input_post_order_range (links) == (std::vector<int>{2, 3, 1, 4, 6, 7, 8, 5, 0}));
+}
+
+TEST_CASE ("level order parallel traversal") {
+	auto parents = random_parents (10000);
+	linked_tree tree (parents);
+	static_linked_tree_view view{&tree};
+	std::vector<int> expected_depths (parents.size (), 0);
+	for (std::size_t i = 1; i < parents.size (); ++i)
+		expected_depths[i] = expected_depths[std::size_t (parents[i])] + 1;
+
+	duck::ThreadPool pool (3);
+	for (std::size_t grain : {1, 16, 100000}) {
+		// Fathers are processed in a previous level
+		std::vector<int> depths (parents.size (), -1);
+		std::vector<std::atomic<int>> nb_visits (parents.size ());
+		duck::level_order_for_each (duck::par (pool, grain), view, [&](int node) {
+			auto i = std::size_t (node);
+			nb_visits[i].fetch_add (1, std::memory_order_relaxed);
+			depths[i] = node == 0 ? 0 : depths[std::size_t (parents[i])] + 1;
+		});
+		CHECK (depths == expected_depths);
+		CHECK (std::all_of (nb_visits.begin (), nb_visits.end (),
+		                    [](const std::atomic<int> & n) { return n.load () == 1; }));
+	}
+
+	CHECK_THROWS_AS (duck::level_order_for_each (duck::par (pool, 1), view,
+	                                             [](int node) {
+		                                             if (node == 5000)
+			                                             throw std::runtime_error ("node");
+	                                             }),
+	                 std::runtime_error);
+	int nb_nodes = 0;
+	duck::level_order_for_each (duck::par (pool), static_tree_view{nullptr}, [&](const node_t *) {
+		++nb_nodes;
+	});
+	CHECK (nb_nodes == 0);
+}
+
+TEST_CASE ("tree reduce") {
+	auto tree = N (1, N (2, N (3), N (4)), N (5), N (6, N (7), N (8), N (9)));
+	static_tree_view view{tree.get ()};
+	auto one = [](const node_t *) { return 1; };
+	auto plus = [](int a, int b) { return a + b; };
+	// Children are combined in order
+	auto to_string = [](const node_t * node) { return std::to_string (node->value); };
+	auto nest = [](std::string acc, std::string child) { return acc + "(" + child + ")"; };
+	const std::string nested = "1(2(3)(4))(5)(6(7)(8)(9))";
+
+	CHECK (duck::tree_reduce (view, one, plus) == 9);
+	CHECK (duck::tree_reduce (view, to_string, nest) == nested);
+	CHECK (duck::tree_reduce (static_tree_view{nullptr}, one, plus) == 0);
+	tree_view virtual_view (tree);
+	const duck::downward_tree_topology & base = virtual_view;
+	CHECK (duck::tree_reduce (base, [](duck::topology_node_id) { return 1; }, plus) == 9);
+
+	duck::ThreadPool pool (3);
+	for (std::size_t grain : {1, 2, 100}) {
+		auto policy = duck::par (pool, grain);
+		CHECK (duck::tree_reduce (policy, view, one, plus) == 9);
+		CHECK (duck::tree_reduce (policy, view, to_string, nest) == nested);
+	}
+	CHECK (duck::tree_reduce (duck::par (pool), static_tree_view{nullptr}, one, plus) == 0);
+
+	linked_tree random_tree (random_parents (20000));
+	static_linked_tree_view random_view{&random_tree};
+	auto node_hash = [](int node) { return std::uint64_t (node) * 0x9e3779b97f4a7c15u; };
+	auto ordered_hash = [](std::uint64_t acc, std::uint64_t child) {
+		return (acc ^ child) * 0x100000001b3u;
+	};
+	auto expected_hash = duck::tree_reduce (random_view, node_hash, ordered_hash);
+	for (std::size_t grain : {1, 7, 2048}) {
+		auto policy = duck::par (pool, grain);
+		CHECK (duck::tree_reduce (policy, random_view, [](int) { return 1; }, plus) == 20000);
+		CHECK (duck::tree_reduce (policy, random_view, node_hash, ordered_hash) == expected_hash);
+	}
+
+	// Degenerate chain, deeper than what recursion would support
+	std::vector<int> chain_parents (1000000);
+	for (std::size_t i = 0; i < chain_parents.size (); ++i)
+		chain_parents[i] = int (i) - 1;
+	linked_tree chain (chain_parents);
+	static_linked_tree_view chain_view{&chain};
+	CHECK (duck::tree_reduce (chain_view, [](int) { return 1; }, plus) == 1000000);
+	CHECK (duck::tree_reduce (duck::par (pool, 16), chain_view, [](int) { return 1; }, plus) ==
+	       1000000);
+
+	CHECK_THROWS_AS (duck::tree_reduce (duck::par (pool, 1), random_view,
+	                                    [](int node) {
+		                                    if (node == 10000)
+			                                    throw std::runtime_error ("node");
+		                                    return 1;
+	                                    },
+	                                    plus),
+	                 std::runtime_error);
+}
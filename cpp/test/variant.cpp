@@ -4,6 +4,7 @@
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <type_traits>
 
 #include <duck/variant.h>
 
@@ -20,11 +21,32 @@ struct ToStringVisitor {
 	}
 };
 
+template <typename T, typename = void> struct has_type_member : std::false_type {};
+template <typename T>
+struct has_type_member<T, duck::void_t<typename T::Type>> : std::true_type {};
+template <typename T, typename = void> struct has_value_member : std::false_type {};
+template <typename T>
+struct has_value_member<T, duck::void_t<decltype (T::value)>> : std::true_type {};
+
 TEST_CASE ("test") {
 	using Var = duck::Variant::Static<bool, int, blah, std::string>;
 	CHECK (Var::index_for_type<bool> () == 0);
 	CHECK (Var::index_for_type<int> () == 1);
 	CHECK (Var::index_for_type<blah> () == 2);
+	CHECK ((std::is_same<Var::TypeForIndex<3>, std::string>::value));
+
+	// Index / type mapping is SFINAE friendly
+	using duck::Variant::Detail::GetNthType;
+	using duck::Variant::Detail::GetTypePos;
+	CHECK (has_type_member<GetNthType<1, int, blah>>::value);
+	CHECK_FALSE (has_type_member<GetNthType<2, int, blah>>::value);
+	CHECK ((std::is_same<GetNthType<0, int[3]>::Type, int[3]>::value));
+	using ConstVar = duck::Variant::Static<const int, double>;
+	CHECK ((std::is_same<ConstVar::TypeForIndex<0>, const int>::value));
+	CHECK (has_value_member<GetTypePos<blah, int, blah>>::value);
+	CHECK_FALSE (has_value_member<GetTypePos<double, int, blah>>::value);
+	CHECK ((std::is_constructible<Var, int>::value));
+	CHECK_FALSE ((std::is_constructible<Var, double *>::value));
 
 	Var a{blah{}};
 	Var b{32};
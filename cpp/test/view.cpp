@@ -1,6 +1,7 @@
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 #include <doctest.h>
 
+#include <string>
 #include <vector>
 
 #include <duck/view.h>
@@ -40,3 +41,60 @@ TEST_CASE ("split") {
 	CHECK (split (',', ",b") == std::vector<string_view>{"", "b"});
 	CHECK (split (',', " ,b ") == std::vector<string_view>{" ", "b "});
 }
+
+template <typename R> std::vector<string_view> to_vector (const R & r) {
+	return {r.begin (), r.end ()};
+}
+
+TEST_CASE ("split_range") {
+	using duck::split;
+	using duck::split_range;
+	for (auto text : {"", ",", ",,", "a,b,c", "a,b", "a,", ",b", " ,b "})
+		CHECK (to_vector (split_range (',', text)) == split (',', text));
+
+	// Long parts, separators at all positions of vectors
+	std::string long_text;
+	for (int i = 0; i < 200; ++i)
+		long_text += std::string (static_cast<std::size_t> (i % 37), 'x') + ',';
+	CHECK (to_vector (split_range (',', long_text)) == split (',', long_text));
+	CHECK (duck::size (split_range (',', long_text)) == 201);
+}
+
+TEST_CASE ("split_range_any") {
+	using duck::split_range_any;
+	CHECK (to_vector (split_range_any (",;", "")) == std::vector<string_view>{""});
+	CHECK (to_vector (split_range_any (",;", "a;b,c")) == std::vector<string_view>{"a", "b", "c"});
+	CHECK (to_vector (split_range_any (",;", ";,")) == std::vector<string_view>{"", "", ""});
+	CHECK (to_vector (split_range_any ("", "a;b")) == std::vector<string_view>{"a;b"});
+	// Separators are copied
+	auto parts = split_range_any (std::string (",;"), "a;b,c");
+	CHECK (to_vector (parts) == std::vector<string_view>{"a", "b", "c"});
+
+	// Same as split with a single separator, with a small and a large (lookup table) set
+	std::string text;
+	for (int i = 0; i < 300; ++i)
+		text += std::string (static_cast<std::size_t> (i % 41), 'a' + i % 7) + "!";
+	auto expected = duck::split ('!', text);
+	CHECK (to_vector (split_range_any ("!", text)) == expected);
+	CHECK (to_vector (split_range_any ("!#$%&()*+-./:<=>?@[]^_", text)) == expected);
+
+	// Mixed separators at all positions
+	std::string mixed;
+	for (int i = 0; i < 100; ++i)
+		mixed += std::string (static_cast<std::size_t> (i % 19), 'z') + " \t\n"[i % 3];
+	std::vector<std::string> expected_mixed;
+	std::string current;
+	for (char c : mixed) {
+		if (c == ' ' || c == '\t' || c == '\n') {
+			expected_mixed.push_back (current);
+			current.clear ();
+		} else {
+			current += c;
+		}
+	}
+	expected_mixed.push_back (current);
+	std::vector<std::string> result;
+	for (auto part : split_range_any (" \t\n", mixed))
+		result.push_back (duck::to_string (part));
+	CHECK (result == expected_mixed);
+}